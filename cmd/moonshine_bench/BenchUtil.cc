@@ -0,0 +1,325 @@
+// Copyright 2023-2024 DreamWorks Animation LLC
+// SPDX-License-Identifier: Apache-2.0
+
+///
+/// @file BenchUtil.cc
+/// $Id$
+///
+
+#include "BenchUtil.h"
+#include "BenchUtil_ispc_stubs.h"
+
+#include <moonray/rendering/mcrt_common/ThreadLocalState.h>
+#include <moonray/rendering/shading/AttributeKey.h>
+#include <moonray/rendering/shading/AttributeTable.h>
+#include <moonray/rendering/shading/Shading.h>
+#include <scene_rdl2/common/math/Color.h>
+#include <scene_rdl2/common/math/Vec2.h>
+#include <scene_rdl2/common/math/Vec3.h>
+#include <scene_rdl2/render/util/Random.h>
+
+#include <algorithm>
+#include <cmath>
+#include <dirent.h>
+#include <fstream>
+#include <iomanip>
+#include <set>
+
+using namespace scene_rdl2::math;
+namespace shading = moonray::shading;
+
+namespace moonshine {
+namespace bench {
+
+namespace {
+
+float
+fractional(float x)
+{
+    return x - std::floor(x);
+}
+
+} // anonymous namespace
+
+//----------------------------------------------------------------------------
+
+StateBatch::StateBatch(unsigned numStates, unsigned seed) :
+    mIsects(std::max(numStates, 1u)),
+    mSoaValid(false),
+    mSeed(seed)
+{
+    scene_rdl2::util::Random rng(seed);
+
+    // Jittered samples over a gently curved unit patch so that neighbouring
+    // states are coherent, as they would be in a bundle from a real render.
+    const unsigned n = size();
+    const unsigned res = static_cast<unsigned>(std::ceil(std::sqrt(static_cast<float>(n))));
+    const float invRes = 1.0f / static_cast<float>(res);
+    for (unsigned i = 0; i < n; ++i) {
+        const float s = (static_cast<float>(i % res) + rng.getNextFloat()) * invRes;
+        const float t = (static_cast<float>(i / res) + rng.getNextFloat()) * invRes;
+
+        const Vec3f P(s * 2.0f - 1.0f, 0.25f * std::sin(s * sPi) * std::sin(t * sPi), t * 2.0f - 1.0f);
+        const Vec3f dPds(2.0f, 0.25f * sPi * std::cos(s * sPi) * std::sin(t * sPi), 0.0f);
+        const Vec3f dPdt(0.0f, 0.25f * sPi * std::sin(s * sPi) * std::cos(t * sPi), 2.0f);
+        const Vec3f N = normalize(cross(dPdt, dPds));
+
+        shading::Intersection& isect = mIsects[i];
+        isect.setDifferentialGeometry(N, N, Vec2f(s, t), dPds, dPdt, /* hasDerivatives = */ true);
+        isect.setP(P);
+        isect.setdSdx(invRes);
+        isect.setdSdy(0.0f);
+        isect.setdTdx(0.0f);
+        isect.setdTdy(invRes);
+    }
+}
+
+void
+StateBatch::attachAttributes(const scene_rdl2::rdl2::Shader& shader,
+                             shading::TLState* tls)
+{
+    const std::vector<shading::AttributeKey>& required = shader.getRequiredAttributes();
+    const std::vector<shading::AttributeKey>& optional = shader.getOptionalAttributes();
+    if (required.empty() && optional.empty()) {
+        return;
+    }
+
+    // The table must outlive every state in the batch, so it lives in the
+    // thread's arena alongside the attribute storage.
+    scene_rdl2::alloc::Arena* arena = tls->mArena;
+    const shading::AttributeTable* table = arena->allocWithArgs<shading::AttributeTable>(
+        required, optional);
+
+    std::set<shading::AttributeKey> keys(required.begin(), required.end());
+    keys.insert(optional.begin(), optional.end());
+
+    scene_rdl2::util::Random rng(mSeed ^ 0xa77b);
+    for (shading::Intersection& isect : mIsects) {
+        isect.setTable(arena, table);
+
+        // Reference space is a small rigid offset of render space so that
+        // shaders comparing P and refP see a realistic difference.
+        const Vec3f refP = isect.getP() + Vec3f(0.1f, -0.05f, 0.2f);
+        for (const shading::AttributeKey& key : keys) {
+            if (key == shading::StandardAttributes::sRefP) {
+                isect.setAttribute(shading::StandardAttributes::sRefP, refP);
+                continue;
+            }
+            if (key == shading::StandardAttributes::sRefN) {
+                isect.setAttribute(shading::StandardAttributes::sRefN, isect.getN());
+                continue;
+            }
+
+            // Generic polyvertex/primvar attributes get values that vary
+            // smoothly with st plus a little noise.
+            const Vec2f& st = isect.getSt();
+            const float r = rng.getNextFloat() * 0.05f;
+            switch (key.getType()) {
+            case scene_rdl2::rdl2::TYPE_FLOAT:
+                isect.setAttribute(shading::TypedAttributeKey<float>(key), fractional(st.x + r));
+                break;
+            case scene_rdl2::rdl2::TYPE_VEC2F:
+                isect.setAttribute(shading::TypedAttributeKey<Vec2f>(key), Vec2f(st.x, st.y + r));
+                break;
+            case scene_rdl2::rdl2::TYPE_VEC3F:
+                isect.setAttribute(shading::TypedAttributeKey<Vec3f>(key), refP + Vec3f(r));
+                break;
+            case scene_rdl2::rdl2::TYPE_RGB:
+                isect.setAttribute(shading::TypedAttributeKey<Color>(key),
+                                   Color(st.x, st.y, fractional(st.x + st.y + r)));
+                break;
+            case scene_rdl2::rdl2::TYPE_RGBA:
+                isect.setAttribute(shading::TypedAttributeKey<Color4>(key),
+                                   Color4(st.x, st.y, fractional(st.x + st.y + r), 1.0f));
+                break;
+            default:
+                // Other types are left at the table's default value
+                break;
+            }
+        }
+    }
+
+    mSoaValid = false;
+}
+
+const scene_rdl2::rdl2::Statev*
+StateBatch::statev()
+{
+    if (!mSoaValid) {
+        transposeToSoa();
+    }
+    return reinterpret_cast<const scene_rdl2::rdl2::Statev*>(mSoa.get());
+}
+
+void
+StateBatch::transposeToSoa()
+{
+    // Each SOA block holds VLEN states, and its size is a multiple of the
+    // 64 byte alignment
+    if (!mSoa) {
+        const size_t numBytes = static_cast<size_t>(numStatev()) * sizeof(shading::Intersection) * VLEN;
+        mSoa.reset(static_cast<uint8_t*>(std::aligned_alloc(64, (numBytes + 63) & ~size_t(63))));
+    }
+
+    // The ISPC side transposes field by field, a plain 32 bit word
+    // interleave would split the 64 bit pointers in the state across lanes
+    ispc::BenchUtil_transposeStates(reinterpret_cast<const ispc::State*>(mIsects.data()),
+                                    static_cast<int>(size()),
+                                    reinterpret_cast<ispc::State*>(mSoa.get()));
+
+    mSoaValid = true;
+}
+
+//----------------------------------------------------------------------------
+
+void
+printResults(std::ostream& os, const std::vector<Result>& results)
+{
+    size_t nameWidth = 10;
+    size_t pathWidth = 6;
+    bool hasBytes = false;
+    for (const Result& r : results) {
+        nameWidth = std::max(nameWidth, r.mClassName.size());
+        pathWidth = std::max(pathWidth, r.mPath.size());
+        hasBytes = hasBytes || r.mBytes != 0;
+    }
+
+    os << std::left << std::setw(nameWidth + 2) << "class"
+       << std::setw(pathWidth + 2) << "path"
+       << std::right << std::setw(6) << "lanes"
+       << std::setw(14) << "ns/sample"
+       << std::setw(16) << "samples/sec";
+    if (hasBytes) {
+        os << std::setw(14) << "MB resident";
+    }
+    os << '\n';
+
+    for (const Result& r : results) {
+        os << std::left << std::setw(nameWidth + 2) << r.mClassName
+           << std::setw(pathWidth + 2) << r.mPath
+           << std::right << std::setw(6) << r.mLaneWidth
+           << std::setw(14) << std::fixed << std::setprecision(2) << r.nsPerSample()
+           << std::setw(16) << std::setprecision(0) << r.samplesPerSecond();
+        if (hasBytes) {
+            os << std::setw(14) << std::setprecision(1) << r.mBytes / (1024.0 * 1024.0);
+        }
+        os << '\n';
+    }
+    os.unsetf(std::ios::floatfield);
+}
+
+bool
+writeJson(const std::string& path, const char* mode, const Options& options,
+          const std::vector<Result>& results)
+{
+    std::ofstream out(path);
+    if (!out) {
+        return false;
+    }
+
+    out << "{\n"
+        << "  \"mode\": \"" << mode << "\",\n"
+        << "  \"vlen\": " << VLEN << ",\n"
+        << "  \"num_states\": " << options.mNumStates << ",\n"
+        << "  \"iterations\": " << options.mIterations << ",\n"
+        << "  \"seed\": " << options.mSeed << ",\n"
+        << "  \"results\": [";
+
+    for (size_t i = 0; i < results.size(); ++i) {
+        const Result& r = results[i];
+        out << (i ? ",\n" : "\n")
+            << "    {\"class\": \"" << r.mClassName << "\""
+            << ", \"path\": \"" << r.mPath << "\""
+            << ", \"lanes\": " << r.mLaneWidth
+            << ", \"samples\": " << r.mSamples
+            << ", \"bytes\": " << r.mBytes
+            << ", \"seconds\": " << std::setprecision(9) << r.mSeconds
+            << ", \"ns_per_sample\": " << r.nsPerSample()
+            << ", \"samples_per_sec\": " << r.samplesPerSecond() << "}";
+    }
+    out << "\n  ]\n}\n";
+
+    return static_cast<bool>(out);
+}
+
+//----------------------------------------------------------------------------
+
+shading::TLState*
+initTls()
+{
+    moonray::mcrt_common::TLSInitParams initParams;
+    initParams.mUnitTests = true;
+    initParams.mDesiredNumTBBThreads = 1;
+    initParams.initShadingTls = shading::TLState::allocTls;
+    moonray::mcrt_common::initTLS(initParams);
+
+    moonray::mcrt_common::ThreadLocalState* tls = moonray::mcrt_common::getFrameUpdateTLS();
+    return tls->mShadingTls.get();
+}
+
+scene_rdl2::rdl2::SceneObject*
+createObject(scene_rdl2::rdl2::SceneContext& context, const std::string& className,
+             const std::string& name)
+{
+    try {
+        context.createSceneClass(className);
+        return context.createSceneObject(className, "/bench/" + name);
+    } catch (const std::exception& e) {
+        std::cerr << "Unable to create " << className << ": " << e.what() << '\n';
+        return nullptr;
+    }
+}
+
+void
+bindAttribute(scene_rdl2::rdl2::SceneObject* object, const std::string& name,
+              scene_rdl2::rdl2::SceneObject* map)
+{
+    if (!map) {
+        return;
+    }
+    try {
+        const scene_rdl2::rdl2::Attribute* attr = object->getSceneClass().getAttribute(name);
+        object->setBinding(*attr, map);
+    } catch (const std::exception& e) {
+        std::cerr << object->getName() << ": unable to bind " << name << ": " << e.what() << '\n';
+    }
+}
+
+std::vector<std::string>
+findDsoClasses(const std::string& dsoPath)
+{
+    std::vector<std::string> classes;
+
+    DIR* dir = opendir(dsoPath.c_str());
+    if (!dir) {
+        return classes;
+    }
+
+    // Moonray dsos are named after the class they define
+    const std::string ext = ".so";
+    while (const dirent* entry = readdir(dir)) {
+        const std::string name(entry->d_name);
+        if (name.size() > ext.size() &&
+            name.compare(name.size() - ext.size(), ext.size(), ext) == 0) {
+            classes.push_back(name.substr(0, name.size() - ext.size()));
+        }
+    }
+    closedir(dir);
+
+    std::sort(classes.begin(), classes.end());
+    return classes;
+}
+
+bool
+isSelected(const Options& options, const std::string& className)
+{
+    if (std::find(options.mSkip.begin(), options.mSkip.end(), className) != options.mSkip.end()) {
+        return false;
+    }
+    return options.mClasses.empty() ||
+        std::find(options.mClasses.begin(), options.mClasses.end(), className) != options.mClasses.end();
+}
+
+} // bench
+} // moonshine
+
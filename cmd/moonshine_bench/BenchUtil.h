@@ -0,0 +1,155 @@
+// Copyright 2023-2024 DreamWorks Animation LLC
+// SPDX-License-Identifier: Apache-2.0
+
+///
+/// @file BenchUtil.h
+/// $Id$
+///
+
+#pragma once
+
+#include <moonray/rendering/shading/State.h>
+#include <scene_rdl2/common/platform/Platform.h>
+#include <scene_rdl2/scene/rdl2/rdl2.h>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace moonray {
+namespace shading { class TLState; }
+}
+
+namespace moonshine {
+namespace bench {
+
+// Command line options shared by every benchmark mode
+struct Options
+{
+    std::string mDsoPath;
+    std::vector<std::string> mClasses;  // only run these classes (empty means all)
+    std::vector<std::string> mSkip;     // never run these classes
+    unsigned mNumStates  = 4096;        // shading states per batch
+    unsigned mIterations = 64;          // timed passes over the batch
+    unsigned mWarmup     = 4;           // untimed passes over the batch
+    unsigned mSeed       = 0x5eed;
+    unsigned mMaxInstances = 1000000;   // largest scatter, from 1000 up by 10x
+    std::string mJsonPath;              // write a json summary here if non-empty
+};
+
+// One timed run of one shader through one code path
+struct Result
+{
+    std::string mClassName;
+    std::string mPath;       // "scalar" or "vector"
+    unsigned mLaneWidth = 1;
+    uint64_t mSamples = 0;
+    double mSeconds = 0.0;
+    int64_t mBytes = 0;      // resident memory growth, for the modes that measure it
+
+    double nsPerSample() const
+    {
+        return mSamples ? mSeconds * 1e9 / static_cast<double>(mSamples) : 0.0;
+    }
+    double samplesPerSecond() const
+    {
+        return mSeconds > 0.0 ? static_cast<double>(mSamples) / mSeconds : 0.0;
+    }
+};
+
+class Timer
+{
+public:
+    Timer() : mStart(std::chrono::steady_clock::now()) {}
+    double seconds() const
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - mStart).count();
+    }
+private:
+    std::chrono::steady_clock::time_point mStart;
+};
+
+// A deterministic batch of synthetic shading states covering a unit patch.
+// Each state carries P, N, Ng, St, dPds/dPdt and, once attachAttributes() has
+// been called, values for every primitive attribute the shader under test
+// asked for (refP, refN, dPds, polyvertex/primvar attributes, ...). The batch
+// is kept both as AOS states for the scalar sample functions and as SOA
+// states, VLEN lanes per entry, for the ISPC sample functions.
+class StateBatch
+{
+public:
+    StateBatch(unsigned numStates, unsigned seed);
+
+    // Build an attribute table from the shader's required and optional
+    // attributes and fill it with plausible values on every state.
+    void attachAttributes(const scene_rdl2::rdl2::Shader& shader,
+                          moonray::shading::TLState* tls);
+
+    unsigned size() const { return static_cast<unsigned>(mIsects.size()); }
+
+    const moonray::shading::State& state(unsigned i) const
+    {
+        return static_cast<const moonray::shading::State&>(mIsects[i]);
+    }
+
+    // The SOA copy is rebuilt lazily whenever the AOS states change
+    unsigned numStatev() const { return (size() + VLEN - 1) / VLEN; }
+    const scene_rdl2::rdl2::Statev* statev();
+
+private:
+    void transposeToSoa();
+
+    struct FreeDeleter { void operator()(void* p) const { std::free(p); } };
+
+    std::vector<moonray::shading::Intersection> mIsects;
+    std::unique_ptr<uint8_t[], FreeDeleter> mSoa;     // 64 byte aligned
+    bool mSoaValid;
+    unsigned mSeed;
+};
+
+// Results
+void printResults(std::ostream& os, const std::vector<Result>& results);
+bool writeJson(const std::string& path, const char* mode, const Options& options,
+               const std::vector<Result>& results);
+
+// Scene object helpers
+moonray::shading::TLState* initTls();
+
+// Create an object named /bench/<name>, or return nullptr if the class
+// cannot be loaded
+scene_rdl2::rdl2::SceneObject* createObject(scene_rdl2::rdl2::SceneContext& context,
+                                            const std::string& className,
+                                            const std::string& name);
+
+// Set or bind an attribute by name, reporting failures rather than throwing.
+// Binding to a null map does nothing.
+template <typename T>
+void
+setAttribute(scene_rdl2::rdl2::SceneObject* object, const std::string& name, const T& value)
+{
+    try {
+        const scene_rdl2::rdl2::AttributeKey<T> key =
+            object->getSceneClass().template getAttributeKey<T>(name);
+        object->set(key, value);
+    } catch (const std::exception& e) {
+        std::cerr << object->getName() << ": unable to set " << name << ": " << e.what() << '\n';
+    }
+}
+
+void bindAttribute(scene_rdl2::rdl2::SceneObject* object, const std::string& name,
+                   scene_rdl2::rdl2::SceneObject* map);
+
+// Return the class names of every dso in dsoPath, in name order
+std::vector<std::string> findDsoClasses(const std::string& dsoPath);
+
+// Should the class named className be run, given the --class/--skip filters
+bool isSelected(const Options& options, const std::string& className);
+
+} // bench
+} // moonshine
+
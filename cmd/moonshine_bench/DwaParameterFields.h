@@ -0,0 +1,268 @@
+// Copyright 2023-2024 DreamWorks Animation LLC
+// SPDX-License-Identifier: Apache-2.0
+
+///
+/// @file DwaParameterFields.h
+/// $Id$
+///
+/// The DwaBaseParameters fields compared between the scalar and ISPC
+/// resolveParameters() paths. This file is included from both C++ and ISPC
+/// so the two sides always extract the same fields in the same order.
+///
+/// DWABASE_BENCH_PARAMETER_FIELDS(F, I) lists every member the resolve
+/// paths write, F for float members and I for bool, int, enum and intptr_t
+/// ones, which are compared after conversion to int64. Each comes with a
+/// guard, an expression of the extracted `params` that is false where the
+/// member is left undefined: the per family structs of a family missing
+/// from mLobeFamilies, and the ramp points and color corrections past their
+/// counts. A member whose guard is false is extracted as 0. Pointers are
+/// left out, they point at the same objects on both paths or differ by
+/// design (mGlitterPointerScalar and mGlitterPointerVector,
+/// mEvalSubsurfaceNormalFn), except for the address of a compiled color
+/// correction, which both paths must share. So is mFuzzNormalDial, which
+/// is never initialized and only written together with the mFuzzNormal it
+/// is folded into.
+///
+
+#pragma once
+
+#ifdef ISPC
+#define DWABASE_BENCH_LOBE_FAMILY(family) LOBE_FAMILY_##family
+#else
+#define DWABASE_BENCH_LOBE_FAMILY(family) ispc::LOBE_FAMILY_##family
+#endif
+
+#define DWABASE_BENCH_HAS(family) ((params.mLobeFamilies & DWABASE_BENCH_LOBE_FAMILY(family)) != 0)
+
+#define DWABASE_BENCH_SCALAR(F, field, guard) F(field, guard)
+#define DWABASE_BENCH_VEC2(F, field, guard) F(field.x, guard) F(field.y, guard)
+#define DWABASE_BENCH_VEC3(F, field, guard) F(field.x, guard) F(field.y, guard) F(field.z, guard)
+#define DWABASE_BENCH_COLOR(F, field, guard) F(field.r, guard) F(field.g, guard) F(field.b, guard)
+
+// The first count elements of a DWABASE_MAX_TOOND_RAMP_POINTS or
+// DWABASE_MAX_IRIDESCENCE_RAMP_POINTS array, both 10 long, each expanded
+// with E(F, element, guard)
+#define DWABASE_BENCH_ARRAY10(E, F, array, count, guard)                       \
+    E(F, array[0], (guard) && 0 < params.count)                                \
+    E(F, array[1], (guard) && 1 < params.count)                                \
+    E(F, array[2], (guard) && 2 < params.count)                                \
+    E(F, array[3], (guard) && 3 < params.count)                                \
+    E(F, array[4], (guard) && 4 < params.count)                                \
+    E(F, array[5], (guard) && 5 < params.count)                                \
+    E(F, array[6], (guard) && 6 < params.count)                                \
+    E(F, array[7], (guard) && 7 < params.count)                                \
+    E(F, array[8], (guard) && 8 < params.count)                                \
+    E(F, array[9], (guard) && 9 < params.count)
+
+// Both elements of a NOISE_WORLEY_GLITTER_NUM_STYLES array
+#define DWABASE_BENCH_STYLES(E, F, array, guard)                               \
+    E(F, array[0], guard)                                                      \
+    E(F, array[1], guard)
+
+#define DWABASE_BENCH_GLITTER_FIELDS(F, I, p, guard)                           \
+    DWABASE_BENCH_STYLES(DWABASE_BENCH_COLOR, F, p.mFlakeColor, guard)         \
+    DWABASE_BENCH_STYLES(DWABASE_BENCH_SCALAR, F, p.mFlakeRoughness, guard)    \
+    DWABASE_BENCH_VEC3(F, p.mFlakeHSVColorVariation, guard)                    \
+    DWABASE_BENCH_STYLES(DWABASE_BENCH_SCALAR, F, p.mFlakeStyleFrequency, guard) \
+    DWABASE_BENCH_STYLES(DWABASE_BENCH_SCALAR, F, p.mFlakeSize, guard)         \
+    F(p.mFlakeDensity, guard)                                                  \
+    F(p.mFlakeJitter, guard)                                                   \
+    F(p.mFlakeOrientationRandomness, guard)                                    \
+    I(p.mApproximateForSecRays, guard)                                         \
+    I(p.mCompensateDeformation, guard)
+
+#define DWABASE_BENCH_HAIR_FIELDS(F, I, p, guard)                              \
+    DWABASE_BENCH_VEC3(F, p.mHairDir, guard)                                   \
+    DWABASE_BENCH_COLOR(F, p.mHairColor, guard)                                \
+    I(p.mHairCastsCaustics, guard)                                             \
+    DWABASE_BENCH_VEC2(F, p.mHairUV, guard)                                    \
+    F(p.mHairIOR, guard)                                                       \
+    I(p.mHairShowR, guard)                                                     \
+    F(p.mHairRShift, guard)                                                    \
+    F(p.mHairRLongRoughness, guard)                                            \
+    DWABASE_BENCH_COLOR(F, p.mHairRTint, guard)                                \
+    I(p.mHairShowTT, guard)                                                    \
+    F(p.mHairTTShift, guard)                                                   \
+    F(p.mHairTTLongRoughness, guard)                                           \
+    F(p.mHairTTAzimRoughness, guard)                                           \
+    F(p.mHairTTSaturation, guard)                                              \
+    DWABASE_BENCH_COLOR(F, p.mHairTTTint, guard)                               \
+    I(p.mHairShowTRT, guard)                                                   \
+    F(p.mHairTRTShift, guard)                                                  \
+    F(p.mHairTRTLongRoughness, guard)                                          \
+    DWABASE_BENCH_COLOR(F, p.mHairTRTTint, guard)                              \
+    I(p.mHairShowGlint, guard)                                                 \
+    F(p.mHairGlintRoughness, guard)                                            \
+    F(p.mHairGlintMinTwists, guard)                                            \
+    F(p.mHairGlintMaxTwists, guard)                                            \
+    F(p.mHairGlintEccentricity, guard)                                         \
+    F(p.mHairGlintSaturation, guard)                                           \
+    I(p.mHairShowTRRT, guard)                                                  \
+    F(p.mHairTRRTLongRoughness, guard)                                         \
+    I(p.mHairFresnelType, guard)                                               \
+    F(p.mHairCuticleLayerThickness, guard)                                     \
+    I(p.mHairUseOptimizedSampling, guard)                                      \
+    F(p.mHairDiffuse, guard)                                                   \
+    DWABASE_BENCH_COLOR(F, p.mHairDiffuseFrontColor, guard)                    \
+    DWABASE_BENCH_COLOR(F, p.mHairDiffuseBackColor, guard)                     \
+    I(p.mHairDiffuseUseIndependentFrontAndBackColor, guard)                    \
+    F(p.mHairSubsurfaceBlend, guard)
+
+#define DWABASE_BENCH_TOON_DIFFUSE_FIELDS(F, I, p, guard)                      \
+    I(p.mModel, guard)                                                         \
+    F(p.mTerminatorShift, guard)                                               \
+    F(p.mFlatness, guard)                                                      \
+    F(p.mFlatnessFalloff, guard)                                               \
+    F(p.mRampWeight, guard)                                                    \
+    I(p.mRampNumPoints, guard)                                                 \
+    DWABASE_BENCH_ARRAY10(DWABASE_BENCH_SCALAR, F, p.mRampPositions, p.mRampNumPoints, guard) \
+    DWABASE_BENCH_ARRAY10(DWABASE_BENCH_COLOR, F, p.mRampColors, p.mRampNumPoints, guard) \
+    DWABASE_BENCH_ARRAY10(DWABASE_BENCH_SCALAR, I, p.mRampInterpolators, p.mRampNumPoints, guard) \
+    DWABASE_BENCH_VEC3(F, p.mNormal, guard)                                    \
+    I(p.mExtendRamp, guard)                                                    \
+    F(p.mRampInputScale, guard)
+
+#define DWABASE_BENCH_TOON_SPECULAR_FIELDS(F, I, p, guard)                     \
+    F(p.mIntensity, guard)                                                     \
+    F(p.mFresnelBlend, guard)                                                  \
+    F(p.mRoughness, guard)                                                     \
+    DWABASE_BENCH_COLOR(F, p.mTint, guard)                                     \
+    F(p.mRampInputScale, guard)                                                \
+    I(p.mRampNumPoints, guard)                                                 \
+    DWABASE_BENCH_ARRAY10(DWABASE_BENCH_SCALAR, F, p.mRampPositions, p.mRampNumPoints, guard) \
+    DWABASE_BENCH_ARRAY10(DWABASE_BENCH_SCALAR, F, p.mRampValues, p.mRampNumPoints, guard) \
+    DWABASE_BENCH_ARRAY10(DWABASE_BENCH_SCALAR, I, p.mRampInterpolators, p.mRampNumPoints, guard) \
+    DWABASE_BENCH_VEC3(F, p.mNormal, guard)                                    \
+    F(p.mStretchU, guard)                                                      \
+    F(p.mStretchV, guard)                                                      \
+    DWABASE_BENCH_VEC3(F, p.mdPds, guard)                                      \
+    DWABASE_BENCH_VEC3(F, p.mdPdt, guard)                                      \
+    I(p.mEnableIndirectReflections, guard)                                     \
+    F(p.mIndirectReflectionsIntensity, guard)                                  \
+    F(p.mIndirectReflectionsRoughness, guard)                                  \
+    DWABASE_BENCH_VEC3(F, p.mHairDir, guard)                                   \
+    DWABASE_BENCH_VEC2(F, p.mHairUV, guard)                                    \
+    F(p.mHairIOR, guard)                                                       \
+    I(p.mHairFresnelType, guard)                                               \
+    F(p.mHairCuticleLayerThickness, guard)                                     \
+    F(p.mHairRShift, guard)
+
+#define DWABASE_BENCH_IRIDESCENCE_FIELDS(F, I, p, guard)                       \
+    I(p.mIridescenceColorControl, guard)                                       \
+    DWABASE_BENCH_COLOR(F, p.mIridescencePrimaryColor, guard)                  \
+    DWABASE_BENCH_COLOR(F, p.mIridescenceSecondaryColor, guard)                \
+    I(p.mIridescenceFlipHueDirection, guard)                                   \
+    F(p.mIridescenceThickness, guard)                                          \
+    F(p.mIridescenceExponent, guard)                                           \
+    F(p.mIridescenceAt0, guard)                                                \
+    F(p.mIridescenceAt90, guard)                                               \
+    I(p.mIridescenceRampInterpolationMode, guard)                              \
+    I(p.mIridescenceRampNumPoints, guard)                                      \
+    DWABASE_BENCH_ARRAY10(DWABASE_BENCH_SCALAR, F, p.mIridescenceRampPositions, p.mIridescenceRampNumPoints, guard) \
+    DWABASE_BENCH_ARRAY10(DWABASE_BENCH_COLOR, F, p.mIridescenceRampColors, p.mIridescenceRampNumPoints, guard) \
+    DWABASE_BENCH_ARRAY10(DWABASE_BENCH_SCALAR, I, p.mIridescenceRampInterpolators, p.mIridescenceRampNumPoints, guard)
+
+#define DWABASE_BENCH_COLOR_CORRECTION(F, I, cc, guard)                        \
+    I(cc.mOn, guard)                                                           \
+    F(cc.mMix, guard)                                                          \
+    F(cc.mHueShift, guard)                                                     \
+    F(cc.mSaturation, guard)                                                   \
+    F(cc.mGain, guard)                                                         \
+    I(cc.mTmiEnabled, guard)                                                   \
+    DWABASE_BENCH_COLOR(F, cc.mTmi, guard)                                     \
+    I(cc.mCompiled, guard)
+
+#define DWABASE_BENCH_COLOR_CORRECTIONS(F, I)                                  \
+    DWABASE_BENCH_COLOR_CORRECTION(F, I, mColorCorrectParams[0], 0 < params.mNumColorCorrections) \
+    DWABASE_BENCH_COLOR_CORRECTION(F, I, mColorCorrectParams[1], 1 < params.mNumColorCorrections) \
+    DWABASE_BENCH_COLOR_CORRECTION(F, I, mColorCorrectParams[2], 2 < params.mNumColorCorrections) \
+    DWABASE_BENCH_COLOR_CORRECTION(F, I, mColorCorrectParams[3], 3 < params.mNumColorCorrections) \
+    DWABASE_BENCH_COLOR_CORRECTION(F, I, mColorCorrectParams[4], 4 < params.mNumColorCorrections) \
+    DWABASE_BENCH_COLOR_CORRECTION(F, I, mColorCorrectParams[5], 5 < params.mNumColorCorrections) \
+    DWABASE_BENCH_COLOR_CORRECTION(F, I, mColorCorrectParams[6], 6 < params.mNumColorCorrections) \
+    DWABASE_BENCH_COLOR_CORRECTION(F, I, mColorCorrectParams[7], 7 < params.mNumColorCorrections) \
+    DWABASE_BENCH_COLOR_CORRECTION(F, I, mColorCorrectParams[8], 8 < params.mNumColorCorrections) \
+    DWABASE_BENCH_COLOR_CORRECTION(F, I, mColorCorrectParams[9], 9 < params.mNumColorCorrections)
+
+#define DWABASE_BENCH_PARAMETER_FIELDS(F, I)                                   \
+    I(mLobeFamilies, true)                                                     \
+    F(mGlitterVaryingParameters.mGlitterMask, true)                            \
+    DWABASE_BENCH_GLITTER_FIELDS(F, I, mGlitterVaryingParameters, DWABASE_BENCH_HAS(GLITTER)) \
+    F(mHairParameters.mHair, true)                                             \
+    DWABASE_BENCH_HAIR_FIELDS(F, I, mHairParameters, true)                     \
+    F(mFuzz, true)                                                             \
+    DWABASE_BENCH_COLOR(F, mFuzzAlbedo, true)                                  \
+    F(mFuzzRoughness, true)                                                    \
+    I(mFuzzUseAbsorbingFibers, true)                                           \
+    DWABASE_BENCH_VEC3(F, mFuzzNormal, true)                                   \
+    F(mOuterSpecular, true)                                                    \
+    F(mOuterSpecularRefractiveIndex, true)                                     \
+    F(mOuterSpecularRoughness, true)                                           \
+    F(mOuterSpecularThickness, true)                                           \
+    DWABASE_BENCH_COLOR(F, mOuterSpecularAttenuationColor, true)               \
+    DWABASE_BENCH_VEC3(F, mOuterSpecularNormal, true)                          \
+    F(mOuterSpecularNormalLength, true)                                        \
+    F(mOuterSpecularNormalDial, true)                                          \
+    F(mMetallic, true)                                                         \
+    DWABASE_BENCH_COLOR(F, mMetallicColor, true)                               \
+    DWABASE_BENCH_COLOR(F, mMetallicEdgeColor, true)                           \
+    F(mSpecular, true)                                                         \
+    F(mRefractiveIndex, true)                                                  \
+    F(mRoughness, true)                                                        \
+    F(mAnisotropy, true)                                                       \
+    DWABASE_BENCH_VEC2(F, mShadingTangent, true)                               \
+    F(mFabricSpecular, true)                                                   \
+    DWABASE_BENCH_COLOR(F, mWarpColor, true)                                   \
+    F(mWarpRoughness, true)                                                    \
+    I(mUseIndependentWeftAttributes, true)                                     \
+    F(mWeftRoughness, true)                                                    \
+    DWABASE_BENCH_COLOR(F, mWeftColor, true)                                   \
+    DWABASE_BENCH_VEC3(F, mWarpThreadDirection, true)                          \
+    F(mWarpThreadCoverage, true)                                               \
+    F(mWarpThreadElevation, true)                                              \
+    F(mFabricAttenuation, true)                                                \
+    DWABASE_BENCH_VEC3(F, mFabricTangent, true)                                \
+    F(mIridescenceParameters.mIridescence, true)                               \
+    I(mIridescenceParameters.mIridescenceApplyTo, true)                        \
+    DWABASE_BENCH_IRIDESCENCE_FIELDS(F, I, mIridescenceParameters, DWABASE_BENCH_HAS(IRIDESCENCE)) \
+    F(mTransmission, true)                                                     \
+    DWABASE_BENCH_COLOR(F, mTransmissionColor, true)                           \
+    I(mUseIndependentTransmissionRefractiveIndex, true)                        \
+    F(mIndependentTransmissionRefractiveIndex, true)                           \
+    I(mUseIndependentTransmissionRoughness, true)                              \
+    F(mIndependentTransmissionRoughness, true)                                 \
+    F(mDispersionAbbeNumber, true)                                             \
+    F(mToonDiffuseParams.mToonDiffuse, true)                                   \
+    DWABASE_BENCH_TOON_DIFFUSE_FIELDS(F, I, mToonDiffuseParams, DWABASE_BENCH_HAS(TOON)) \
+    F(mToonSpecularParams.mToonSpecular, true)                                 \
+    DWABASE_BENCH_TOON_SPECULAR_FIELDS(F, I, mToonSpecularParams, DWABASE_BENCH_HAS(TOON)) \
+    F(mHairToonS1Params.mToonSpecular, true)                                   \
+    DWABASE_BENCH_TOON_SPECULAR_FIELDS(F, I, mHairToonS1Params, DWABASE_BENCH_HAS(HAIR_TOON)) \
+    F(mHairToonS2Params.mToonSpecular, true)                                   \
+    DWABASE_BENCH_TOON_SPECULAR_FIELDS(F, I, mHairToonS2Params, DWABASE_BENCH_HAS(HAIR_TOON)) \
+    F(mHairToonS3Params.mToonSpecular, true)                                   \
+    DWABASE_BENCH_TOON_SPECULAR_FIELDS(F, I, mHairToonS3Params, DWABASE_BENCH_HAS(HAIR_TOON)) \
+    DWABASE_BENCH_COLOR(F, mAlbedo, true)                                      \
+    F(mDiffuseRoughness, true)                                                 \
+    DWABASE_BENCH_COLOR(F, mScatteringRadius, true)                            \
+    F(mCreaseAttenuation, true)                                                \
+    I(mSSSResolveSelfIntersections, true)                                      \
+    DWABASE_BENCH_COLOR(F, mDiffuseTransmission, true)                         \
+    I(mDiffuseTransmissionBlendingBehavior, true)                              \
+    DWABASE_BENCH_VEC3(F, mNormal, true)                                       \
+    DWABASE_BENCH_VEC3(F, mDiffuseNormal, true)                                \
+    F(mNormalLength, true)                                                     \
+    F(mNormalDial, true)                                                       \
+    I(mNormalAAStrategy, true)                                                 \
+    F(mNormalAADial, true)                                                     \
+    DWABASE_BENCH_COLOR(F, mEmission, true)                                    \
+    I(mNumColorCorrections, true)                                              \
+    DWABASE_BENCH_COLOR_CORRECTIONS(F, I)                                      \
+    F(mAccentParams.mSubsurface, true)                                         \
+    DWABASE_BENCH_COLOR(F, mAccentParams.mSubsurfaceColor, true)               \
+    F(mAccentParams.mSubsurfaceNormalDial, true)                               \
+    DWABASE_BENCH_VEC3(F, mAccentParams.mSubsurfaceNormal, true)
+
+#define DWABASE_BENCH_COUNT_FIELD(field, guard) + 1
+#define DWABASE_BENCH_NUM_PARAMETER_FIELDS \
+    (0 DWABASE_BENCH_PARAMETER_FIELDS(DWABASE_BENCH_COUNT_FIELD, DWABASE_BENCH_COUNT_FIELD))
@@ -0,0 +1,170 @@
+// Copyright 2023-2024 DreamWorks Animation LLC
+// SPDX-License-Identifier: Apache-2.0
+
+///
+/// @file GeometryBench.cc
+/// $Id$
+///
+
+#include "GeometryBench.h"
+
+#include <moonshine/geometry/data/PrimitiveUserData.h>
+#include <moonshine/geometry/data/ScatterInstances.h>
+#include <moonray/rendering/geom/Api.h>
+#include <scene_rdl2/render/util/Random.h>
+
+#include <cmath>
+#include <fstream>
+#include <string>
+#include <unistd.h>
+
+using namespace scene_rdl2::math;
+namespace geom = moonray::geom;
+
+namespace moonshine {
+namespace bench {
+
+namespace {
+
+constexpr int sNumPrototypes = 4;
+constexpr unsigned sMinInstances = 1000;
+
+// The resident set size of this process. Freed memory is not always handed
+// back to the system, so sizes are run smallest first and every measurement
+// is the growth over one stage.
+int64_t
+residentBytes()
+{
+    std::ifstream statm("/proc/self/statm");
+    int64_t size = 0, resident = 0;
+    statm >> size >> resident;
+    return resident * sysconf(_SC_PAGESIZE);
+}
+
+// The arrays a scattering tool would write, with a color per instance
+struct ScatterArrays
+{
+    scene_rdl2::rdl2::IntVector mReferenceIndices;
+    scene_rdl2::rdl2::Vec3fVector mPositions;
+    scene_rdl2::rdl2::Vec4fVector mOrientations;
+    scene_rdl2::rdl2::Vec3fVector mScales;
+    scene_rdl2::rdl2::RgbVector mColors;
+
+    ScatterArrays(unsigned numInstances, unsigned seed)
+    {
+        scene_rdl2::util::Random rng(seed);
+        const float extent = std::sqrt(static_cast<float>(numInstances));
+        for (unsigned i = 0; i < numInstances; ++i) {
+            mReferenceIndices.push_back(static_cast<int>(i % sNumPrototypes));
+            mPositions.emplace_back(rng.getNextFloat() * extent, 0.0f, rng.getNextFloat() * extent);
+            mOrientations.emplace_back(0.0f, rng.getNextFloat() * 2.0f - 1.0f, 0.0f, 1.0f);
+            mScales.emplace_back(0.5f + rng.getNextFloat());
+            mColors.emplace_back(rng.getNextFloat(), rng.getNextFloat(), rng.getNextFloat());
+        }
+    }
+};
+
+Result
+makeResult(unsigned numInstances, const char* path, double seconds, int64_t bytes)
+{
+    Result result;
+    result.mClassName = "ScatterGeometry/" + std::to_string(numInstances);
+    result.mPath = path;
+    result.mSamples = numInstances;
+    result.mSeconds = seconds;
+    result.mBytes = bytes;
+    return result;
+}
+
+} // anonymous namespace
+
+std::vector<Result>
+runScatterBench(const Options& options)
+{
+    std::vector<Result> results;
+    if (!isSelected(options, "ScatterGeometry")) {
+        return results;
+    }
+
+    scene_rdl2::rdl2::SceneContext context;
+    context.setDsoPath(options.mDsoPath);
+
+    // Stand-ins for the prototypes' primitives, the renderer builds these
+    // from the reference geometries
+    std::vector<std::shared_ptr<geom::SharedPrimitive>> prototypes;
+    for (int i = 0; i < sNumPrototypes; ++i) {
+        prototypes.push_back(geom::createSharedPrimitive(
+            geom::createBox(1.0f, 1.0f + i, 1.0f, geom::LayerAssignmentId(0))));
+    }
+
+    for (unsigned n = sMinInstances; n <= options.mMaxInstances; n *= 10) {
+        const ScatterArrays arrays(n, options.mSeed);
+        const std::string suffix = std::to_string(n);
+
+        // Load: the rdl2 side of the scatter, its arrays and user data
+        int64_t rss = residentBytes();
+        Timer loadTimer;
+        scene_rdl2::rdl2::SceneObject* colors = createObject(context, "UserData", "colors" + suffix);
+        scene_rdl2::rdl2::SceneObject* scatter =
+            createObject(context, "ScatterGeometry", "scatter" + suffix);
+        if (!colors || !scatter) {
+            return results;
+        }
+        scene_rdl2::rdl2::UserData* userData = colors->asA<scene_rdl2::rdl2::UserData>();
+        userData->beginUpdate();
+        userData->setColorData("color", arrays.mColors);
+        userData->endUpdate();
+
+        scatter->beginUpdate();
+        setAttribute(scatter, "reference_indices", arrays.mReferenceIndices);
+        setAttribute(scatter, "positions", arrays.mPositions);
+        setAttribute(scatter, "orientations", arrays.mOrientations);
+        setAttribute(scatter, "scales", arrays.mScales);
+        setAttribute(scatter, "primitive_attributes", scene_rdl2::rdl2::SceneObjectVector{colors});
+        scatter->endUpdate();
+        results.push_back(makeResult(n, "load", loadTimer.seconds(), residentBytes() - rss));
+
+        const scene_rdl2::rdl2::SceneObjectVector arbitraryData{colors};
+
+        // Instanced: what ScatterGeometry hands to the renderer
+        {
+            rss = residentBytes();
+            Timer timer;
+            std::vector<std::unique_ptr<geom::Instance>> instances =
+                geometry::createScatterInstances(prototypes,
+                                                 arrays.mReferenceIndices,
+                                                 arrays.mPositions,
+                                                 arrays.mOrientations,
+                                                 arrays.mScales,
+                                                 arbitraryData,
+                                                 true, false);
+            const double seconds = timer.seconds();
+            results.push_back(makeResult(n, "instanced", seconds, residentBytes() - rss));
+        }
+
+        // Copies: one primitive per instance, as with one geometry object
+        // per instance. The box is about the smallest primitive there is, a
+        // real prototype would make the difference far larger.
+        {
+            rss = residentBytes();
+            Timer timer;
+            std::vector<std::unique_ptr<geom::Box>> copies;
+            copies.reserve(n);
+            for (unsigned i = 0; i < n; ++i) {
+                moonray::shading::PrimitiveAttributeTable primitiveAttributeTable;
+                geometry::processInstanceUserData(arbitraryData, i, true, false,
+                                                  primitiveAttributeTable);
+                copies.push_back(geom::createBox(1.0f, 1.0f + arrays.mReferenceIndices[i], 1.0f,
+                                                 geom::LayerAssignmentId(0),
+                                                 std::move(primitiveAttributeTable)));
+            }
+            const double seconds = timer.seconds();
+            results.push_back(makeResult(n, "copies", seconds, residentBytes() - rss));
+        }
+    }
+
+    return results;
+}
+
+} // bench
+} // moonshine
@@ -0,0 +1,24 @@
+// Copyright 2023-2024 DreamWorks Animation LLC
+// SPDX-License-Identifier: Apache-2.0
+
+///
+/// @file GeometryBench.h
+/// $Id$
+///
+
+#pragma once
+
+#include "BenchUtil.h"
+
+namespace moonshine {
+namespace bench {
+
+// Scatter 1000 to options.mMaxInstances instances, 10x apart, of a few
+// prototypes with a per-instance color, and time and measure the resident
+// memory of setting the ScatterGeometry arrays ("load"), of building the
+// instances of shared prototypes ("instanced") and of building one primitive
+// per instance instead ("copies"). Results are named ScatterGeometry/<count>.
+std::vector<Result> runScatterBench(const Options& options);
+
+} // bench
+} // moonshine
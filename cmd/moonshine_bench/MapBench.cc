@@ -0,0 +1,220 @@
+// Copyright 2023-2024 DreamWorks Animation LLC
+// SPDX-License-Identifier: Apache-2.0
+
+///
+/// @file MapBench.cc
+/// $Id$
+///
+
+#include "MapBench.h"
+
+#include <scene_rdl2/common/math/Color.h>
+#include <scene_rdl2/scene/rdl2/ISPCSupport.h>
+
+#include <cmath>
+#include <iostream>
+#include <string>
+
+using namespace scene_rdl2::math;
+
+namespace moonshine {
+namespace bench {
+
+namespace {
+
+// Prevents the compiler from discarding the sample loops
+volatile float sSink = 0.0f;
+
+Result
+timeScalar(const scene_rdl2::rdl2::Map& map, moonray::shading::TLState* tls,
+           const StateBatch& batch, const Options& options)
+{
+    Color sample;
+    float sum = 0.0f;
+    for (unsigned pass = 0; pass < options.mWarmup; ++pass) {
+        for (unsigned i = 0; i < batch.size(); ++i) {
+            map.sample(tls, batch.state(i), &sample);
+            sum += sample.r;
+        }
+    }
+
+    const Timer timer;
+    for (unsigned pass = 0; pass < options.mIterations; ++pass) {
+        for (unsigned i = 0; i < batch.size(); ++i) {
+            map.sample(tls, batch.state(i), &sample);
+            sum += sample.r;
+        }
+    }
+
+    Result result;
+    result.mClassName = map.getSceneClass().getName();
+    result.mPath = "scalar";
+    result.mLaneWidth = 1;
+    result.mSeconds = timer.seconds();
+    result.mSamples = static_cast<uint64_t>(options.mIterations) * batch.size();
+    sSink = sSink + sum;
+    return result;
+}
+
+Result
+timeVector(const scene_rdl2::rdl2::Map& map, moonray::shading::TLState* tls,
+           StateBatch& batch, const Options& options)
+{
+    const scene_rdl2::rdl2::SampleFuncv sampleFuncv = map.getSampleFuncv();
+    const unsigned numStatev = batch.numStatev();
+    const scene_rdl2::rdl2::Statev* statev = batch.statev();
+
+    // r, g and b planes of VLEN floats per block
+    std::vector<float> out(static_cast<size_t>(numStatev) * 3 * VLEN + 16);
+    float* aligned = reinterpret_cast<float*>((reinterpret_cast<uintptr_t>(out.data()) + 63) & ~uintptr_t(63));
+    scene_rdl2::rdl2::Colorv* samplev = reinterpret_cast<scene_rdl2::rdl2::Colorv*>(aligned);
+
+    for (unsigned pass = 0; pass < options.mWarmup; ++pass) {
+        sampleFuncv(&map, tls, numStatev, statev, samplev);
+    }
+
+    const Timer timer;
+    for (unsigned pass = 0; pass < options.mIterations; ++pass) {
+        sampleFuncv(&map, tls, numStatev, statev, samplev);
+    }
+
+    Result result;
+    result.mClassName = map.getSceneClass().getName();
+    result.mPath = "vector";
+    result.mLaneWidth = VLEN;
+    result.mSeconds = timer.seconds();
+    result.mSamples = static_cast<uint64_t>(options.mIterations) * batch.size();
+    sSink = sSink + aligned[0];
+    return result;
+}
+
+// Number of inputs of the switch maps
+constexpr int sNumSwitchInputs = 64;
+
+} // anonymous namespace
+
+std::vector<Result>
+runMapBench(const Options& options, moonray::shading::TLState* tls)
+{
+    std::vector<Result> results;
+
+    scene_rdl2::rdl2::SceneContext context;
+    context.setDsoPath(options.mDsoPath);
+
+    for (const std::string& className : findDsoClasses(options.mDsoPath)) {
+        if (!isSelected(options, className)) {
+            continue;
+        }
+
+        scene_rdl2::rdl2::SceneObject* object = nullptr;
+        try {
+            const scene_rdl2::rdl2::SceneClass* sceneClass = context.createSceneClass(className);
+            if (!(sceneClass->getDeclaredInterface() & scene_rdl2::rdl2::INTERFACE_MAP)) {
+                continue;
+            }
+            object = context.createSceneObject(className, "/bench/" + className);
+        } catch (const std::exception& e) {
+            std::cerr << "Skipping " << className << ": " << e.what() << '\n';
+            continue;
+        }
+
+        // Every attribute is left at its default, which exercises each
+        // shader's unbound fast paths. Run a scene through moonray for
+        // bound networks.
+        scene_rdl2::rdl2::Map* map = object->asA<scene_rdl2::rdl2::Map>();
+        map->update();
+
+        StateBatch batch(options.mNumStates, options.mSeed);
+        batch.attachAttributes(*map, tls);
+
+        results.push_back(timeScalar(*map, tls, batch, options));
+        results.push_back(timeVector(*map, tls, batch, options));
+    }
+
+    return results;
+}
+
+std::vector<Result>
+runSwitchBench(const Options& options, moonray::shading::TLState* tls)
+{
+    std::vector<Result> results;
+
+    scene_rdl2::rdl2::SceneContext context;
+    context.setDsoPath(options.mDsoPath);
+
+    // The choice is the batch's column index modulo the number of choices.
+    // The states of a gang lie along a row, so a gang sees
+    // min(choices, VLEN) distinct inputs.
+    StateBatch batch(options.mNumStates, options.mSeed);
+    const float res = std::ceil(std::sqrt(static_cast<float>(batch.size())));
+
+    scene_rdl2::rdl2::SceneObject* column = createObject(context, "UVTransformMap", "column");
+    scene_rdl2::rdl2::SceneObject* choice = createObject(context, "OpMap", "choice");
+    if (!column || !choice) {
+        return results;
+    }
+    column->beginUpdate();
+    setAttribute<scene_rdl2::rdl2::Vec2f>(column, "scale", Vec2f(res, res));
+    column->endUpdate();
+    column->update();
+
+    choice->beginUpdate();
+    setAttribute<scene_rdl2::rdl2::Int>(choice, "operation", 18);   // modulo
+    bindAttribute(choice, "op1", column);
+    choice->endUpdate();
+
+    // A separate network per input, as with variants picked by instance id
+    std::vector<scene_rdl2::rdl2::SceneObject*> inputs;
+    for (int i = 0; i < sNumSwitchInputs; ++i) {
+        scene_rdl2::rdl2::SceneObject* noise =
+            createObject(context, "NoiseMap_v2", "noise" + std::to_string(i));
+        if (!noise) {
+            return results;
+        }
+        noise->beginUpdate();
+        setAttribute<scene_rdl2::rdl2::Int>(noise, "seed", i);
+        setAttribute<scene_rdl2::rdl2::Float>(noise, "max_level", 4.0f);
+        noise->endUpdate();
+        noise->update();
+        inputs.push_back(noise);
+    }
+
+    for (const char* className : {"SwitchColorMap", "SwitchFloatMap"}) {
+        if (!isSelected(options, className)) {
+            continue;
+        }
+
+        scene_rdl2::rdl2::SceneObject* object = createObject(context, className, className);
+        if (!object) {
+            continue;
+        }
+        object->beginUpdate();
+        bindAttribute(object, "choice", choice);
+        for (int i = 0; i < sNumSwitchInputs; ++i) {
+            bindAttribute(object, "input" + std::to_string(i), inputs[i]);
+        }
+        object->endUpdate();
+
+        scene_rdl2::rdl2::Map* map = object->asA<scene_rdl2::rdl2::Map>();
+        map->update();
+        for (int choices = 1; choices <= sNumSwitchInputs; choices *= 2) {
+            choice->beginUpdate();
+            setAttribute<scene_rdl2::rdl2::Rgb>(choice, "op2",
+                                                Color(static_cast<float>(choices)));
+            choice->endUpdate();
+            choice->update();
+
+            const std::string name = std::string(className) + "/" + std::to_string(choices);
+            results.push_back(timeScalar(*map, tls, batch, options));
+            results.back().mClassName = name;
+            results.push_back(timeVector(*map, tls, batch, options));
+            results.back().mClassName = name;
+        }
+    }
+
+    return results;
+}
+
+} // bench
+} // moonshine
+
@@ -0,0 +1,27 @@
+// Copyright 2023-2024 DreamWorks Animation LLC
+// SPDX-License-Identifier: Apache-2.0
+
+///
+/// @file MapBench.h
+/// $Id$
+///
+
+#pragma once
+
+#include "BenchUtil.h"
+
+namespace moonshine {
+namespace bench {
+
+// Load every map dso found in options.mDsoPath and time its scalar and ISPC
+// sample functions over the same batch of synthetic shading states.
+std::vector<Result> runMapBench(const Options& options, moonray::shading::TLState* tls);
+
+// Time SwitchColorMap and SwitchFloatMap with every input bound to its own
+// noise network while sweeping the number of distinct choices per gang.
+// Results are named <class>/<choices>.
+std::vector<Result> runSwitchBench(const Options& options, moonray::shading::TLState* tls);
+
+} // bench
+} // moonshine
+
@@ -0,0 +1,408 @@
+// Copyright 2023-2024 DreamWorks Animation LLC
+// SPDX-License-Identifier: Apache-2.0
+
+///
+/// @file MaterialBench.cc
+/// $Id$
+///
+
+#include "MaterialBench.h"
+#include "DwaParameterFields.h"
+#include "MaterialBench_ispc_stubs.h"
+
+#include <moonshine/material/dwabase/DwaBaseLayerable.h>
+#include <moonshine/material/glitter/FlakeCache.h>
+#include <moonray/rendering/shading/bsdf/Bsdf.h>
+#include <moonray/rendering/shading/bsdf/BsdfBuilder.h>
+#include <scene_rdl2/render/util/Arena.h>
+
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <tuple>
+#include <utility>
+
+using namespace scene_rdl2::math;
+using scene_rdl2::rdl2::Attribute;
+using scene_rdl2::rdl2::AttributeKey;
+using scene_rdl2::rdl2::Material;
+using scene_rdl2::rdl2::SceneContext;
+using scene_rdl2::rdl2::SceneObject;
+
+namespace moonshine {
+namespace bench {
+
+namespace {
+
+constexpr unsigned sNumFields = DWABASE_BENCH_NUM_PARAMETER_FIELDS;
+constexpr unsigned sFieldStride = sNumFields + 1;   // fields plus the resolve result
+
+const char* const sFieldNames[] = {
+#define MATERIALBENCH_FIELD_NAME(field, guard) #field,
+    DWABASE_BENCH_PARAMETER_FIELDS(MATERIALBENCH_FIELD_NAME, MATERIALBENCH_FIELD_NAME)
+#undef MATERIALBENCH_FIELD_NAME
+    "(resolved)"
+};
+
+// Prevents the compiler from discarding the timing loops
+volatile float sSink = 0.0f;
+
+void
+extractFields(const ispc::DwaBaseParameters& params, bool resolved, float* dst)
+{
+    unsigned f = 0;
+#define MATERIALBENCH_EXTRACT_FLOAT(field, guard) \
+    dst[f++] = (guard) ? static_cast<float>(params.field) : 0.f;
+#define MATERIALBENCH_EXTRACT_INTEGER(field, guard) \
+    dst[f++] = (guard) ? static_cast<float>(static_cast<int64_t>(params.field)) : 0.f;
+    DWABASE_BENCH_PARAMETER_FIELDS(MATERIALBENCH_EXTRACT_FLOAT, MATERIALBENCH_EXTRACT_INTEGER)
+#undef MATERIALBENCH_EXTRACT_INTEGER
+#undef MATERIALBENCH_EXTRACT_FLOAT
+    dst[f] = resolved ? 1.f : 0.f;
+}
+
+bool
+nearlyEqual(float a, float b)
+{
+    if (std::isnan(a) || std::isnan(b)) {
+        return std::isnan(a) && std::isnan(b);
+    }
+    // The ISPC path may use different approximations for pow/exp/etc.
+    return std::abs(a - b) <= 1e-4f + 1e-4f * std::max(std::abs(a), std::abs(b));
+}
+
+//----------------------------------------------------------------------------
+// Scene construction
+
+// Bind materials to the "material" multi-attribute of DwaMix/DwaSwitch
+void
+setMaterialInputs(SceneObject* object, const std::vector<SceneObject*>& inputs)
+{
+    const scene_rdl2::rdl2::SceneClass& sceneClass = object->getSceneClass();
+    size_t i = 0;
+    for (auto it = sceneClass.beginAttributes(); it != sceneClass.endAttributes() && i < inputs.size(); ++it) {
+        const Attribute* attr = *it;
+        if (attr->getType() == scene_rdl2::rdl2::TYPE_SCENE_OBJECT &&
+            attr->getName().compare(0, 8, "material") == 0) {
+            object->set(AttributeKey<SceneObject*>(*attr), inputs[i++]);
+        }
+    }
+}
+
+struct BenchScene
+{
+    // Materials in the order they are benchmarked, with the name their
+    // results are reported under
+    std::vector<std::pair<std::string, Material*>> mMaterials;
+};
+
+// Two contrasting leaf materials, each with a varying input so that the
+// parameters differ between states, a toon leaf, one of each blending
+// material above them, and the adjust and color correct materials, whose
+// corrections are carried through the parameters. leafB uses glitter and
+// an iridescence ramp and the toon leaf a diffuse ramp and toon specular,
+// so the per family structs are compared too. leafB also turns on the
+// glitter flake cache, whose hits and misses are reported for each shade()
+// run. The colorCorrect correction is unbound, so it is compiled into a
+// matrix, while colorCorrectBound varies with the noise and is applied
+// field by field.
+BenchScene
+buildScene(SceneContext& context, const Options& options)
+{
+    BenchScene scene;
+
+    SceneObject* noise = createObject(context, "NoiseMap_v2", "noise");
+    SceneObject* leafA = createObject(context, "DwaBaseMaterial", "leafA");
+    SceneObject* leafB = createObject(context, "DwaBaseMaterial", "leafB");
+    if (!leafA || !leafB) {
+        return scene;
+    }
+
+    SceneObject* toon = createObject(context, "DwaToonMaterial", "toon");
+    SceneObject* layer = createObject(context, "DwaLayerMaterial", "layer");
+    SceneObject* mix = createObject(context, "DwaMixMaterial", "mix");
+    SceneObject* swtch = createObject(context, "DwaSwitchMaterial", "switch");
+    SceneObject* adjust = createObject(context, "DwaAdjustMaterial", "adjust");
+    SceneObject* colorCorrect = createObject(context, "DwaColorCorrectMaterial", "colorCorrect");
+    SceneObject* colorCorrectBound = createObject(context, "DwaColorCorrectMaterial", "colorCorrectBound");
+
+    leafA->beginUpdate();
+    setAttribute<scene_rdl2::rdl2::Rgb>(leafA, "albedo", Color(0.8f, 0.2f, 0.1f));
+    setAttribute<scene_rdl2::rdl2::Float>(leafA, "roughness", 0.3f);
+    bindAttribute(leafA, "roughness", noise);
+    leafA->endUpdate();
+
+    leafB->beginUpdate();
+    setAttribute<scene_rdl2::rdl2::Float>(leafB, "metallic", 1.0f);
+    setAttribute<scene_rdl2::rdl2::Rgb>(leafB, "metallic_color", Color(0.9f, 0.7f, 0.3f));
+    setAttribute<scene_rdl2::rdl2::Float>(leafB, "roughness", 0.6f);
+    setAttribute<scene_rdl2::rdl2::Bool>(leafB, "show_fuzz", true);
+    setAttribute<scene_rdl2::rdl2::Float>(leafB, "fuzz", 0.5f);
+    setAttribute<scene_rdl2::rdl2::Float>(leafB, "iridescence", 0.7f);
+    bindAttribute(leafB, "iridescence", noise);
+    setAttribute<scene_rdl2::rdl2::Int>(leafB, "iridescence_color_control", 1);
+    setAttribute<scene_rdl2::rdl2::Bool>(leafB, "show_glitter", true);
+    setAttribute<scene_rdl2::rdl2::Float>(leafB, "glitter_flake_cache_cell_factor", 0.5f);
+    leafB->endUpdate();
+
+    if (toon) {
+        toon->beginUpdate();
+        setAttribute<scene_rdl2::rdl2::Int>(toon, "diffuse_model", 1);
+        setAttribute<scene_rdl2::rdl2::Int>(toon, "specular_model", 2);
+        setAttribute<scene_rdl2::rdl2::Rgb>(toon, "albedo", Color(0.2f, 0.5f, 0.8f));
+        bindAttribute(toon, "albedo", noise);
+        toon->endUpdate();
+    }
+    if (layer) {
+        layer->beginUpdate();
+        setAttribute<SceneObject*>(layer, "material_A", leafA);
+        setAttribute<SceneObject*>(layer, "material_B", leafB);
+        setAttribute<scene_rdl2::rdl2::Float>(layer, "mask", 0.5f);
+        bindAttribute(layer, "mask", noise);
+        layer->endUpdate();
+    }
+    if (mix) {
+        mix->beginUpdate();
+        setMaterialInputs(mix, {leafA, leafB});
+        setAttribute<scene_rdl2::rdl2::Float>(mix, "mix", 0.5f);
+        bindAttribute(mix, "mix", noise);
+        mix->endUpdate();
+    }
+    if (swtch) {
+        swtch->beginUpdate();
+        setMaterialInputs(swtch, {leafA, leafB});
+        setAttribute<scene_rdl2::rdl2::Int>(swtch, "choice", 1);
+        swtch->endUpdate();
+    }
+    if (adjust) {
+        adjust->beginUpdate();
+        setAttribute<SceneObject*>(adjust, "input_material", layer ? layer : leafA);
+        setAttribute<scene_rdl2::rdl2::Float>(adjust, "mix", 0.5f);
+        bindAttribute(adjust, "mix", noise);
+        adjust->endUpdate();
+    }
+    if (colorCorrect) {
+        colorCorrect->beginUpdate();
+        setAttribute<SceneObject*>(colorCorrect, "input_material", leafB);
+        setAttribute<scene_rdl2::rdl2::Float>(colorCorrect, "hue_shift", 0.1f);
+        setAttribute<scene_rdl2::rdl2::Float>(colorCorrect, "saturation", 0.8f);
+        setAttribute<scene_rdl2::rdl2::Float>(colorCorrect, "gain", 1.2f);
+        colorCorrect->endUpdate();
+    }
+    if (colorCorrectBound) {
+        colorCorrectBound->beginUpdate();
+        setAttribute<SceneObject*>(colorCorrectBound, "input_material", toon ? toon : leafA);
+        setAttribute<scene_rdl2::rdl2::Float>(colorCorrectBound, "saturation", 0.8f);
+        bindAttribute(colorCorrectBound, "saturation", noise);
+        setAttribute<scene_rdl2::rdl2::Bool>(colorCorrectBound, "TMI_enabled", true);
+        setAttribute<scene_rdl2::rdl2::Rgb>(colorCorrectBound, "TMI", Color(0.1f, -0.1f, 0.0f));
+        colorCorrectBound->endUpdate();
+    }
+
+    // Update in dependency order
+    for (SceneObject* object : {noise, leafA, leafB, toon, layer, mix, swtch, adjust,
+                                colorCorrect, colorCorrectBound}) {
+        if (object) {
+            object->update();
+        }
+    }
+
+    // Class name, the name the results are reported under, object
+    const std::tuple<const char*, const char*, SceneObject*> candidates[] = {
+        {"DwaBaseMaterial", "DwaBaseMaterial", leafA},
+        {"DwaToonMaterial", "DwaToonMaterial", toon},
+        {"DwaLayerMaterial", "DwaLayerMaterial", layer},
+        {"DwaMixMaterial", "DwaMixMaterial", mix},
+        {"DwaSwitchMaterial", "DwaSwitchMaterial", swtch},
+        {"DwaAdjustMaterial", "DwaAdjustMaterial", adjust},
+        {"DwaColorCorrectMaterial", "DwaColorCorrectMaterial", colorCorrect},
+        {"DwaColorCorrectMaterial", "DwaColorCorrectMaterial/bound", colorCorrectBound},
+    };
+    for (const auto& candidate : candidates) {
+        if (std::get<2>(candidate) && isSelected(options, std::get<0>(candidate))) {
+            scene.mMaterials.emplace_back(std::get<1>(candidate),
+                                          std::get<2>(candidate)->asA<Material>());
+        }
+    }
+    return scene;
+}
+
+//----------------------------------------------------------------------------
+
+// Compare every field of every state and report the worst offenders
+bool
+checkParity(const std::string& className, const std::vector<float>& scalar,
+            const std::vector<float>& vector, unsigned numStates)
+{
+    std::vector<unsigned> mismatches(sFieldStride, 0);
+    std::vector<float> maxDiff(sFieldStride, 0.f);
+    std::vector<unsigned> firstState(sFieldStride, 0);
+
+    for (unsigned i = 0; i < numStates; ++i) {
+        const float* s = &scalar[i * sFieldStride];
+        const float* v = &vector[i * sFieldStride];
+        for (unsigned f = 0; f < sFieldStride; ++f) {
+            if (!nearlyEqual(s[f], v[f])) {
+                if (mismatches[f]++ == 0) {
+                    firstState[f] = i;
+                }
+                maxDiff[f] = std::max(maxDiff[f], std::abs(s[f] - v[f]));
+            }
+        }
+    }
+
+    bool passed = true;
+    for (unsigned f = 0; f < sFieldStride; ++f) {
+        if (mismatches[f]) {
+            passed = false;
+            const unsigned i = firstState[f];
+            std::cerr << className << ": " << sFieldNames[f] << " differs in "
+                      << mismatches[f] << "/" << numStates << " states"
+                      << " (max diff " << maxDiff[f] << ", first at state " << i
+                      << ": scalar " << scalar[i * sFieldStride + f]
+                      << " vector " << vector[i * sFieldStride + f] << ")\n";
+        }
+    }
+
+    std::cout << className << ": " << sNumFields << " fields over " << numStates
+              << " states " << (passed ? "match" : "DIFFER") << '\n';
+    return passed;
+}
+
+Result
+makeResult(const std::string& name, const char* path, unsigned laneWidth,
+           const Options& options, const StateBatch& batch, double seconds)
+{
+    Result result;
+    result.mClassName = name;
+    result.mPath = path;
+    result.mLaneWidth = laneWidth;
+    result.mSeconds = seconds;
+    result.mSamples = static_cast<uint64_t>(options.mIterations) * batch.size();
+    return result;
+}
+
+} // anonymous namespace
+
+std::vector<Result>
+runMaterialBench(const Options& options, moonray::shading::TLState* tls, bool& parityPassed)
+{
+    std::vector<Result> results;
+    parityPassed = true;
+
+    SceneContext context;
+    context.setDsoPath(options.mDsoPath);
+    const BenchScene scene = buildScene(context, options);
+
+    scene_rdl2::alloc::Arena* arena = tls->mArena;
+
+    for (const auto& entry : scene.mMaterials) {
+        const Material& material = *entry.second;
+        const dwabase::DwaBaseLayerable* layerable =
+            dynamic_cast<const dwabase::DwaBaseLayerable*>(&material);
+        if (!layerable) {
+            std::cerr << entry.first << " is not a DwaBaseLayerable, skipping\n";
+            continue;
+        }
+
+        StateBatch batch(options.mNumStates, options.mSeed);
+        batch.attachAttributes(material, tls);
+        const unsigned numStates = batch.size();
+        const bool castsCaustics = layerable->getCastsCaustics();
+
+        const intptr_t resolveFuncv = reinterpret_cast<intptr_t>(layerable->getResolveParametersISPCFunc());
+        const auto* me = reinterpret_cast<const ispc::Material*>(&material);
+        const auto* statev = reinterpret_cast<const ispc::State*>(batch.statev());
+
+        // Parity
+        {
+            std::vector<float> scalarFields(numStates * sFieldStride);
+            for (unsigned i = 0; i < numStates; ++i) {
+                ispc::DwaBaseParameters params;
+                dwabase::DwaBaseLayerable::initParameters(params);
+                dwabase::DwaBaseLayerable::initColorCorrectParameters(params);
+                const bool resolved = layerable->resolveParameters(tls, batch.state(i), castsCaustics, params);
+                extractFields(params, resolved, &scalarFields[i * sFieldStride]);
+            }
+
+            std::vector<float> vectorFields(batch.numStatev() * VLEN * sFieldStride);
+            ispc::MaterialBench_resolveParameters(me, reinterpret_cast<ispc::ShadingTLState*>(tls),
+                                                  resolveFuncv, batch.numStatev(), statev,
+                                                  castsCaustics, vectorFields.data());
+
+            parityPassed &= checkParity(entry.first, scalarFields, vectorFields, numStates);
+        }
+
+        // Scalar resolveParameters()
+        {
+            float sum = 0.f;
+            double seconds = 0.0;
+            for (unsigned pass = 0; pass < options.mWarmup + options.mIterations; ++pass) {
+                const Timer timer;
+                for (unsigned i = 0; i < numStates; ++i) {
+                    ispc::DwaBaseParameters params;
+                    dwabase::DwaBaseLayerable::initParameters(params);
+                    dwabase::DwaBaseLayerable::initColorCorrectParameters(params);
+                    layerable->resolveParameters(tls, batch.state(i), castsCaustics, params);
+                    sum += params.mRoughness;
+                }
+                if (pass >= options.mWarmup) {
+                    seconds += timer.seconds();
+                }
+            }
+            sSink = sSink + sum;
+            results.push_back(makeResult(entry.first, "scalar", 1, options, batch, seconds));
+        }
+
+        // ISPC resolveParameters()
+        {
+            double seconds = 0.0;
+            for (unsigned pass = 0; pass < options.mWarmup + options.mIterations; ++pass) {
+                const Timer timer;
+                ispc::MaterialBench_resolveParameters(me, reinterpret_cast<ispc::ShadingTLState*>(tls),
+                                                      resolveFuncv, batch.numStatev(), statev,
+                                                      castsCaustics, nullptr);
+                if (pass >= options.mWarmup) {
+                    seconds += timer.seconds();
+                }
+            }
+            results.push_back(makeResult(entry.first, "vector", VLEN, options, batch, seconds));
+        }
+
+        // Full scalar shade(), i.e. resolveParameters() plus createLobes().
+        // The vectorized shade needs a renderer-owned BsdfBuilderv so it is
+        // only timed through a render.
+        {
+            glitter::FlakeCache::resetStats();
+            double seconds = 0.0;
+            for (unsigned pass = 0; pass < options.mWarmup + options.mIterations; ++pass) {
+                const Timer timer;
+                for (unsigned i = 0; i < numStates; ++i) {
+                    SCOPED_MEM(arena);
+                    moonray::shading::Bsdf bsdf;
+                    moonray::shading::BsdfBuilder builder(bsdf, tls, batch.state(i));
+                    material.shade(tls, batch.state(i), builder);
+                }
+                if (pass >= options.mWarmup) {
+                    seconds += timer.seconds();
+                }
+            }
+            results.push_back(makeResult(entry.first, "shade", 1, options, batch, seconds));
+
+            const glitter::FlakeCache::Stats stats = glitter::FlakeCache::getStats();
+            const uint64_t lookups = stats.mHits + stats.mMisses;
+            if (lookups) {
+                std::cout << entry.first << ": glitter flake cache " << stats.mHits << " hits, "
+                          << stats.mMisses << " misses ("
+                          << 100.0 * static_cast<double>(stats.mHits) / static_cast<double>(lookups)
+                          << "% hit rate)\n";
+            }
+        }
+    }
+
+    return results;
+}
+
+} // bench
+} // moonshine
+
@@ -0,0 +1,28 @@
+// Copyright 2023-2024 DreamWorks Animation LLC
+// SPDX-License-Identifier: Apache-2.0
+
+///
+/// @file MaterialBench.h
+/// $Id$
+///
+
+#pragma once
+
+#include "BenchUtil.h"
+
+namespace moonshine {
+namespace bench {
+
+// Build DwaBaseMaterial, DwaToonMaterial, DwaLayerMaterial, DwaMixMaterial,
+// DwaSwitchMaterial, DwaAdjustMaterial and DwaColorCorrectMaterial instances
+// from the dsos in options.mDsoPath, check that the scalar and ISPC
+// resolveParameters() paths produce the same DwaBaseParameters over a batch
+// of synthetic states, and time each path.
+// parityPassed is cleared if any material's paths disagree.
+std::vector<Result> runMaterialBench(const Options& options,
+                                     moonray::shading::TLState* tls,
+                                     bool& parityPassed);
+
+} // bench
+} // moonshine
+
@@ -0,0 +1,149 @@
+// Copyright 2023-2024 DreamWorks Animation LLC
+// SPDX-License-Identifier: Apache-2.0
+
+///
+/// @file main.cc
+/// $Id$
+///
+/// Micro-benchmarks for moonshine shaders, run outside of a full render so
+/// that per-shader regressions can be caught before they reach the farm.
+///
+/// usage: moonshine_bench <mode> [options]
+///
+
+#include "BenchUtil.h"
+#include "GeometryBench.h"
+#include "MapBench.h"
+#include "MaterialBench.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+namespace {
+
+void
+usage(const char* argv0)
+{
+    std::cerr <<
+        "usage: " << argv0 << " <mode> [options]\n"
+        "\n"
+        "modes:\n"
+        "    map                  time the scalar and ISPC sample functions of every map dso\n"
+        "    material             check scalar/ISPC parity of the Dwa materials' resolved\n"
+        "                         parameters and time resolveParameters() and shade()\n"
+        "                         (reporting the glitter flake cache hit rate of shade())\n"
+        "    switch               time the scalar and ISPC switch maps over a sweep of\n"
+        "                         distinct choices per gang\n"
+        "    scatter              time and measure the memory of ScatterGeometry instances\n"
+        "                         of shared prototypes against one primitive per instance\n"
+        "\n"
+        "options:\n"
+        "    --dso-path <dir>     directory containing the rdl2 dsos (default: $RDL2_DSO_PATH),\n"
+        "                         material and scatter also take a ':' separated search path\n"
+        "    --class <name>       only run this class, may be repeated\n"
+        "    --skip <name>        never run this class, may be repeated\n"
+        "    --states <n>         shading states per batch (default: 4096)\n"
+        "    --iterations <n>     timed passes over the batch (default: 64)\n"
+        "    --warmup <n>         untimed passes over the batch (default: 4)\n"
+        "    --seed <n>           random seed for the synthetic states\n"
+        "    --instances <n>      largest scatter, from 1000 up by 10x (default: 1000000)\n"
+        "    --json <file>        write a json summary of the results\n";
+}
+
+bool
+parseArgs(int argc, char* argv[], moonshine::bench::Options& options)
+{
+    if (const char* env = std::getenv("RDL2_DSO_PATH")) {
+        // Only the first entry of a search path is used
+        const std::string path(env);
+        options.mDsoPath = path.substr(0, path.find(':'));
+    }
+
+    for (int i = 2; i < argc; ++i) {
+        const std::string arg(argv[i]);
+        if (i + 1 >= argc) {
+            std::cerr << "Missing value for " << arg << '\n';
+            return false;
+        }
+        const char* value = argv[++i];
+
+        if (arg == "--dso-path") {
+            options.mDsoPath = value;
+        } else if (arg == "--class") {
+            options.mClasses.push_back(value);
+        } else if (arg == "--skip") {
+            options.mSkip.push_back(value);
+        } else if (arg == "--states") {
+            options.mNumStates = std::strtoul(value, nullptr, 0);
+        } else if (arg == "--iterations") {
+            options.mIterations = std::strtoul(value, nullptr, 0);
+        } else if (arg == "--warmup") {
+            options.mWarmup = std::strtoul(value, nullptr, 0);
+        } else if (arg == "--seed") {
+            options.mSeed = std::strtoul(value, nullptr, 0);
+        } else if (arg == "--instances") {
+            options.mMaxInstances = std::strtoul(value, nullptr, 0);
+        } else if (arg == "--json") {
+            options.mJsonPath = value;
+        } else {
+            std::cerr << "Unknown option " << arg << '\n';
+            return false;
+        }
+    }
+
+    if (options.mDsoPath.empty()) {
+        std::cerr << "No dso path, use --dso-path or set RDL2_DSO_PATH\n";
+        return false;
+    }
+    return true;
+}
+
+} // anonymous namespace
+
+int
+main(int argc, char* argv[])
+{
+    using namespace moonshine::bench;
+
+    if (argc < 2) {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    Options options;
+    if (!parseArgs(argc, argv, options)) {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    const std::string mode(argv[1]);
+    moonray::shading::TLState* tls = initTls();
+
+    std::vector<Result> results;
+    bool passed = true;
+    if (mode == "map") {
+        results = runMapBench(options, tls);
+    } else if (mode == "material") {
+        results = runMaterialBench(options, tls, passed);
+    } else if (mode == "switch") {
+        results = runSwitchBench(options, tls);
+    } else if (mode == "scatter") {
+        results = runScatterBench(options);
+    } else {
+        std::cerr << "Unknown mode " << mode << '\n';
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    printResults(std::cout, results);
+
+    if (!options.mJsonPath.empty() && !writeJson(options.mJsonPath, mode.c_str(), options, results)) {
+        std::cerr << "Unable to write " << options.mJsonPath << '\n';
+        return EXIT_FAILURE;
+    }
+
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
@@ -4,6 +4,7 @@
 
 #include <moonray/rendering/displayfilter/DisplayFilter.h>
 #include <moonray/rendering/displayfilter/InputBuffer.h>
+#include <moonshine/displayfilter/common/FrameCache.h>
 
 #include <scene_rdl2/common/math/Math.h>
 #include <scene_rdl2/common/math/MathUtil.h>
@@ -12,6 +13,11 @@
 #include "attributes.cc"
 #include "ConvolutionDisplayFilter_ispc_stubs.h"
 
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+
+#include <cmath>
+#include <complex>
 #include <numeric>
 
 using namespace moonray;
@@ -27,11 +33,28 @@ private:
     virtual void getInputData(const displayfilter::InitializeData& initData,
                               displayfilter::InputData& inputData) const override;
 
+    void chooseExecution();
+    const float* buildFrameCache(const void* inBuffer, int width, int height);
+    void fftConvolve(const ispc::InputBuffer* inBuffer, int width, int height, float* out) const;
+
     ispc::ConvolutionDisplayFilter mIspc;
 
     std::vector<float> mKernel;
     size_t mKernelSize;
 
+    // CONVOLUTION_SEPARABLE: mKernel is the outer product of these
+    std::vector<float> mKernelX;
+    std::vector<float> mKernelY;
+
+    // CONVOLUTION_FFT: the input is convolved in mFftSize square tiles
+    size_t mFftSize;
+    std::vector<std::complex<double>> mKernelSpectrum;
+
+    // CONVOLUTION_SEPARABLE and CONVOLUTION_FFT: the cached data described
+    // in ConvolutionDisplayFilter.ispc, built once per pass by mFrameCache
+    std::vector<float> mCache;
+    moonshine::displayfilter::FrameCache mFrameCache;
+
 RDL2_DSO_CLASS_END(ConvolutionDisplayFilter)
 
 //---------------------------------------------------------------------------
@@ -42,17 +65,161 @@ enum KernelType {
     CUSTOM = 2,
 };
 
+namespace {
+
+// Smallest kernel for which building the frame cache is cheaper than
+// gathering the whole kernel for every pixel
+constexpr size_t sMinCachedKernelSize = 9;
+
+// Smallest non-separable kernel worth convolving with FFTs
+constexpr size_t sMinFftKernelSize = 31;
+
+// Try to write kernel, a size x size matrix, as the outer product of a
+// column kernelY and a row kernelX. Finds the largest singular value and
+// its singular vectors by power iteration and accepts them if they
+// reproduce the kernel to float precision.
+bool
+factorKernel(const std::vector<float>& kernel, size_t size,
+             std::vector<float>& kernelX, std::vector<float>& kernelY)
+{
+    // Start from an uneven vector so that it is unlikely to be orthogonal
+    // to the kernel's rows, e.g. for derivative kernels
+    std::vector<double> u(size, 0.0);
+    std::vector<double> v(size);
+    for (size_t i = 0; i < size; ++i) {
+        v[i] = 1.0 + 0.5 * std::sin(static_cast<double>(i + 1));
+    }
+    double sigma = 0.0;
+
+    for (int iteration = 0; iteration < 64; ++iteration) {
+        // u = K v / |K v|
+        double norm = 0.0;
+        for (size_t j = 0; j < size; ++j) {
+            u[j] = 0.0;
+            for (size_t i = 0; i < size; ++i) {
+                u[j] += kernel[j * size + i] * v[i];
+            }
+            norm += u[j] * u[j];
+        }
+        norm = std::sqrt(norm);
+        if (norm == 0.0) {
+            return false;
+        }
+        for (double& x : u) {
+            x /= norm;
+        }
+
+        // v = K^T u / |K^T u|, sigma = |K^T u|
+        norm = 0.0;
+        for (size_t i = 0; i < size; ++i) {
+            v[i] = 0.0;
+            for (size_t j = 0; j < size; ++j) {
+                v[i] += kernel[j * size + i] * u[j];
+            }
+            norm += v[i] * v[i];
+        }
+        norm = std::sqrt(norm);
+        for (double& x : v) {
+            x /= norm;
+        }
+
+        const bool converged = std::abs(norm - sigma) <= 1e-12 * norm;
+        sigma = norm;
+        if (converged) {
+            break;
+        }
+    }
+
+    double residual = 0.0;
+    double total = 0.0;
+    for (size_t j = 0; j < size; ++j) {
+        for (size_t i = 0; i < size; ++i) {
+            const double k = kernel[j * size + i];
+            const double d = k - sigma * u[j] * v[i];
+            residual += d * d;
+            total += k * k;
+        }
+    }
+    if (residual > 1e-12 * total) {
+        return false;
+    }
+
+    kernelX.resize(size);
+    kernelY.resize(size);
+    for (size_t i = 0; i < size; ++i) {
+        kernelX[i] = static_cast<float>(sigma * v[i]);
+        kernelY[i] = static_cast<float>(u[i]);
+    }
+    return true;
+}
+
+// In place radix-2 FFT of n complex values spaced stride apart
+void
+fft(std::complex<double>* data, size_t n, size_t stride, bool inverse)
+{
+    for (size_t i = 1, j = 0; i < n; ++i) {
+        size_t bit = n >> 1;
+        for (; j & bit; bit >>= 1) {
+            j ^= bit;
+        }
+        j ^= bit;
+        if (i < j) {
+            std::swap(data[i * stride], data[j * stride]);
+        }
+    }
+
+    for (size_t len = 2; len <= n; len <<= 1) {
+        const double angle = (inverse ? 2.0 : -2.0) * M_PI / static_cast<double>(len);
+        const std::complex<double> step(std::cos(angle), std::sin(angle));
+        for (size_t i = 0; i < n; i += len) {
+            std::complex<double> w(1.0, 0.0);
+            for (size_t k = 0; k < len / 2; ++k) {
+                std::complex<double>& a = data[(i + k) * stride];
+                std::complex<double>& b = data[(i + k + len / 2) * stride];
+                const std::complex<double> t = b * w;
+                b = a - t;
+                a += t;
+                w *= step;
+            }
+        }
+    }
+}
+
+// Unnormalized 2D FFT of an n x n row major array
+void
+fft2d(std::complex<double>* data, size_t n, bool inverse)
+{
+    for (size_t row = 0; row < n; ++row) {
+        fft(data + row * n, n, 1, inverse);
+    }
+    for (size_t col = 0; col < n; ++col) {
+        fft(data + col, n, n, inverse);
+    }
+}
+
+} // anonymous namespace
+
 ConvolutionDisplayFilter::ConvolutionDisplayFilter(
         const SceneClass& sceneClass, const std::string& name) :
-    Parent(sceneClass, name)
+    Parent(sceneClass, name),
+    mFrameCache([this](const void* inBuffer, int width, int height) {
+        return buildFrameCache(inBuffer, width, height);
+    })
 {
     mFilterFuncv = (DisplayFilterFuncv) ispc::ConvolutionDisplayFilter_getFilterFunc();
 
     mIspc.mKernel = nullptr;
+    mIspc.mKernelX = nullptr;
+    mIspc.mKernelY = nullptr;
     mIspc.mKernelSize = 0;
+    mIspc.mExecution = ispc::CONVOLUTION_DIRECT;
     mIspc.mMask = false;
     mIspc.mInvertMask = false;
     mIspc.mMix = 0.f;
+    mIspc.mFrameCache = reinterpret_cast<intptr_t>(&mFrameCache);
+
+    mKernelSize = 0;
+    mFftSize = 0;
 }
 
 void
@@ -123,8 +290,12 @@ ConvolutionDisplayFilter::update()
         break;
     }
 
+    chooseExecution();
+
     mIspc.mKernelSize = mKernelSize;
     mIspc.mKernel = mKernel.data();
+    mIspc.mKernelX = mKernelX.data();
+    mIspc.mKernelY = mKernelY.data();
 
     mIspc.mMask = get(attrMask) == nullptr ? false : true;
     mIspc.mInvertMask = get(attrInvertMask);
@@ -136,7 +307,9 @@ ConvolutionDisplayFilter::getInputData(const displayfilter::InitializeData& init
                                        displayfilter::InputData& inputData) const
 {
     inputData.mInputs.push_back(get(attrInput));
-    inputData.mWindowWidths.push_back(mKernelSize);
+    // The frame cache is built from the entire frame,
+    // which is what a window width of 0 requests.
+    inputData.mWindowWidths.push_back(mIspc.mExecution == ispc::CONVOLUTION_DIRECT ? mKernelSize : 0);
 
     // mask
     if (get(attrMask) != nullptr) {
@@ -145,5 +318,125 @@ ConvolutionDisplayFilter::getInputData(const displayfilter::InitializeData& init
     }
 }
 
+void
+ConvolutionDisplayFilter::chooseExecution()
+{
+    mKernelX.clear();
+    mKernelY.clear();
+    mKernelSpectrum.clear();
+    mFftSize = 0;
+    mIspc.mExecution = ispc::CONVOLUTION_DIRECT;
+
+    if (mKernelSize >= sMinCachedKernelSize && mKernel.size() == mKernelSize * mKernelSize) {
+        if (factorKernel(mKernel, mKernelSize, mKernelX, mKernelY)) {
+            mIspc.mExecution = ispc::CONVOLUTION_SEPARABLE;
+        } else if (mKernelSize >= sMinFftKernelSize) {
+            mIspc.mExecution = ispc::CONVOLUTION_FFT;
+
+            // Tiles overlap by the kernel width, so make them several
+            // kernel widths across to keep that overhead small
+            mFftSize = 64;
+            while (mFftSize < 4 * mKernelSize) {
+                mFftSize *= 2;
+            }
+
+            // The convolution wraps around the tile, so the kernel is
+            // stored flipped about the origin, and the inverse
+            // transform's 1/n^2 scale is folded into it.
+            const size_t n = mFftSize;
+            const int kRad = static_cast<int>(mKernelSize / 2);
+            const double scale = 1.0 / static_cast<double>(n * n);
+            mKernelSpectrum.assign(n * n, 0.0);
+            for (int j = 0; j < static_cast<int>(mKernelSize); ++j) {
+                for (int i = 0; i < static_cast<int>(mKernelSize); ++i) {
+                    const size_t y = (n - (j - kRad)) % n;
+                    const size_t x = (n - (i - kRad)) % n;
+                    mKernelSpectrum[y * n + x] = mKernel[j * mKernelSize + i] * scale;
+                }
+            }
+            fft2d(mKernelSpectrum.data(), n, false);
+        }
+    }
+
+    // Rebuild the frame cache for the new kernel, and free it if unused
+    mFrameCache.invalidate();
+    if (mIspc.mExecution == ispc::CONVOLUTION_DIRECT) {
+        std::vector<float>().swap(mCache);
+    }
+}
+
+void
+ConvolutionDisplayFilter::fftConvolve(const ispc::InputBuffer* inBuffer, int width, int height,
+                                      float* out) const
+{
+    const size_t n = mFftSize;
+    const int kRad = static_cast<int>(mKernelSize / 2);
+    // Output pixels per tile edge that don't see the tile wrap around
+    const int step = static_cast<int>(n) - 2 * kRad;
+    const int tilesX = (width + step - 1) / step;
+    const int tilesY = (height + step - 1) / step;
+
+    tbb::parallel_for(tbb::blocked_range<int>(0, tilesX * tilesY), [&](const tbb::blocked_range<int>& range) {
+        std::vector<float> rgb(n * n * 3);
+        std::vector<std::complex<double>> rg(n * n);
+        std::vector<std::complex<double>> b(n * n);
+
+        for (int tile = range.begin(); tile != range.end(); ++tile) {
+            const int x0 = (tile % tilesX) * step;
+            const int y0 = (tile / tilesX) * step;
+            ispc::ConvolutionDisplayFilter_fetchPixels(inBuffer, x0 - kRad, y0 - kRad, n, n, rgb.data());
+
+            // The kernel is real, so two channels can share one transform
+            for (size_t i = 0; i < n * n; ++i) {
+                rg[i] = std::complex<double>(rgb[i * 3 + 0], rgb[i * 3 + 1]);
+                b[i] = std::complex<double>(rgb[i * 3 + 2], 0.0);
+            }
+            fft2d(rg.data(), n, false);
+            fft2d(b.data(), n, false);
+            for (size_t i = 0; i < n * n; ++i) {
+                rg[i] *= mKernelSpectrum[i];
+                b[i] *= mKernelSpectrum[i];
+            }
+            fft2d(rg.data(), n, true);
+            fft2d(b.data(), n, true);
+
+            for (int j = 0; j < step && y0 + j < height; ++j) {
+                for (int i = 0; i < step && x0 + i < width; ++i) {
+                    const size_t src = (j + kRad) * n + (i + kRad);
+                    float* dst = out + ((y0 + j) * width + (x0 + i)) * 3;
+                    dst[0] = static_cast<float>(rg[src].real());
+                    dst[1] = static_cast<float>(rg[src].imag());
+                    dst[2] = static_cast<float>(b[src].real());
+                }
+            }
+        }
+    });
+}
+
+const float*
+ConvolutionDisplayFilter::buildFrameCache(const void* inBuffer, int width, int height)
+{
+    const ispc::InputBuffer* input = static_cast<const ispc::InputBuffer*>(inBuffer);
+    const int kRad = static_cast<int>(mKernelSize / 2);
+
+    if (mIspc.mExecution == ispc::CONVOLUTION_SEPARABLE) {
+        mCache.resize(static_cast<size_t>(width) * (height + 2 * kRad) * 3);
+    } else {
+        mCache.resize(static_cast<size_t>(width) * height * 3);
+    }
+
+    float* data = mCache.data();
+    if (mIspc.mExecution == ispc::CONVOLUTION_SEPARABLE) {
+        tbb::parallel_for(tbb::blocked_range<int>(-kRad, height + kRad), [&](const tbb::blocked_range<int>& range) {
+            ispc::ConvolutionDisplayFilter_horizontalPass(input, mKernelX.data(), mKernelSize, width,
+                                                         range.begin(), range.end(), data);
+        });
+    } else {
+        fftConvolve(input, width, height, data);
+    }
+
+    return mCache.data();
+}
+
 //---------------------------------------------------------------------------
 
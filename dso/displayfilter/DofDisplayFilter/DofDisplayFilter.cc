@@ -3,6 +3,7 @@
 
 
 #include <moonray/rendering/displayfilter/DisplayFilter.h>
+#include <moonshine/displayfilter/common/FrameCache.h>
 
 #include <scene_rdl2/common/math/MathUtil.h>
 #include <scene_rdl2/scene/rdl2/rdl2.h>
@@ -10,6 +11,8 @@
 #include "attributes.cc"
 #include "DofDisplayFilter_ispc_stubs.h"
 
+#include <vector>
+
 using namespace moonray;
 using namespace scene_rdl2::math;
 
@@ -24,15 +27,24 @@ private:
     virtual void getInputData(const moonray::displayfilter::InitializeData& initData,
                               moonray::displayfilter::InputData& inputData) const override;
 
+    const double* buildSummedAreaTable(const void* inBuffer, int width, int height);
+
     ispc::DofDisplayFilter mIspc;
 
+    // The summed area table, built once per pass by mFrameCache
+    std::vector<double> mSat;
+    moonshine::displayfilter::FrameCache mFrameCache;
+
 RDL2_DSO_CLASS_END(DofDisplayFilter)
 
 //---------------------------------------------------------------------------
 
 DofDisplayFilter::DofDisplayFilter(
         const SceneClass& sceneClass, const std::string& name) :
-    Parent(sceneClass, name)
+    Parent(sceneClass, name),
+    mFrameCache([this](const void* inBuffer, int width, int height) {
+        return buildSummedAreaTable(inBuffer, width, height);
+    })
 {
     mFilterFuncv = (DisplayFilterFuncv) ispc::DofDisplayFilter_getFilterFunc();
 
@@ -42,6 +54,8 @@ DofDisplayFilter::DofDisplayFilter(
     mIspc.mMask = false;
     mIspc.mInvertMask = false;
     mIspc.mMix = 0.f;
+    mIspc.mUseSummedAreaTable = false;
+    mIspc.mFrameCache = reinterpret_cast<intptr_t>(&mFrameCache);
 }
 
 void
@@ -84,6 +98,14 @@ DofDisplayFilter::update()
     mIspc.mMask = get(attrMask) == nullptr ? false : true;
     mIspc.mInvertMask = get(attrInvertMask);
     mIspc.mMix = saturate(get(attrMix));
+    mIspc.mUseSummedAreaTable = get(attrUseSummedAreaTable);
+
+    // Release the table when it is no longer used, the next
+    // filter invocation will rebuild it if needed.
+    mFrameCache.invalidate();
+    if (!mIspc.mUseSummedAreaTable) {
+        std::vector<double>().swap(mSat);
+    }
 }
 
 void
@@ -104,3 +126,12 @@ DofDisplayFilter::getInputData(const moonray::displayfilter::InitializeData& ini
     }
 }
 
+const double*
+DofDisplayFilter::buildSummedAreaTable(const void* inBuffer, int width, int height)
+{
+    mSat.resize(static_cast<size_t>(width + 1) * (height + 1) * ispc::DOF_SAT_CHANNELS);
+    ispc::DofDisplayFilter_buildSummedAreaTable(static_cast<const ispc::InputBuffer*>(inBuffer),
+                                                width, height, mSat.data());
+    return mSat.data();
+}
+
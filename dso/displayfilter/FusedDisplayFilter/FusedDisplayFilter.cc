@@ -0,0 +1,349 @@
+// Copyright 2023-2024 DreamWorks Animation LLC
+// SPDX-License-Identifier: Apache-2.0
+
+
+#include <moonray/rendering/displayfilter/DisplayFilter.h>
+#include <scene_rdl2/common/math/Color.h>
+#include <scene_rdl2/common/math/Math.h>
+#include <scene_rdl2/common/math/MathUtil.h>
+#include <scene_rdl2/scene/rdl2/rdl2.h>
+
+#include "attributes.cc"
+#include "FusedDisplayFilter_ispc_stubs.h"
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace moonray;
+using namespace scene_rdl2::math;
+
+namespace {
+
+// Same as OpDisplayFilter
+bool isSingleOp(int op) {
+    return op == ispc::DISPLAYFILTER_OP_INVERT       ||
+           op == ispc::DISPLAYFILTER_OP_NORMALIZE    ||
+           op == ispc::DISPLAYFILTER_OP_ABS          ||
+           op == ispc::DISPLAYFILTER_OP_CEIL         ||
+           op == ispc::DISPLAYFILTER_OP_FLOOR        ||
+           op == ispc::DISPLAYFILTER_OP_LENGTH       ||
+           op == ispc::DISPLAYFILTER_OP_SINE         ||
+           op == ispc::DISPLAYFILTER_OP_COSINE       ||
+           op == ispc::DISPLAYFILTER_OP_ROUND        ||
+           op == ispc::DISPLAYFILTER_OP_ACOS         ||
+           op == ispc::DISPLAYFILTER_OP_NOT;
+}
+
+// A log2 shaper can not reach zero, darker inputs use the first node
+constexpr float sLogShaperFloor = 1.f / 4096.f;
+constexpr int sMaxLutSize = 129;
+
+} // anonymous namespace
+
+RDL2_DSO_CLASS_BEGIN(FusedDisplayFilter, DisplayFilter)
+
+public:
+    FusedDisplayFilter(const SceneClass& sceneClass, const std::string& name);
+
+    virtual void update() override;
+
+private:
+    virtual void getInputData(const displayfilter::InitializeData& initData,
+                              displayfilter::InputData& inputData) const override;
+
+    // Fill in stage from obj and return the input the chain continues
+    // with, or return nullptr if obj can not be fused
+    const scene_rdl2::rdl2::SceneObject*
+    fuseStage(const scene_rdl2::rdl2::SceneObject* obj, ispc::FusedStage& stage);
+
+    int addInput(const scene_rdl2::rdl2::SceneObject* input);
+
+    // Sample the fused stages into mLut, if they are a function of the
+    // input color alone, and report the error of the LUT
+    bool bakeLut();
+
+    // The input value of LUT coordinate s in [0, 1]
+    float unshape(float s) const;
+
+    // The output of the filter at the head of the chain, followed by the
+    // masks and operands of the fused filters
+    std::vector<const scene_rdl2::rdl2::SceneObject*> mInputs;
+
+    std::vector<float> mLut;
+
+    ispc::FusedDisplayFilter mIspc;
+
+RDL2_DSO_CLASS_END(FusedDisplayFilter)
+
+//---------------------------------------------------------------------------
+
+FusedDisplayFilter::FusedDisplayFilter(
+        const SceneClass& sceneClass, const std::string& name) :
+    Parent(sceneClass, name)
+{
+    mFilterFuncv = (DisplayFilterFuncv) ispc::FusedDisplayFilter_getFilterFunc();
+
+    mIspc.mNumStages = 0;
+    mIspc.mLut = nullptr;
+    mIspc.mLutSize = 0;
+    mIspc.mLutShaper = ispc::FUSED_LUT_SHAPER_LINEAR;
+    mIspc.mShaperMin = 0.f;
+    mIspc.mShaperMax = 1.f;
+}
+
+int
+FusedDisplayFilter::addInput(const scene_rdl2::rdl2::SceneObject* input)
+{
+    if (input == nullptr) {
+        return -1;
+    }
+    mInputs.push_back(input);
+    return static_cast<int>(mInputs.size()) - 1;
+}
+
+const scene_rdl2::rdl2::SceneObject*
+FusedDisplayFilter::fuseStage(const scene_rdl2::rdl2::SceneObject* obj, ispc::FusedStage& stage)
+{
+    using scene_rdl2::rdl2::Bool;
+    using scene_rdl2::rdl2::Float;
+    using scene_rdl2::rdl2::Int;
+    using scene_rdl2::rdl2::Rgb;
+    using scene_rdl2::rdl2::SceneObject;
+
+    const std::string& className = obj->getSceneClass().getName();
+
+    stage = ispc::FusedStage();
+    stage.mMaskInput = -1;
+    stage.mOperandInput = -1;
+    stage.mMix = 1.f;
+
+    const SceneObject* input = nullptr;
+    if (className == "ColorCorrectDisplayFilter") {
+        stage.mType = ispc::FUSED_COLOR_CORRECT;
+        stage.mExposure = obj->get<Float>("exposure");
+        stage.mSaturation = obj->get<Float>("saturation");
+        stage.mContrast = obj->get<Float>("contrast");
+        stage.mGamma = obj->get<Float>("gamma");
+        asCpp(stage.mOffset) = obj->get<Rgb>("offset");
+        asCpp(stage.mMultiply) = obj->get<Rgb>("multiply");
+        input = obj->get<SceneObject*>("input");
+    } else if (className == "RemapDisplayFilter") {
+        stage.mType = ispc::FUSED_REMAP;
+        if (obj->get<Int>("remap_method") == 0) {
+            // uniform, which is the per channel remap with equal channels
+            asCpp(stage.mInMin) = Color(obj->get<Float>("input_min"));
+            asCpp(stage.mInMax) = Color(obj->get<Float>("input_max"));
+            asCpp(stage.mOutMin) = Color(obj->get<Float>("output_min"));
+            asCpp(stage.mOutMax) = Color(obj->get<Float>("output_max"));
+            asCpp(stage.mBiasAmount) = Color(obj->get<Float>("midpoint_bias"));
+            stage.mClamp = obj->get<Bool>("clamp");
+            asCpp(stage.mClampMin) = Color(obj->get<Float>("clamp_min"));
+            asCpp(stage.mClampMax) = Color(obj->get<Float>("clamp_max"));
+        } else {
+            asCpp(stage.mInMin) = obj->get<Rgb>("input_min_RGB");
+            asCpp(stage.mInMax) = obj->get<Rgb>("input_max_RGB");
+            asCpp(stage.mOutMin) = obj->get<Rgb>("output_min_RGB");
+            asCpp(stage.mOutMax) = obj->get<Rgb>("output_max_RGB");
+            asCpp(stage.mBiasAmount) = obj->get<Rgb>("midpoint_bias_RGB");
+            stage.mClamp = obj->get<Bool>("clamp_RGB");
+            asCpp(stage.mClampMin) = obj->get<Rgb>("clamp_min_RGB");
+            asCpp(stage.mClampMax) = obj->get<Rgb>("clamp_max_RGB");
+        }
+        input = obj->get<SceneObject*>("input");
+    } else if (className == "ClampDisplayFilter") {
+        stage.mType = ispc::FUSED_CLAMP;
+        asCpp(stage.mClampMin) = obj->get<Rgb>("min");
+        asCpp(stage.mClampMax) = obj->get<Rgb>("max");
+        input = obj->get<SceneObject*>("input");
+    } else if (className == "DiscretizeDisplayFilter") {
+        stage.mType = ispc::FUSED_DISCRETIZE;
+        stage.mNumBins = max(1, obj->get<Int>("num_bins"));
+        input = obj->get<SceneObject*>("input");
+    } else if (className == "OpDisplayFilter") {
+        stage.mType = ispc::FUSED_OP;
+        stage.mMode = obj->get<Int>("operation");
+        // OpDisplayFilter fails to update without the second input of a
+        // binary operation, leave it to report that
+        const SceneObject* operand = obj->get<SceneObject*>("input2");
+        if (operand == nullptr && !isSingleOp(stage.mMode)) {
+            return nullptr;
+        }
+        input = obj->get<SceneObject*>("input1");
+        if (input != nullptr) {
+            stage.mOperandInput = addInput(operand);
+        }
+    } else if (className == "RgbToFloatDisplayFilter") {
+        stage.mType = ispc::FUSED_RGB_TO_FLOAT;
+        stage.mMode = obj->get<Int>("mode");
+        input = obj->get<SceneObject*>("input");
+    } else if (className == "RgbToHsvDisplayFilter") {
+        stage.mType = ispc::FUSED_RGB_TO_HSV;
+        stage.mMode = obj->get<Int>("mode");
+        // no mix or mask
+        return obj->get<SceneObject*>("input");
+    } else {
+        return nullptr;
+    }
+
+    if (input == nullptr) {
+        // The filter fails to update, leave it to report that
+        return nullptr;
+    }
+
+    stage.mMaskInput = addInput(obj->get<SceneObject*>("mask"));
+    stage.mInvertMask = obj->get<Bool>("invert_mask");
+    stage.mMix = saturate(obj->get<Float>("mix"));
+    return input;
+}
+
+void
+FusedDisplayFilter::update()
+{
+    const scene_rdl2::rdl2::SceneObject* input = get(attrInput);
+    if (input == nullptr) {
+        fatal("Missing \"input\" attribute");
+        return;
+    }
+
+    // Input 0 is the head of the chain, found once the chain is walked
+    mInputs.assign(1, nullptr);
+
+    // Walk back from the last filter of the chain. A filter that can not be
+    // fused, or that is past the stage limit, is evaluated on its own and
+    // becomes the head of the chain.
+    ispc::FusedStage* stages = mIspc.mStages;
+    int numStages = 0;
+    while (numStages < ispc::FUSED_MAX_STAGES) {
+        const scene_rdl2::rdl2::SceneObject* next = fuseStage(input, stages[numStages]);
+        if (next == nullptr) {
+            break;
+        }
+        ++numStages;
+        input = next;
+    }
+    mInputs[0] = input;
+
+    // The filters were found last to first
+    std::reverse(stages, stages + numStages);
+    mIspc.mNumStages = numStages;
+
+    mLut.clear();
+    mIspc.mLut = nullptr;
+    if (get(attrBakeLut) && !bakeLut()) {
+        warn("Unable to bake a LUT, evaluating the filters exactly");
+    }
+}
+
+float
+FusedDisplayFilter::unshape(float s) const
+{
+    const float x = lerp(mIspc.mShaperMin, mIspc.mShaperMax, s);
+    return mIspc.mLutShaper == ispc::FUSED_LUT_SHAPER_LOG2 ? std::exp2(x) : x;
+}
+
+bool
+FusedDisplayFilter::bakeLut()
+{
+    if (mIspc.mNumStages == 0) {
+        return false;
+    }
+    for (int i = 0; i < mIspc.mNumStages; ++i) {
+        // masks and operands are other images
+        if (mIspc.mStages[i].mMaskInput >= 0 || mIspc.mStages[i].mOperandInput >= 0) {
+            return false;
+        }
+    }
+
+    const float inMin = get(attrLutInputMin);
+    const float inMax = get(attrLutInputMax);
+    mIspc.mLutShaper = get(attrLutShaper);
+    if (mIspc.mLutShaper == ispc::FUSED_LUT_SHAPER_LOG2) {
+        mIspc.mShaperMin = std::log2(max(inMin, sLogShaperFloor));
+        mIspc.mShaperMax = std::log2(max(inMax, sLogShaperFloor));
+    } else {
+        mIspc.mShaperMin = inMin;
+        mIspc.mShaperMax = inMax;
+    }
+    if (!(mIspc.mShaperMax > mIspc.mShaperMin)) {
+        return false;
+    }
+
+    // Node (r, g, b) is at ((b * size + g) * size + r) * 3
+    const int size = clamp(get(attrLutSize), 2, sMaxLutSize);
+    const int numNodes = size * size * size;
+    std::vector<float> nodes(numNodes * 3);
+    std::vector<float> axis(size);
+    for (int i = 0; i < size; ++i) {
+        axis[i] = unshape(static_cast<float>(i) / (size - 1));
+    }
+    float* node = nodes.data();
+    for (int b = 0; b < size; ++b) {
+        for (int g = 0; g < size; ++g) {
+            for (int r = 0; r < size; ++r) {
+                *node++ = axis[r];
+                *node++ = axis[g];
+                *node++ = axis[b];
+            }
+        }
+    }
+
+    mLut.resize(numNodes * 3);
+    ispc::FusedDisplayFilter_evaluateStages(&mIspc, numNodes, nodes.data(), mLut.data());
+    mIspc.mLut = mLut.data();
+    mIspc.mLutSize = size;
+
+    // Compare the LUT to the exact filters at the center of every cell,
+    // where the interpolation is least accurate. One slab of cells along
+    // b is checked at a time.
+    const int numCells = size - 1;
+    const int numChecks = numCells * numCells;
+    std::vector<float> checks(numChecks * 3);
+    std::vector<float> exact(numChecks * 3);
+    std::vector<float> approx(numChecks * 3);
+    float maxError = 0.f;
+    double sumError = 0.0;
+    for (int b = 0; b < numCells; ++b) {
+        const float cb = unshape((b + 0.5f) / numCells);
+        float* check = checks.data();
+        for (int g = 0; g < numCells; ++g) {
+            const float cg = unshape((g + 0.5f) / numCells);
+            for (int r = 0; r < numCells; ++r) {
+                *check++ = unshape((r + 0.5f) / numCells);
+                *check++ = cg;
+                *check++ = cb;
+            }
+        }
+        ispc::FusedDisplayFilter_evaluateStages(&mIspc, numChecks, checks.data(), exact.data());
+        ispc::FusedDisplayFilter_lookupLut(&mIspc, numChecks, checks.data(), approx.data());
+
+        for (int i = 0; i < numChecks * 3; ++i) {
+            const float error = abs(approx[i] - exact[i]);
+            // nans from the exact filters count as the largest error
+            maxError = error <= maxError ? maxError : error;
+            sumError += error;
+        }
+    }
+    std::ostringstream report;
+    report << "Baked " << mIspc.mNumStages << " filters into a " << size << "^3 LUT, "
+           << "error against the exact filters: max " << maxError
+           << ", mean " << sumError / (static_cast<double>(numChecks) * numCells * 3);
+    info(report.str());
+    return true;
+}
+
+void
+FusedDisplayFilter::getInputData(const displayfilter::InitializeData& initData,
+                                 displayfilter::InputData& inputData) const
+{
+    // Every fused filter reads a single pixel of each of its inputs
+    for (const scene_rdl2::rdl2::SceneObject* input : mInputs) {
+        inputData.mInputs.push_back(input);
+        inputData.mWindowWidths.push_back(1);
+    }
+}
+
+//---------------------------------------------------------------------------
+
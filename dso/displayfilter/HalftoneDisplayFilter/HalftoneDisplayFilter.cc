@@ -3,6 +3,7 @@
 
 
 #include <moonray/rendering/displayfilter/DisplayFilter.h>
+#include <moonshine/displayfilter/common/FrameCache.h>
 
 #include <scene_rdl2/common/math/Math.h>
 #include <scene_rdl2/common/math/MathUtil.h>
@@ -11,6 +12,8 @@
 #include "attributes.cc"
 #include "HalftoneDisplayFilter_ispc_stubs.h"
 
+#include <vector>
+
 using namespace moonray;
 using namespace scene_rdl2::math;
 
@@ -25,15 +28,24 @@ private:
     virtual void getInputData(const displayfilter::InitializeData& initData,
                               displayfilter::InputData& inputData) const override;
 
+    const double* buildSummedAreaTable(const void* inBuffer, int width, int height);
+
     ispc::HalftoneDisplayFilter mIspc;
 
+    // The summed area table, built once per pass by mFrameCache
+    std::vector<double> mSat;
+    moonshine::displayfilter::FrameCache mFrameCache;
+
 RDL2_DSO_CLASS_END(HalftoneDisplayFilter)
 
 //---------------------------------------------------------------------------
 
 HalftoneDisplayFilter::HalftoneDisplayFilter(
         const SceneClass& sceneClass, const std::string& name) :
-    Parent(sceneClass, name)
+    Parent(sceneClass, name),
+    mFrameCache([this](const void* inBuffer, int width, int height) {
+        return buildSummedAreaTable(inBuffer, width, height);
+    })
 {
     mFilterFuncv = (DisplayFilterFuncv) ispc::HalftoneDisplayFilter_getFilterFunc();
 
@@ -44,6 +56,8 @@ HalftoneDisplayFilter::HalftoneDisplayFilter(
     mIspc.mMask = false;
     mIspc.mInvertMask = false;
     mIspc.mMix = 0.f;
+    mIspc.mUseSummedAreaTable = false;
+    mIspc.mFrameCache = reinterpret_cast<intptr_t>(&mFrameCache);
 }
 
 void
@@ -61,6 +75,14 @@ HalftoneDisplayFilter::update()
     mIspc.mMask = get(attrMask) == nullptr ? false : true;
     mIspc.mInvertMask = get(attrInvertMask);
     mIspc.mMix = saturate(get(attrMix));
+    mIspc.mUseSummedAreaTable = get(attrUseSummedAreaTable);
+
+    // Release the table when it is no longer used, the next
+    // filter invocation will rebuild it if needed.
+    mFrameCache.invalidate();
+    if (!mIspc.mUseSummedAreaTable) {
+        std::vector<double>().swap(mSat);
+    }
 }
 
 void
@@ -68,7 +90,9 @@ HalftoneDisplayFilter::getInputData(const displayfilter::InitializeData& initDat
                                     displayfilter::InputData& inputData) const
 {
     inputData.mInputs.push_back(get(attrInput));
-    inputData.mWindowWidths.push_back(2 * get(attrSize) + 1);
+    // The summed area table is built from the entire frame,
+    // which is what a window width of 0 requests.
+    inputData.mWindowWidths.push_back(mIspc.mUseSummedAreaTable ? 0 : 2 * get(attrSize) + 1);
 
     // mask
     if (get(attrMask) != nullptr) {
@@ -77,5 +101,14 @@ HalftoneDisplayFilter::getInputData(const displayfilter::InitializeData& initDat
     }
 }
 
+const double*
+HalftoneDisplayFilter::buildSummedAreaTable(const void* inBuffer, int width, int height)
+{
+    mSat.resize(static_cast<size_t>(width + 1) * (height + 1) * ispc::HALFTONE_SAT_CHANNELS);
+    ispc::HalftoneDisplayFilter_buildSummedAreaTable(static_cast<const ispc::InputBuffer*>(inBuffer),
+                                                     width, height, mSat.data());
+    return mSat.data();
+}
+
 //---------------------------------------------------------------------------
 
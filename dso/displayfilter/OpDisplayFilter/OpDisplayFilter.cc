@@ -35,17 +35,17 @@ RDL2_DSO_CLASS_END(OpDisplayFilter)
 // If you are adding an operation that takes only one 
 // input, add it here for validation purposes
 bool isSingleOp(int op) {
-    return op == ispc::INVERT       ||
-           op == ispc::NORMALIZE    ||
-           op == ispc::ABS          ||
-           op == ispc::CEIL         ||
-           op == ispc::FLOOR        ||
-           op == ispc::LENGTH       ||
-           op == ispc::SINE         ||
-           op == ispc::COSINE       ||
-           op == ispc::ROUND        ||
-           op == ispc::ACOS         ||
-           op == ispc::NOT;
+    return op == ispc::DISPLAYFILTER_OP_INVERT       ||
+           op == ispc::DISPLAYFILTER_OP_NORMALIZE    ||
+           op == ispc::DISPLAYFILTER_OP_ABS          ||
+           op == ispc::DISPLAYFILTER_OP_CEIL         ||
+           op == ispc::DISPLAYFILTER_OP_FLOOR        ||
+           op == ispc::DISPLAYFILTER_OP_LENGTH       ||
+           op == ispc::DISPLAYFILTER_OP_SINE         ||
+           op == ispc::DISPLAYFILTER_OP_COSINE       ||
+           op == ispc::DISPLAYFILTER_OP_ROUND        ||
+           op == ispc::DISPLAYFILTER_OP_ACOS         ||
+           op == ispc::DISPLAYFILTER_OP_NOT;
 }
 
 OpDisplayFilter::OpDisplayFilter(
@@ -54,7 +54,7 @@ OpDisplayFilter::OpDisplayFilter(
 {
     mFilterFuncv = (DisplayFilterFuncv) ispc::OpDisplayFilter_getFilterFunc();
 
-    mIspc.mOperation = static_cast<ispc::OpType>(0);
+    mIspc.mOperation = static_cast<ispc::DisplayFilterOpType>(0);
     mIspc.mMask = false;
     mIspc.mInvertMask = false;
     mIspc.mMix = 0.f;
@@ -75,7 +75,7 @@ OpDisplayFilter::update()
         return;
     }
 
-    mIspc.mOperation = static_cast<ispc::OpType>(get(attrOperation));
+    mIspc.mOperation = static_cast<ispc::DisplayFilterOpType>(get(attrOperation));
     mIspc.mMask = get(attrMask) == nullptr ? false : true;
     mIspc.mInvertMask = get(attrInvertMask);
     mIspc.mMix = saturate(get(attrMix));
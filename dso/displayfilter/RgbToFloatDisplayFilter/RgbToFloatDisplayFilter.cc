@@ -38,7 +38,7 @@ RgbToFloatDisplayFilter::RgbToFloatDisplayFilter(
 {
     mFilterFuncv = (DisplayFilterFuncv) ispc::RgbToFloatDisplayFilter_getFilterFunc();
 
-    mIspc.mMode = static_cast<ispc::RgbToFloatMode>(0);
+    mIspc.mMode = static_cast<ispc::DisplayFilterRgbToFloatMode>(0);
     mIspc.mMask = false;
     mIspc.mInvertMask = false;
     mIspc.mMix = 0.f;
@@ -52,7 +52,7 @@ RgbToFloatDisplayFilter::update()
         return;
     }
 
-    mIspc.mMode = static_cast<ispc::RgbToFloatMode>(get(attrMode));
+    mIspc.mMode = static_cast<ispc::DisplayFilterRgbToFloatMode>(get(attrMode));
     mIspc.mMask = get(attrMask) == nullptr ? false : true;
     mIspc.mInvertMask = get(attrInvertMask);
     mIspc.mMix = saturate(get(attrMix));
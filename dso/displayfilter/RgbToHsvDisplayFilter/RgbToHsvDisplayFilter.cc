@@ -33,7 +33,7 @@ RgbToHsvDisplayFilter::RgbToHsvDisplayFilter(
 {
     mFilterFuncv = (DisplayFilterFuncv) ispc::RgbToHsvDisplayFilter_getFilterFunc();
 
-    mIspc.mMode = static_cast<ispc::RgbToHsvMode>(0);
+    mIspc.mMode = static_cast<ispc::DisplayFilterRgbToHsvMode>(0);
 }
 
 void
@@ -43,7 +43,7 @@ RgbToHsvDisplayFilter::update()
         fatal("Missing \"input\" attribute.");
         return;
     }
-    mIspc.mMode = static_cast<ispc::RgbToHsvMode>(get(attrMode));
+    mIspc.mMode = static_cast<ispc::DisplayFilterRgbToHsvMode>(get(attrMode));
 }
 
 void
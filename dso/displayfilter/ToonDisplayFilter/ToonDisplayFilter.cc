@@ -11,7 +11,10 @@
 #include "attributes.cc"
 #include "ToonDisplayFilter_ispc_stubs.h"
 
+#include <tbb/task_arena.h>
+
 #include <cmath>
+#include <vector>
 
 using namespace moonray;
 using namespace scene_rdl2::math;
@@ -29,10 +32,19 @@ private:
 
     ispc::ToonDisplayFilter mIspc;
 
+    // Scratch space for the fused edge detection, indexed by thread
+    std::vector<ispc::ToonNeighborhood> mNeighborhoods;
+
 RDL2_DSO_CLASS_END(ToonDisplayFilter)
 
 //---------------------------------------------------------------------------
 
+extern "C" int
+ToonDisplayFilter_getThreadIndex()
+{
+    return tbb::this_task_arena::current_thread_index();
+}
+
 ToonDisplayFilter::ToonDisplayFilter(
         const SceneClass& sceneClass, const std::string& name) :
     Parent(sceneClass, name)
@@ -47,6 +59,8 @@ ToonDisplayFilter::ToonDisplayFilter(
     mIspc.mInkNormalThreshold = 0.f;
     mIspc.mInkNormalScale = 0.f;
     mIspc.mEdgeDetector = 0;
+    mIspc.mNeighborhoods = nullptr;
+    mIspc.mNumNeighborhoods = 0;
 }
 
 void
@@ -85,6 +99,17 @@ ToonDisplayFilter::update()
     mIspc.mInkNormalThreshold = get(attrInkNormalThreshold);
     mIspc.mInkNormalScale = get(attrInkNormalScale);
     mIspc.mEdgeDetector = get(attrEdgeDetector);
+
+    // Each neighborhood is too large for the ISPC stack, so every thread
+    // that may run the filter gets one here. Threads outside the arena
+    // fall back to the unfused path.
+    if (mIspc.mEdgeDetector != 0) {
+        mNeighborhoods.resize(tbb::this_task_arena::max_concurrency());
+    } else {
+        std::vector<ispc::ToonNeighborhood>().swap(mNeighborhoods);
+    }
+    mIspc.mNeighborhoods = mNeighborhoods.data();
+    mIspc.mNumNeighborhoods = static_cast<int>(mNeighborhoods.size());
 }
 
 void
@@ -0,0 +1,100 @@
+// Copyright 2023-2024 DreamWorks Animation LLC
+// SPDX-License-Identifier: Apache-2.0
+
+///
+/// @file ScatterGeometry.cc
+/// $Id$
+///
+
+#include "attributes.cc"
+#include <moonshine/geometry/data/ScatterInstances.h>
+#include <moonray/rendering/geom/Api.h>
+#include <moonray/rendering/geom/ProceduralLeaf.h>
+#include <moonray/rendering/geom/Types.h>
+#include <moonray/rendering/shading/Shading.h>
+#include <scene_rdl2/scene/rdl2/rdl2.h>
+
+using namespace moonray;
+using namespace moonray::geom;
+using namespace moonray::shading;
+using namespace scene_rdl2::rdl2;
+
+RDL2_DSO_CLASS_BEGIN(ScatterGeometry, Geometry)
+
+public:
+    RDL2_DSO_DEFAULT_CTOR(ScatterGeometry)
+    moonray::geom::Procedural* createProcedural() const;
+    void destroyProcedural() const;
+
+RDL2_DSO_CLASS_END(ScatterGeometry)
+
+//------------------------------------------------------------------------------
+
+namespace moonshine {
+
+class ScatterProcedural : public ProceduralLeaf
+{
+public:
+    // constructor can be freely extended but should always pass in State to
+    // construct base Procedural class
+    explicit ScatterProcedural(const moonray::geom::State& state) : ProceduralLeaf(state) {}
+
+    void generate(const GenerateContext& generateContext,
+            const XformSamples& parent2render)
+    {
+        const Geometry* rdlGeometry = generateContext.getRdlGeometry();
+        const ScatterGeometry* pScatterGeom =
+            static_cast<const ScatterGeometry*>(rdlGeometry);
+
+        // The prototypes are generated as references before any geometry
+        // that refers to them, all their instances share their primitives
+        const SceneObjectVector& references = pScatterGeom->get(attrReferences);
+        std::vector<std::shared_ptr<SharedPrimitive>> prototypes(references.size());
+        for (size_t i = 0; i < references.size(); ++i) {
+            const Geometry* reference = references[i] ?
+                references[i]->asA<Geometry>() : nullptr;
+            if (!reference || !reference->getProcedural()) {
+                continue;
+            }
+            prototypes[i] = reference->getProcedural()->getReference();
+            if (!prototypes[i]) {
+                rdlGeometry->warn("Reference ", reference->getName(),
+                    " has no shared primitives, is \"is_reference\" on?");
+            }
+        }
+
+        // Only read the second motion sample of the user data when it is used
+        const MotionBlurParams& motionBlurParams = generateContext.getMotionBlurParams();
+        std::vector<std::unique_ptr<Instance>> instances =
+            geometry::createScatterInstances(prototypes,
+                                             pScatterGeom->get(attrReferenceIndices),
+                                             pScatterGeom->get(attrPositions),
+                                             pScatterGeom->get(attrOrientations),
+                                             pScatterGeom->get(attrScales),
+                                             pScatterGeom->get(attrPrimitiveAttributes),
+                                             true, motionBlurParams.isMotionBlurOn());
+
+        // hand the instances to renderer
+        for (std::unique_ptr<Instance>& instance : instances) {
+            if (instance) {
+                addPrimitive(std::move(instance), motionBlurParams, parent2render);
+            }
+        }
+    }
+private:
+};
+
+} // namespace moonshine
+
+//------------------------------------------------------------------------------
+
+moonray::geom::Procedural* ScatterGeometry::createProcedural() const
+{
+    moonray::geom::State state;
+    return new moonshine::ScatterProcedural(state);
+}
+
+void ScatterGeometry::destroyProcedural() const
+{
+    delete mProcedural;
+}
@@ -0,0 +1,70 @@
+// Copyright 2023-2024 DreamWorks Animation LLC
+// SPDX-License-Identifier: Apache-2.0
+
+///
+/// @file attributes.cc
+/// $Id$
+///
+
+#include <scene_rdl2/scene/rdl2/rdl2.h>
+
+RDL2_DSO_ATTR_DECLARE
+    // declare rdl2 attribute that geometry shader can access
+    scene_rdl2::rdl2::AttributeKey<scene_rdl2::rdl2::SceneObjectVector> attrReferences;
+    scene_rdl2::rdl2::AttributeKey<scene_rdl2::rdl2::IntVector> attrReferenceIndices;
+    scene_rdl2::rdl2::AttributeKey<scene_rdl2::rdl2::Vec3fVector> attrPositions;
+    scene_rdl2::rdl2::AttributeKey<scene_rdl2::rdl2::Vec4fVector> attrOrientations;
+    scene_rdl2::rdl2::AttributeKey<scene_rdl2::rdl2::Vec3fVector> attrScales;
+    scene_rdl2::rdl2::AttributeKey<scene_rdl2::rdl2::SceneObjectVector> attrPrimitiveAttributes;
+
+RDL2_DSO_ATTR_DEFINE(scene_rdl2::rdl2::Geometry)
+    // define rdl2 attribute type, name and default value
+    attrReferences =
+        sceneClass.declareAttribute<scene_rdl2::rdl2::SceneObjectVector>("references", {},
+            scene_rdl2::rdl2::FLAGS_NONE, scene_rdl2::rdl2::INTERFACE_GEOMETRY);
+    sceneClass.setMetadata(attrReferences, "comment",
+            "The prototype geometries to scatter.  Each must have \"is_reference\" "
+            "turned on, so that it is built once and shared by all of its instances.");
+    sceneClass.setGroup("Scatter", attrReferences);
+
+    attrReferenceIndices =
+        sceneClass.declareAttribute<scene_rdl2::rdl2::IntVector>("reference_indices", {});
+    sceneClass.setMetadata(attrReferenceIndices, "label", "reference indices");
+    sceneClass.setMetadata(attrReferenceIndices, "comment",
+            "The index in \"references\" of the prototype of each instance.  A single "
+            "index applies to every instance, instances without an index use the "
+            "first prototype.");
+    sceneClass.setGroup("Scatter", attrReferenceIndices);
+
+    attrPositions =
+        sceneClass.declareAttribute<scene_rdl2::rdl2::Vec3fVector>("positions", {});
+    sceneClass.setMetadata(attrPositions, "comment",
+            "The position of each instance.  One instance is created per position.");
+    sceneClass.setGroup("Scatter", attrPositions);
+
+    attrOrientations =
+        sceneClass.declareAttribute<scene_rdl2::rdl2::Vec4fVector>("orientations", {});
+    sceneClass.setMetadata(attrOrientations, "comment",
+            "The rotation of each instance as a quaternion, with the imaginary part in "
+            "xyz and the real part in w.  A single orientation applies to every "
+            "instance, instances without an orientation are not rotated.");
+    sceneClass.setGroup("Scatter", attrOrientations);
+
+    attrScales =
+        sceneClass.declareAttribute<scene_rdl2::rdl2::Vec3fVector>("scales", {});
+    sceneClass.setMetadata(attrScales, "comment",
+            "The scale of each instance, applied before the rotation.  A single scale "
+            "applies to every instance, instances without a scale are not scaled.");
+    sceneClass.setGroup("Scatter", attrScales);
+
+    attrPrimitiveAttributes =
+        sceneClass.declareAttribute<scene_rdl2::rdl2::SceneObjectVector>("primitive_attributes", {},
+            scene_rdl2::rdl2::FLAGS_NONE, scene_rdl2::rdl2::INTERFACE_USERDATA, { "primitive attributes" });
+    sceneClass.setMetadata(attrPrimitiveAttributes, "label", "primitive attributes");
+    sceneClass.setMetadata(attrPrimitiveAttributes, "comment",
+            "UserData holding one value per instance, or a single value for every "
+            "instance, made available to the instances' shaders as constant rate "
+            "primitive attributes.");
+    sceneClass.setGroup("Scatter", attrPrimitiveAttributes);
+
+RDL2_DSO_ATTR_END
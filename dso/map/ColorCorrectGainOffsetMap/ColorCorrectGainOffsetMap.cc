@@ -6,6 +6,8 @@
 #include "attributes.cc"
 #include "ColorCorrectGainOffsetMap_ispc_stubs.h"
 
+#include <moonshine/map/pointwise/PointwiseMaps.h>
+
 #include <moonray/rendering/shading/MapApi.h>
 #include <moonray/rendering/shading/ColorCorrect.h>
 
@@ -53,11 +55,10 @@ ColorCorrectGainOffsetMap::sample(const scene_rdl2::rdl2::Map *self, moonray::sh
     const ColorCorrectGainOffsetMap* me = static_cast<const ColorCorrectGainOffsetMap*>(self);
 
     const Color input = evalColor(me, attrInput, tls, state);
-    Color result(input);
 
     const float mix = evalFloat(me, attrMix, tls, state);
-    if (!me->get(attrOn) || isZero(mix)) {
-        *sample = result;
+    if (moonshine::pointwise::isColorCorrectOff(me->get(attrOn), mix)) {
+        *sample = input;
         return;
     }
 
@@ -75,14 +76,6 @@ ColorCorrectGainOffsetMap::sample(const scene_rdl2::rdl2::Map *self, moonray::sh
         offset = Color(evalFloat(me, attrOffset, tls, state));
     }
 
-    applyGainAndOffset(gain, offset, result);
-
-    if (!isEqual(mix, 1.0f)) {
-        result.r = lerpOpt(input.r, result.r, mix);
-        result.g = lerpOpt(input.g, result.g, mix);
-        result.b = lerpOpt(input.b, result.b, mix);
-    }
-
-    *sample = result;
+    *sample = moonshine::pointwise::colorCorrectGainOffset(input, mix, gain, offset);
 }
 
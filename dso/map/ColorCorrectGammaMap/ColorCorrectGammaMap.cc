@@ -6,6 +6,8 @@
 #include "attributes.cc"
 #include "ColorCorrectGammaMap_ispc_stubs.h"
 
+#include <moonshine/map/pointwise/PointwiseMaps.h>
+
 #include <moonray/rendering/shading/MapApi.h>
 #include <moonray/rendering/shading/ColorCorrect.h>
 
@@ -53,11 +55,10 @@ ColorCorrectGammaMap::sample(const scene_rdl2::rdl2::Map *self, moonray::shading
     const ColorCorrectGammaMap* me = static_cast<const ColorCorrectGammaMap*>(self);
 
     const Color input = evalColor(me, attrInput, tls, state);
-    Color result(input);
 
     const float mix = evalFloat(me, attrMix, tls, state);
-    if (!me->get(attrOn) || isZero(mix)) {
-        *sample = result;
+    if (moonshine::pointwise::isColorCorrectOff(me->get(attrOn), mix)) {
+        *sample = input;
         return;
     }
 
@@ -69,17 +70,7 @@ ColorCorrectGammaMap::sample(const scene_rdl2::rdl2::Map *self, moonray::shading
     } else {
         gamma = Color(evalFloat(me, attrGamma, tls, state));
     }
-    const Color invGamma = Color(1.0f / max(sEpsilon, gamma.r),
-                                 1.0f / max(sEpsilon, gamma.g),
-                                 1.0f / max(sEpsilon, gamma.b));
-    applyGamma(invGamma, result);
-
-    if (!isEqual(mix, 1.0f)) {
-        result.r = lerpOpt(input.r, result.r, mix);
-        result.g = lerpOpt(input.g, result.g, mix);
-        result.b = lerpOpt(input.b, result.b, mix);
-    }
 
-    *sample = result;
+    *sample = moonshine::pointwise::colorCorrectGamma(input, mix, gamma);
 }
 
@@ -5,6 +5,8 @@
 #include "attributes.cc"
 #include "ConstantColorMap_ispc_stubs.h"
 
+#include <moonshine/map/pointwise/PointwiseMaps.h>
+
 #include <moonray/rendering/shading/MapApi.h>
 
 using namespace scene_rdl2::math;
@@ -43,7 +45,6 @@ ConstantColorMap::sample(const Map* self, moonray::shading::TLState *tls,
                  const moonray::shading::State& state, Color* sample)
 {
     const ConstantColorMap* me = static_cast<const ConstantColorMap*>(self);
-    const Color result = me->get(attrColorValue);
-    *sample = result;
+    *sample = moonshine::pointwise::constantColor(me->get(attrColorValue));
 }
 
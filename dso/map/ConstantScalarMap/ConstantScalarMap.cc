@@ -5,6 +5,8 @@
 #include "attributes.cc"
 #include "ConstantScalarMap_ispc_stubs.h"
 
+#include <moonshine/map/pointwise/PointwiseMaps.h>
+
 #include <moonray/rendering/shading/MapApi.h>
 
 using namespace scene_rdl2::math;
@@ -43,8 +45,6 @@ ConstantScalarMap::sample(const Map* self, moonray::shading::TLState *tls,
                  const moonray::shading::State& state, Color* sample)
 {
     const ConstantScalarMap* me = static_cast<const ConstantScalarMap*>(self);
-    const float scalar = me->get(attrScalarValue);
-    Color result(scalar);
-    *sample = result;
+    *sample = moonshine::pointwise::constantScalar(me->get(attrScalarValue));
 }
 
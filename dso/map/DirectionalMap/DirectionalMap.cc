@@ -6,6 +6,7 @@
 #include "DirectionalMap_ispc_stubs.h"
 
 #include <moonshine/common/interpolation/Interpolation.h>
+#include <moonshine/map/projection/XformRegistry.h>
 #include <moonray/common/mcrt_macros/moonray_static_check.h>
 #include <moonray/common/mcrt_util/Atomic.h>
 #include <moonray/rendering/shading/MapApi.h>
@@ -35,7 +36,7 @@ private:
 
     ispc::DirectionalMap mIspc;
     NormalMap* mNormalMap;
-    std::unique_ptr<moonray::shading::Xform> mXform;
+    std::shared_ptr<moonray::shading::Xform> mXform;
 
 RDL2_DSO_CLASS_END(DirectionalMap)
 
@@ -72,7 +73,7 @@ DirectionalMap::update()
     const Node* node = get(attrObject) ?
         get(attrObject)->asA<Node>() : nullptr;
 
-    mXform = std::make_unique<moonray::shading::Xform>(this, node, nullptr, nullptr);
+    mXform = projection::acquireXform(this, node, nullptr, nullptr);
     mIspc.mXform = mXform->getIspcXform();
 
     // Use reference space
@@ -8,6 +8,8 @@
 #include "attributes.cc"
 #include "FloatToRgbMap_ispc_stubs.h"
 
+#include <moonshine/map/pointwise/PointwiseMaps.h>
+
 #include <moonray/rendering/shading/MapApi.h>
 
 using namespace scene_rdl2::math;
@@ -41,9 +43,9 @@ FloatToRgbMap::sample(const Map* self, moonray::shading::TLState *tls,
                  const moonray::shading::State& state, Color* sample)
 {
     const FloatToRgbMap* me = static_cast<const FloatToRgbMap*>(self);
-    sample->r = evalFloat(me, attrR, tls, state);
-    sample->g = evalFloat(me, attrG, tls, state);
-    sample->b = evalFloat(me, attrB, tls, state);
-    return;
+    const float r = evalFloat(me, attrR, tls, state);
+    const float g = evalFloat(me, attrG, tls, state);
+    const float b = evalFloat(me, attrB, tls, state);
+    *sample = moonshine::pointwise::floatToRgb(r, g, b);
 }
 
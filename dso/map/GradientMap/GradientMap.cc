@@ -6,11 +6,15 @@
 #include "attributes.cc"
 #include "GradientMap_ispc_stubs.h"
 
+#include <moonshine/map/projection/XformRegistry.h>
+
 #include <moonray/common/mcrt_macros/moonray_static_check.h>
 #include <moonray/common/mcrt_util/Atomic.h>
 #include <moonray/rendering/shading/MapApi.h>
 
+#include <algorithm>
 #include <memory>
+#include <vector>
 
 using namespace moonray::shading;
 using namespace scene_rdl2::math;
@@ -73,6 +77,16 @@ computeFalloff(float t, const ispc::GradientFalloffType type, const float expone
     }
     return t;
 }
+
+// Linearly interpolate lut, whose entries are evenly spaced over [0, 1], at x
+float
+lookupLut(const std::vector<float>& lut, const float x)
+{
+    const int last = static_cast<int>(lut.size()) - 1;
+    const float f = x * last;
+    const int i = scene_rdl2::math::clamp(static_cast<int>(f), 0, last - 1);
+    return scene_rdl2::math::lerp(lut[i], lut[i + 1], f - i);
+}
 } // end anon namespace
 
 //----------------------------------------------------------------------------
@@ -90,9 +104,17 @@ private:
 
     bool verifyInputs();
 
+    float falloffBlend(float blend) const;
+    float shapeBlend(float blend) const;
+    void bakeBlendLut();
+
     ispc::GradientMap mIspc; // Must be the 1st member.
 
-    std::unique_ptr<moonray::shading::Xform> mXform;
+    std::shared_ptr<moonray::shading::Xform> mXform;
+
+    // shapeBlend() sampled over [0, 1], empty unless bake_lut is on and
+    // the LUT is within lut_tolerance of it
+    std::vector<float> mBlendLut;
 
 RDL2_DSO_CLASS_END(GradientMap)
 
@@ -109,6 +131,8 @@ GradientMap::GradientMap(const scene_rdl2::rdl2::SceneClass &sceneClass,
     mIspc.mRefPKey = moonray::shading::StandardAttributes::sRefP;
 
     mIspc.mGradientMapDataPtr = (ispc::StaticGradientMapData*)&sStaticGradientMapData;
+    mIspc.mBlendLut = nullptr;
+    mIspc.mBlendLutSize = 0;
 
     const auto errorMissingReferenceData = sLogEventRegistry.createEvent(scene_rdl2::logging::ERROR_LEVEL,
                                            "missing reference data");
@@ -168,8 +192,113 @@ GradientMap::update()
                 get(attrObject)->asA<scene_rdl2::rdl2::Node>() : nullptr;
 
     // Construct Xform with default transforms for camera and screen.
-    mXform = std::make_unique<moonray::shading::Xform>(this, geom, nullptr, nullptr);
+    mXform = moonshine::projection::acquireXform(this, geom, nullptr, nullptr);
     mIspc.mXform = mXform->getIspcXform();
+
+    bakeBlendLut();
+}
+
+// Everything sample() does to the blend between color A and color B after
+// remapping it to the falloff range, which only depends on uniform
+// attributes
+float
+GradientMap::falloffBlend(float blend) const
+{
+    const int falloffType = get(attrFalloffType);
+    const float falloffExponent = get(attrFalloffExponent);
+
+    // Natural falloff curve is reversed from others, so we don't flip it.
+    // FIXME: this is a little craziness, just fix the function instead?
+    if (falloffType != ispc::GRADIENT_FALLOFF_NATURAL) blend = 1.0f - blend;
+    return (1.0f - computeFalloff(blend, static_cast<ispc::GradientFalloffType>(falloffType), falloffExponent));
+}
+
+float
+GradientMap::shapeBlend(float blend) const
+{
+    const float falloffEndIntensity = get(attrFalloffEndIntensity);
+    const float falloffBias = get(attrFalloffBias);
+    const bool isSymmetric = get(attrSymmetric);
+    float symmetricCenter = get(attrSymmetricCenter);
+
+    blend = falloffBlend(blend);
+
+    // colorA blends into colorB and then back into colorA.
+    // The blend from colorA to colorB and back to colorA
+    // occurs in the same amount of distance as blending from
+    // colorA to colorB without symmetric mode on.
+    if (isSymmetric) {
+        // Clamp to exclusive (0,1) range.
+        symmetricCenter = clamp(symmetricCenter, sEpsilon, sOneMinusEpsilon);
+
+        if (blend < symmetricCenter) {
+            blend /= symmetricCenter;
+        } else {
+            blend = 1.0f - (blend - symmetricCenter) / (1.0f - symmetricCenter);
+        }
+    }
+    blend *= saturate(falloffEndIntensity);
+    return bias(blend, falloffBias);
+}
+
+void
+GradientMap::bakeBlendLut()
+{
+    mBlendLut.clear();
+    mIspc.mBlendLut = nullptr;
+    mIspc.mBlendLutSize = 0;
+
+    if (!get(attrBakeLut)) {
+        return;
+    }
+
+    const int size = clamp(get(attrLutSize), 2, 4096);
+    std::vector<float> lut(size);
+    for (int i = 0; i < size; ++i) {
+        lut[i] = shapeBlend(static_cast<float>(i) / (size - 1));
+    }
+
+    // The error is largest between the entries, check a few points in
+    // every interval. A kink in the curve or a nan leaves the map
+    // evaluating the curve exactly.
+    const float tolerance = get(attrLutTolerance);
+    const auto withinTolerance = [&](const float x) {
+        return scene_rdl2::math::abs(lookupLut(lut, x) - shapeBlend(x)) <= tolerance;
+    };
+    for (int i = 0; i < size - 1; ++i) {
+        for (int j = 1; j < 4; ++j) {
+            if (!withinTolerance((i + 0.25f * j) / (size - 1))) {
+                return;
+            }
+        }
+    }
+
+    // The symmetric mode folds the curve where the falloff reaches the
+    // symmetric center, a knot the entries around it cut off. The falloff
+    // is monotonic, find the knot by bisection and check there too.
+    if (get(attrSymmetric)) {
+        const float center = clamp(get(attrSymmetricCenter), sEpsilon, sOneMinusEpsilon);
+        float lo = 0.f;
+        float hi = 1.f;
+        const bool loBelow = falloffBlend(lo) < center;
+        if (loBelow != (falloffBlend(hi) < center)) {
+            for (int i = 0; i < 32; ++i) {
+                const float mid = 0.5f * (lo + hi);
+                if ((falloffBlend(mid) < center) == loBelow) {
+                    lo = mid;
+                } else {
+                    hi = mid;
+                }
+            }
+            if (!withinTolerance(lo) || !withinTolerance(hi)) {
+                return;
+            }
+        }
+    }
+
+    mBlendLut = std::move(lut);
+    mIspc.mBlendLut = mBlendLut.data();
+    mIspc.mBlendLutSize = size;
 }
 
 void
@@ -186,12 +315,6 @@ GradientMap::sample(const scene_rdl2::rdl2::Map *self,
     const Vec3f end = me->get(attrEnd);
     const float falloffStart = me->get(attrFalloffStart);
     const float falloffEnd = me->get(attrFalloffEnd);
-    const int falloffType = me->get(attrFalloffType);
-    const float falloffExponent = me->get(attrFalloffExponent);
-    const float falloffEndIntensity = me->get(attrFalloffEndIntensity);
-    const float falloffBias = me->get(attrFalloffBias);
-    const bool isSymmetric = me->get(attrSymmetric);
-    float symmetricCenter = me->get(attrSymmetricCenter);
 
     // Retrieve position
     Vec3f pos;
@@ -233,27 +356,7 @@ GradientMap::sample(const scene_rdl2::rdl2::Map *self,
         blend = saturate((blend - falloffStart) / (falloffEnd - falloffStart));
     }
 
-    // Natural falloff curve is reversed from others, so we don't flip it.
-    // FIXME: this is a little craziness, just fix the function instead?
-    if (falloffType != ispc::GRADIENT_FALLOFF_NATURAL) blend = 1.0f - blend;
-    blend = (1.0f - computeFalloff(blend, static_cast<ispc::GradientFalloffType>(falloffType), falloffExponent));
-
-    // colorA blends into colorB and then back into colorA.
-    // The blend from colorA to colorB and back to colorA
-    // occurs in the same amount of distance as blending from
-    // colorA to colorB without symmetric mode on.
-    if (isSymmetric) {
-        // Clamp to exclusive (0,1) range.
-        symmetricCenter = clamp(symmetricCenter, sEpsilon, sOneMinusEpsilon);
-
-        if (blend < symmetricCenter) {
-            blend /= symmetricCenter;
-        } else {
-            blend = 1.0f - (blend - symmetricCenter) / (1.0f - symmetricCenter);
-        }
-    }
-    blend *= saturate(falloffEndIntensity);
-    blend = bias(blend, falloffBias);
+    blend = me->mBlendLut.empty() ? me->shapeBlend(blend) : lookupLut(me->mBlendLut, blend);
     Color result(lerp(colorA, colorB, blend));
 
     *sample = result;
@@ -11,6 +11,7 @@
 #include <moonray/common/noise/Simplex.h>
 #include <moonray/map/primvar/Primvar.h>
 #include <moonshine/common/interpolation/Interpolation.h>
+#include <moonshine/map/projection/XformRegistry.h>
 
 #include <moonray/common/mcrt_macros/moonray_static_check.h>
 #include <moonray/rendering/shading/MapApi.h>
@@ -19,6 +20,25 @@
 
 static ispc::StaticNoiseMapData sStaticNoiseMapData;
 
+namespace {
+
+// Limit maxLevel to the octaves whose frequency is below the Nyquist limit of
+// a footprint of the given width in noise space. Finer octaves average out to
+// zero over the footprint. The fractional level fades the last octave in, as
+// a fractional max level does, so there is no popping as the footprint
+// changes.
+float
+lodMaxLevel(float maxLevel, float footprint, float lacunarity)
+{
+    if (footprint > 0.0f && lacunarity > 1.0f) {
+        const float nyquistLevel = 1.0f + log(0.5f / footprint) / log(lacunarity);
+        return min(maxLevel, max(1.0f, nyquistLevel));
+    }
+    return maxLevel;
+}
+
+} // namespace
+
 //----------------------------------------------------------------------------
 
 using namespace moonshine;
@@ -36,7 +56,7 @@ private:
 
     ispc::NoiseMap_v2 mIspc; // must be the 1st member
 
-    std::unique_ptr<moonray::shading::Xform> mXform;
+    std::shared_ptr<moonray::shading::Xform> mXform;
     std::unique_ptr<moonray::noise::Perlin> mNoiseDistort;
     std::unique_ptr<moonray::noise::Perlin> mNoiseR;
     std::unique_ptr<moonray::noise::Perlin> mNoiseG;
@@ -98,7 +118,7 @@ NoiseMap_v2::update()
     ispc::SHADING_Space space = static_cast<ispc::SHADING_Space>(get(attrSpace));
     if (space != ispc::SHADING_SPACE_REFERENCE && space != ispc::SHADING_SPACE_INPUT_COORDINATES) {
         // Construct Xform with custom camera
-        mXform = std::make_unique<moonray::shading::Xform>(this, geom, cam, nullptr);
+        mXform = projection::acquireXform(this, geom, cam, nullptr);
         mIspc.mXform = mXform->getIspcXform();
     }
 
@@ -119,11 +139,12 @@ NoiseMap_v2::update()
     }
 
     // If any of the transform parameters are bound, then
-    // we can't cache the transform, otherwise we do.
+    // we can't cache the transform, otherwise we do. The
+    // frequency multiplier is applied separately, so it
+    // does not need to be constant.
     if( getBinding(attrTranslation) || 
         getBinding(attrRotation) || 
-        getBinding(attrScale) ||
-        getBinding(attrFrequencyMultiplier)
+        getBinding(attrScale)
     ){
         mIspc.mUseStaticXform = false;
     } else {
@@ -207,14 +228,18 @@ NoiseMap_v2::sample(const Map *self, moonray::shading::TLState *tls,
 {
     const NoiseMap_v2 *me = static_cast<const NoiseMap_v2 *>(self);
 
-    // Retrieve position
+    // Retrieve position and its derivatives, which stay zero
+    // for the hair spaces
     Vec3f pos;
+    Vec3f pos_ddx(0.0f), pos_ddy(0.0f);
     ispc::SHADING_Space space = static_cast<ispc::SHADING_Space>(me->get(attrSpace));
     if (space == ispc::SHADING_SPACE_TEXTURE) {
         pos = Vec3f(
             state.getSt().x, 
             state.getSt().y, 
             0.0f);
+        pos_ddx = Vec3f(state.getdSdx(), state.getdTdx(), 0.0f);
+        pos_ddy = Vec3f(state.getdSdy(), state.getdTdy(), 0.0f);
     } else if (space == ispc::SHADING_SPACE_HAIR_SURFACE_ST) {
         Vec2f uv = state.getAttribute(moonray::shading::StandardAttributes::sSurfaceST);
         pos = Vec3f(uv.x, uv.y, 0.0f);
@@ -234,7 +259,7 @@ NoiseMap_v2::sample(const Map *self, moonray::shading::TLState *tls,
             inputSourceMode = ispc::INPUT_SOURCE_MODE_P_N;
         }
 
-        Vec3f pos_ddx, pos_ddy, pos_ddz;
+        Vec3f pos_ddz;
         if (!primvar::getPosition(tls, state,
                                   inputSourceMode,
                                   inputPosition,
@@ -250,7 +275,10 @@ NoiseMap_v2::sample(const Map *self, moonray::shading::TLState *tls,
     }
 
     // Scale P by frequency multiplier
-    pos *= evalFloat(self, attrFrequencyMultiplier, tls, state);
+    const float frequency = evalFloat(self, attrFrequencyMultiplier, tls, state);
+    pos *= frequency;
+    pos_ddx *= frequency;
+    pos_ddy *= frequency;
 
     // Further transform P using the transform parameters
     if (me->mIspc.mUseStaticXform) {
@@ -258,6 +286,8 @@ NoiseMap_v2::sample(const Map *self, moonray::shading::TLState *tls,
             asCpp(me->mIspc.mStaticXform), 
             pos
         );
+        pos_ddx = transformVector(asCpp(me->mIspc.mStaticXform), pos_ddx);
+        pos_ddy = transformVector(asCpp(me->mIspc.mStaticXform), pos_ddy);
     } else {
         // mapped xforms - compose the xform for each sample
         Xform3f xform = me->mNoiseR->orderedCompose(
@@ -268,6 +298,8 @@ NoiseMap_v2::sample(const Map *self, moonray::shading::TLState *tls,
             me->get(attrRotationOrder)
         );
         pos = transformPoint(xform, pos);
+        pos_ddx = transformVector(xform, pos_ddx);
+        pos_ddy = transformVector(xform, pos_ddy);
     }
 
     // Distortion
@@ -283,8 +315,13 @@ NoiseMap_v2::sample(const Map *self, moonray::shading::TLState *tls,
         pos += distortNoise * distortion;
     }
 
-    const float maxLevel = evalFloat(self, attrMaxLevel, tls, state);
+    float maxLevel = evalFloat(self, attrMaxLevel, tls, state);
     const float lacunarity = evalFloat(self, attrLacunarity, tls, state);
+    if (me->get(attrOctaveLod)) {
+        // The same octaves are dropped for every channel
+        const float footprint = max(length(pos_ddx), length(pos_ddy));
+        maxLevel = lodMaxLevel(maxLevel, footprint, lacunarity);
+    }
     const float persistence = evalFloat(self, attrPersistence, tls, state);
     const float amplitude = evalFloat(self, attrAmplitude, tls, state);
 
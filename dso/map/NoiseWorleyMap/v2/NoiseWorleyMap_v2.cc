@@ -10,6 +10,7 @@
 #include "NoiseWorleyMap_v2_ispc_stubs.h"
 
 #include <moonshine/common/interpolation/Interpolation.h>
+#include <moonshine/map/projection/XformRegistry.h>
 #include <moonray/common/mcrt_macros/moonray_static_check.h>
 #include <moonray/common/mcrt_util/Atomic.h>
 #include <moonray/map/primvar/Primvar.h>
@@ -39,9 +40,13 @@ private:
     static Color adjust(float d, const Map *self,
                               moonray::shading::TLState *tls, const moonray::shading::State &state);
 
+    template <int OutputMode>
+    static Color evalWorley(const NoiseWorleyMap_v2 *me, moonray::shading::TLState *tls,
+                            const moonray::shading::State &state, const Vec3f &pos);
+
     ispc::NoiseWorleyMap_v2 mIspc; // must be the 1st member
 
-    std::unique_ptr<moonray::shading::Xform> mXform;
+    std::shared_ptr<moonray::shading::Xform> mXform;
     std::unique_ptr<noise::Worley> mNoise;
 
 RDL2_DSO_CLASS_END(NoiseWorleyMap_v2)
@@ -99,7 +104,7 @@ NoiseWorleyMap_v2::update()
     ispc::SHADING_Space space = static_cast<ispc::SHADING_Space>(get(attrSpace));
     if (space != ispc::SHADING_SPACE_REFERENCE && space != ispc::SHADING_SPACE_INPUT_COORDINATES) {
         // Construct Xform with custom camera
-        mXform = std::make_unique<moonray::shading::Xform>(this, geom, cam, nullptr);
+        mXform = projection::acquireXform(this, geom, cam, nullptr);
         mIspc.mXform = mXform->getIspcXform();
     }
 
@@ -147,6 +152,14 @@ NoiseWorleyMap_v2::update()
 
         mIspc.mNoise = mNoise->getIspcWorley();
     }
+
+    // F orders with an unbound weight of zero never contribute to the
+    // distance or gradient outputs, so their weights are not evaluated
+    mIspc.mWeightedOrders = 0;
+    if (getBinding(attrF1) || get(attrF1) != 0.0f) mIspc.mWeightedOrders |= 1 << 0;
+    if (getBinding(attrF2) || get(attrF2) != 0.0f) mIspc.mWeightedOrders |= 1 << 1;
+    if (getBinding(attrF3) || get(attrF3) != 0.0f) mIspc.mWeightedOrders |= 1 << 2;
+    if (getBinding(attrF4) || get(attrF4) != 0.0f) mIspc.mWeightedOrders |= 1 << 3;
 }
 
 Color
@@ -186,6 +199,76 @@ NoiseWorleyMap_v2::adjust(float d, const Map *self, moonray::shading::TLState *t
     return noise;
 }
 
+template <int OutputMode>
+Color
+NoiseWorleyMap_v2::evalWorley(const NoiseWorleyMap_v2 *me, moonray::shading::TLState *tls,
+    const moonray::shading::State &state, const Vec3f &pos)
+{
+    const Map *self = me;
+
+    const float maxLevel = evalFloat(self, attrMaxLevel, tls, state);
+    float minkowskiNumber = evalFloat(self, attrMinkowskiNumber, tls, state);
+    // Clamp jitter to 0-1
+    const float jitter = clamp(evalFloat(self, attrJitter, tls, state), 0.f, 1.f);
+
+    // Weights of F1..F4, only used by the distance and gradient outputs
+    const int orders = me->mIspc.mWeightedOrders;
+    float f[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+    if constexpr (OutputMode == ispc::DISTANCE || OutputMode == ispc::GRADIENT) {
+        if (orders & (1 << 0)) f[0] = evalFloat(self, attrF1, tls, state);
+        if (orders & (1 << 1)) f[1] = evalFloat(self, attrF2, tls, state);
+        if (orders & (1 << 2)) f[2] = evalFloat(self, attrF3, tls, state);
+        if (orders & (1 << 3)) f[3] = evalFloat(self, attrF4, tls, state);
+    }
+
+    // The search always collects and sorts every point near pos, even
+    // though no output reads past F4 (or the cell id order). Its point
+    // generation lives in the moonray noise library and offers no bound
+    // on the number of points, so that cost can not be cut from here.
+    noise::Worley_PointArray worleyPoints;
+    ispc::NOISE_WorleySample noiseSample;
+    asCpp(noiseSample.position) = pos;
+    noiseSample.radius = 0.0f;
+    me->mNoise->searchPointsFractal(jitter, minkowskiNumber, maxLevel, noiseSample, worleyPoints);
+
+    if constexpr (OutputMode == ispc::DISTANCE) {
+        float d = 0.0f;
+        for (int i = 0; i < 4; ++i) {
+            if (orders & (1 << i)) {
+                d += f[i] * worleyPoints[i].dist;
+            }
+        }
+        return adjust(d, self, tls, state);
+    } else if constexpr (OutputMode == ispc::GRADIENT) {
+        Color noise(0.0f, 0.0f, 0.0f);
+        for (int i = 0; i < 4; ++i) {
+            if (orders & (1 << i)) {
+                noise.r += f[i] * worleyPoints[i].gradient.x;
+                noise.g += f[i] * worleyPoints[i].gradient.y;
+                noise.b += f[i] * worleyPoints[i].gradient.z;
+            }
+        }
+        return noise;
+    } else if constexpr (OutputMode == ispc::CELLID) {
+        const int cellId = worleyPoints[me->get(attrCellId)].id;
+        return me->mNoise->getCellColor(cellId);
+    } else if constexpr (OutputMode == ispc::CELL_EDGES) {
+        float d = worleyPoints[1].dist -
+                  worleyPoints[0].dist;
+        // Isolate Edges as equidistant points
+        // between voronoi cell centers
+        d = interpolation::smoothStep(d, 0.0f, 0.05f);
+        return adjust(d, self, tls, state);
+    } else {
+        // 0.1 constant is to get more user-friendly values on slider
+        float ps = 0.1f * (float) me->get(attrPointSize);
+        ps = max(sEpsilon, ps);
+        float d = worleyPoints[me->get(attrCellId)].dist;
+        d = 1.0f - interpolation::smoothStep(d, ps - sEpsilon, ps);
+        return Color(d, d, d);
+    }
+}
+
 void
 NoiseWorleyMap_v2::sample(const Map *self, moonray::shading::TLState *tls,
     const moonray::shading::State &state, Color *sample)
@@ -255,79 +338,28 @@ NoiseWorleyMap_v2::sample(const Map *self, moonray::shading::TLState *tls,
         pos = transformPoint(xform, pos);
     }
 
-    const float maxLevel = evalFloat(self, attrMaxLevel, tls, state);
-    float minkowskiNumber = evalFloat(self, attrMinkowskiNumber, tls, state);
-    // Clamp jitter to 0-1
-    const float jitter = clamp(evalFloat(self, attrJitter, tls, state), 0.f, 1.f);
-
-    const float f0 =  evalFloat(self, attrF1, tls, state);
-    const float f1 =  evalFloat(self, attrF2, tls, state);
-    const float f2 =  evalFloat(self, attrF3, tls, state);
-    const float f3 =  evalFloat(self, attrF4, tls, state);
-
-    noise::Worley_PointArray worleyPoints;
-    ispc::NOISE_WorleySample noiseSample;
-    asCpp(noiseSample.position) = pos;
-    noiseSample.radius = 0.0f;
-    me->mNoise->searchPointsFractal(jitter, minkowskiNumber, maxLevel, noiseSample, worleyPoints);
-
-    Color noise(0.0f, 0.0f, 0.0f);
-
+    // The output mode is not bindable, so the mode is only switched on once
+    // and each specialization evaluates just the inputs it uses
     switch(me->get(attrOutputMode)) {
         case ispc::DISTANCE:
-            {
-                float d = f0 * worleyPoints[0].dist +
-                          f1 * worleyPoints[1].dist +
-                          f2 * worleyPoints[2].dist +
-                          f3 * worleyPoints[3].dist;
-                noise = adjust(d, self, tls, state);
-            }
+            *sample = evalWorley<ispc::DISTANCE>(me, tls, state, pos);
             break;
         case ispc::GRADIENT:
-            noise.r = f0 * worleyPoints[0].gradient.x +
-                      f1 * worleyPoints[1].gradient.x +
-                      f2 * worleyPoints[2].gradient.x +
-                      f3 * worleyPoints[3].gradient.x;
-            noise.g = f0 * worleyPoints[0].gradient.y +
-                      f1 * worleyPoints[1].gradient.y +
-                      f2 * worleyPoints[2].gradient.y +
-                      f3 * worleyPoints[3].gradient.y;
-            noise.b = f0 * worleyPoints[0].gradient.z +
-                      f1 * worleyPoints[1].gradient.z +
-                      f2 * worleyPoints[2].gradient.z +
-                      f3 * worleyPoints[3].gradient.z;
+            *sample = evalWorley<ispc::GRADIENT>(me, tls, state, pos);
             break;
         case ispc::CELLID:
-            {
-                const int cellId = worleyPoints[me->get(attrCellId)].id;
-                noise = me->mNoise->getCellColor(cellId);
-            }
+            *sample = evalWorley<ispc::CELLID>(me, tls, state, pos);
             break;
         case ispc::CELL_EDGES:
-            {
-                float d = worleyPoints[1].dist -
-                          worleyPoints[0].dist;
-                // Isolate Edges as equidistant points
-                // between voronoi cell centers
-                d = interpolation::smoothStep(d, 0.0f, 0.05f);
-                noise = adjust(d, self, tls, state);
-            }
+            *sample = evalWorley<ispc::CELL_EDGES>(me, tls, state, pos);
             break;
         case ispc::POINTS:
-            {
-                // 0.1 constant is to get more user-friendly values on slider
-                float ps = 0.1f * (float) me->get(attrPointSize);
-                ps = max(sEpsilon, ps);
-                float d = worleyPoints[me->get(attrCellId)].dist;
-                d = 1.0f - interpolation::smoothStep(d, ps - sEpsilon, ps);
-                noise = Color(d, d, d);
-            }
+            *sample = evalWorley<ispc::POINTS>(me, tls, state, pos);
             break;
         default:
+            *sample = Color(0.0f, 0.0f, 0.0f);
             break;
     }
-
-    *sample = noise;
 }
 
 // Reproduction in whole or in part without prior written worleyPermission of a
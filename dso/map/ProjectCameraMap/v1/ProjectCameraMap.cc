@@ -8,6 +8,7 @@
 
 #include <moonray/map/primvar/Primvar.h>
 #include <moonshine/map/projection/ProjectionUtil.h>
+#include <moonshine/map/projection/XformRegistry.h>
 
 #include <moonray/common/mcrt_macros/moonray_static_check.h>
 #include <moonray/rendering/shading/MapApi.h>
@@ -33,7 +34,7 @@ private:
                        const moonray::shading::State &state, Color *sample);
 
     ispc::ProjectCameraMap mIspc;
-    std::unique_ptr<moonray::shading::Xform> mXform;
+    std::shared_ptr<moonray::shading::Xform> mXform;
 
 RDL2_DSO_CLASS_END(ProjectCameraMap)
 
@@ -79,7 +80,7 @@ ProjectCameraMap::update()
                 window[2] = get(attrWindowXMax);
                 window[3] = get(attrWindowYMax);
             }
-            mXform = std::make_unique<moonray::shading::Xform>(this, nullptr, projectorCamera, &window);
+            mXform = projection::acquireXform(this, nullptr, projectorCamera, &window);
             mIspc.mXform = mXform->getIspcXform();
             mIspc.mHasValidProjector = true;
         } else {
@@ -7,13 +7,18 @@
 #include "ProjectCameraMap_v2_ispc_stubs.h"
 
 #include <moonray/map/primvar/Primvar.h>
+#include <moonshine/map/projection/DepthMap.h>
 #include <moonshine/map/projection/ProjectionUtil.h>
+#include <moonshine/map/projection/XformRegistry.h>
 
 #include <moonray/common/mcrt_macros/moonray_static_check.h>
 #include <moonray/rendering/shading/BasicTexture.h>
 #include <moonray/rendering/shading/MapApi.h>
 
+#include <algorithm>
 #include <memory>
+#include <sstream>
+#include <string>
 
 using namespace moonshine;
 using namespace scene_rdl2::math;
@@ -34,8 +39,9 @@ private:
                        const moonray::shading::State &state, Color *sample);
 
     ispc::ProjectCameraMap_v2 mIspc;
-    std::unique_ptr<moonray::shading::Xform> mXform;
+    std::shared_ptr<moonray::shading::Xform> mXform;
     std::unique_ptr<moonray::shading::BasicTexture> mTexture;
+    std::shared_ptr<projection::DepthMap> mDepthMap;
 
 RDL2_DSO_CLASS_END(ProjectCameraMap_v2)
 
@@ -60,6 +66,7 @@ ProjectCameraMap_v2::ProjectCameraMap_v2(const scene_rdl2::rdl2::SceneClass &sce
 
     mTexture = std::make_unique<moonray::shading::BasicTexture>(this, sLogEventRegistry);
     mIspc.mTexture = &mTexture->getBasicTextureData();
+    mIspc.mDepthMap = nullptr;
 
     // Set projection error messages and fatal color
     projection::initLogEvents(*mIspc.mStaticData, sLogEventRegistry, this);
@@ -104,35 +111,38 @@ ProjectCameraMap_v2::update()
     // determine aspect ratio
     float aspectRatio;
     if (get(attrAspectRatioSource) == ispc::ASPECT_SOURCE_TEXTURE) {
-        if (hasChanged(attrTexture)) {
-            // compute 'screen window' based on the texture's dimensions
-            // and pixel aspect ratio
-            int width;
-            int height;
-            mTexture->getDimensions(width, height);
-            const float imageAspectRatio = static_cast<float>(width)/height;
-            const float pixelAspectRatio = mTexture->getPixelAspectRatio();
-            aspectRatio = imageAspectRatio * pixelAspectRatio;
-        }
+        // compute 'screen window' based on the texture's dimensions
+        // and pixel aspect ratio
+        int width;
+        int height;
+        mTexture->getDimensions(width, height);
+        const float imageAspectRatio = static_cast<float>(width)/height;
+        const float pixelAspectRatio = mTexture->getPixelAspectRatio();
+        aspectRatio = imageAspectRatio * pixelAspectRatio;
     } else { // ispc::ASPECT_SOURCE_CUSTOM
         aspectRatio = get(attrCustomAspectRatio);
     }
 
-    // build transform
-    if (hasChanged(attrTexture) || hasChanged(attrProjector) || hasChanged(attrAspectRatioSource)) {
-        // build window
-        std::array<float, 4> window;
-        if (aspectRatio >= 1.0f) {
-            aspectRatio = 1.0f / aspectRatio;
-            window = { -1.0f, aspectRatio, 1.0f, -aspectRatio};
-        } else {
-            window = { -aspectRatio, 1.0f, aspectRatio, -1.0f};
-        }
+    // width over height of the projection, the depth map must match it
+    const float projectionAspectRatio = aspectRatio;
 
-        mXform = std::make_unique<moonray::shading::Xform>(this, nullptr, projectorCamera, &window);
-        mIspc.mXform = mXform->getIspcXform();
+    // build window
+    std::array<float, 4> window;
+    if (aspectRatio >= 1.0f) {
+        aspectRatio = 1.0f / aspectRatio;
+        window = { -1.0f, aspectRatio, 1.0f, -aspectRatio};
+    } else {
+        window = { -aspectRatio, 1.0f, aspectRatio, -1.0f};
     }
 
+    // build transform. The registry key holds the projector's lens and the
+    // scene's resolution, which can change without any attribute of this
+    // map changing, so look it up on every update. Let go of the old
+    // transforms first so that they are freed if nothing else holds them.
+    mXform.reset();
+    mXform = projection::acquireXform(this, nullptr, projectorCamera, &window);
+    mIspc.mXform = mXform->getIspcXform();
+
     // map [-1, 1] -> [0, 1]
     static const Xform3f s2uv(Vec3f(0.5f, 0.0f, 0.0f),
                                     Vec3f(0.0f, 0.5f, 0.0f),
@@ -141,6 +151,29 @@ ProjectCameraMap_v2::update()
 
     asCpp(mIspc.s2uv) = s2uv;
 
+    // Load the depth map that occludes the projection. Without a usable one
+    // the map still projects, only without occlusion. Its aspect ratio may
+    // be 1% off the projection's, for the rounding of its resolution.
+    std::shared_ptr<projection::DepthMap> depthMap;
+    if (get(attrOcclusion)) {
+        std::string errorStr;
+        if (!projection::acquireDepthMap(get(attrDepthMap), depthMap, errorStr)) {
+            warn(errorStr + ", occlusion is off");
+        } else if (!(scene_rdl2::math::abs(depthMap->getAspectRatio() - projectionAspectRatio) <=
+                     0.01f * projectionAspectRatio)) {
+            std::ostringstream msg;
+            msg << "Aspect ratio " << depthMap->getAspectRatio() << " of depth map "
+                << get(attrDepthMap) << " does not match the projection's "
+                << projectionAspectRatio << ", occlusion is off";
+            warn(msg.str());
+            depthMap.reset();
+        }
+    }
+    mDepthMap = std::move(depthMap);
+    mIspc.mDepthMap = mDepthMap ? &mDepthMap->getIspc() : nullptr;
+    mIspc.mOcclusionBias = get(attrOcclusionBias);
+    mIspc.mOcclusionFilterRadius = std::clamp(get(attrOcclusionFilterRadius), 0, 8);
+
     // declare needed attributes
     if (hasChanged(attrUseReferenceSpace)) {
         mRequiredAttributes.clear();
@@ -232,6 +265,31 @@ ProjectCameraMap_v2::sample(const scene_rdl2::rdl2::Map *self, moonray::shading:
 
         const Vec2f st(U.x, U.y);
 
+        // Compare against the depth map before paying for the texture
+        float visibility = 1.0f;
+        if (me->mDepthMap) {
+            Vec3f P_c, dPdx_c, dPdy_c, dPdz_c;
+            if (!primvar::getPosition(tls, state,
+                                      inputSourceMode,
+                                      inputPosition,
+                                      me->mXform.get(),
+                                      ispc::SHADING_SPACE_CAMERA,
+                                      me->mIspc.mRefPKey,
+                                      P_c, dPdx_c, dPdy_c, dPdz_c)) {
+                // Log missing ref_P data message
+                moonray::shading::logEvent(me, me->mIspc.mStaticData->sErrorMissingRefP);
+                *sample = asCpp(me->mIspc.mStaticData->sFatalColor);
+                return;
+            }
+            // The projector looks down -z
+            visibility = me->mDepthMap->visibility(st, -P_c.z,
+                                                   me->mIspc.mOcclusionBias,
+                                                   me->mIspc.mOcclusionFilterRadius);
+            if (visibility <= 0.0f) {
+                return;
+            }
+        }
+
         // sample the texture
         const Color4 tx = me->mTexture->sample(tls, state, st, derivatives);
         if (me->get(attrAlphaOnly)) {
@@ -246,6 +304,7 @@ ProjectCameraMap_v2::sample(const scene_rdl2::rdl2::Map *self, moonray::shading:
             }
             *sample = rgb;
         }
+        *sample *= visibility;
     }
 }
 
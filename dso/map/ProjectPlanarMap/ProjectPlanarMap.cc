@@ -28,7 +28,7 @@ public:
 private:
     static void sample(const scene_rdl2::rdl2::Map* self, moonray::shading::TLState* tls, const moonray::shading::State& state, Color* sample);
     ispc::ProjectPlanarMap mIspc;
-    std::unique_ptr<moonray::shading::Xform> mXform;
+    std::shared_ptr<moonray::shading::Xform> mXform;
 
 RDL2_DSO_CLASS_END(ProjectPlanarMap)
 
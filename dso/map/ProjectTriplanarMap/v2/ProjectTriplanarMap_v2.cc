@@ -34,7 +34,7 @@ private:
     projection::TriplanarFaceAttrs mFaceAttrs;
 
     std::array<std::unique_ptr<projection::TriplanarTexture>, 6> mTriplanarTextures;
-    std::unique_ptr<moonray::shading::Xform> mProjectorXform;
+    std::shared_ptr<moonray::shading::Xform> mProjectorXform;
 
 RDL2_DSO_CLASS_END(ProjectTriplanarMap_v2)
 
@@ -73,6 +73,7 @@ ProjectTriplanarMap_v2::update()
                                    get(attrRandomOffset),
                                    get(attrRandomRot),
                                    get(attrTransitionWidth),
+                                   get(attrSingleFaceSecondary),
                                    get(attrNumTextures),
                                    get(attrProjector),
                                    static_cast<ispc::PROJECTION_Mode>(get(attrProjectionMode)),
@@ -154,19 +155,20 @@ ProjectTriplanarMap_v2::sample(const scene_rdl2::rdl2::Map* self, moonray::shadi
     }
 
     Vec3f blending;
-    Color tx[6];
+    Color tx[3];
     projection::fillTriplanarTextures(tls, state,
                                       me->mIspc.mTriplanarData.mTextureIndices,
                                       me->mTriplanarTextures,
                                       me->mIspc.mTriplanarData.mTransitionWidthPower,
+                                      data.mSingleFaceSecondary && !state.isHifi(),
                                       normal,
                                       pos, pos_ddx, pos_ddy, pos_ddz,
                                       blending,
                                       tx);
 
     *sample =
-        ((normal.x > 0.0f) ? tx[0] : tx[3]) * blending.x +
-        ((normal.y > 0.0f) ? tx[1] : tx[4]) * blending.y +
-        ((normal.z > 0.0f) ? tx[2] : tx[5]) * blending.z;
+        tx[0] * blending.x +
+        tx[1] * blending.y +
+        tx[2] * blending.z;
 }
 
@@ -30,7 +30,7 @@ private:
                        const moonray::shading::State& state, Color* sample);
 
     ispc::ProjectTriplanarUdimMap mIspc;
-    std::unique_ptr<moonray::shading::Xform> mXform;
+    std::shared_ptr<moonray::shading::Xform> mXform;
 
 RDL2_DSO_CLASS_END(ProjectTriplanarUdimMap)
 
@@ -5,11 +5,14 @@
 #include "attributes.cc"
 #include "RampMap_ispc_stubs.h"
 
+#include <moonshine/map/projection/XformRegistry.h>
+
 #include <moonray/common/mcrt_macros/moonray_static_check.h>
 #include <moonray/rendering/shading/MapApi.h>
 #include <moonray/rendering/shading/RampControl.h>
 
 #include <memory>
+#include <vector>
 
 using namespace scene_rdl2::math;
 
@@ -29,11 +32,17 @@ private:
                              const moonray::shading::State& state) const;
 
     bool validateRampInputs();
+    void bakeLut();
 
     ispc::RampMap mIspc; // must be first member
-    std::unique_ptr<moonray::shading::Xform> mXform;
+    std::shared_ptr<moonray::shading::Xform> mXform;
     moonray::shading::ColorRampControl mRampControl;
 
+    // The ramp sampled over [0, 1] as rgb triples, empty unless bake_lut is
+    // on, the ramp type allows it and the LUT is within lut_tolerance of
+    // the ramp
+    std::vector<float> mLut;
+
 
 RDL2_DSO_CLASS_END(RampMap)
 
@@ -70,6 +79,28 @@ applyWrap(const int wrap, Vec2f& uv)
         uv.y = saturate(uv.y);
     }
 }
+
+// Can the ramp type be evaluated with a 1D LUT of the ramp?  The u and v
+// ramps follow one coordinate of the uv, which applyWrap() keeps within
+// [0, 1], and the input ramp follows the input.
+bool
+hasLutPosition(const ispc::RampInterpolator2DType rampType)
+{
+    return rampType == ispc::RAMP_INTERPOLATOR_2D_TYPE_V_RAMP ||
+           rampType == ispc::RAMP_INTERPOLATOR_2D_TYPE_U_RAMP ||
+           rampType == ispc::RAMP_INTERPOLATOR_2D_TYPE_INPUT;
+}
+
+// Linearly interpolate lut, rgb triples evenly spaced over [0, 1], at t
+Color
+lookupLut(const std::vector<float>& lut, const float t)
+{
+    const int last = static_cast<int>(lut.size() / 3) - 1;
+    const float f = t * last;
+    const int i = clamp(static_cast<int>(f), 0, last - 1);
+    const float* c = lut.data() + i * 3;
+    return lerp(Color(c[0], c[1], c[2]), Color(c[3], c[4], c[5]), f - i);
+}
 } // namespace
 
 RampMap::RampMap(const SceneClass& sceneClass, const std::string& name) :
@@ -80,6 +111,8 @@ RampMap::RampMap(const SceneClass& sceneClass, const std::string& name) :
     mSampleFuncv = (SampleFuncv) ispc::RampMap_getSampleFunc();
 
     mIspc.mRefPKey = moonray::shading::StandardAttributes::sRefP;
+    mIspc.mLut = nullptr;
+    mIspc.mLutSize = 0;
 }
 
 RampMap::~RampMap()
@@ -178,7 +211,7 @@ RampMap::update()
             get(attrCamera)->asA<Camera>() : nullptr;
 
     // Construct Xform with custom camera
-    mXform = std::make_unique<moonray::shading::Xform>(this, geom, cam, nullptr);
+    mXform = moonshine::projection::acquireXform(this, geom, cam, nullptr);
     mIspc.mXform = mXform->getIspcXform();
 
     mIspc.mRampControl = mRampControl.asIspc();
@@ -204,6 +237,72 @@ RampMap::update()
                       reinterpret_cast<const ispc::RampInterpolatorMode*>(interpolations.data()),
                       static_cast<ispc::ColorRampControlSpace>(colorSpace),
                       false); // applyHueBlendAdjustment
+
+    bakeLut();
+}
+
+void
+RampMap::bakeLut()
+{
+    mLut.clear();
+    mIspc.mLut = nullptr;
+    mIspc.mLutSize = 0;
+
+    const ispc::RampInterpolator2DType rampType = (ispc::RampInterpolator2DType)get(attrRampType);
+    if (!get(attrBakeLut) || !hasLutPosition(rampType)) {
+        return;
+    }
+
+    // The ramp at t, as sample() would see it, with the coordinate of the
+    // uv the ramp type ignores set to s
+    const auto evalRamp = [&](const float t, const float s) {
+        Vec2f uv(s, s);
+        if (rampType == ispc::RAMP_INTERPOLATOR_2D_TYPE_V_RAMP) {
+            uv.y = t;
+        } else if (rampType == ispc::RAMP_INTERPOLATOR_2D_TYPE_U_RAMP) {
+            uv.x = t;
+        }
+        return mRampControl.eval2D(uv, rampType, t);
+    };
+
+    const int size = clamp(get(attrLutSize), 2, 4096);
+    std::vector<float> lut(size * 3);
+    for (int i = 0; i < size; ++i) {
+        const Color c = evalRamp(static_cast<float>(i) / (size - 1), 0.5f);
+        lut[i * 3 + 0] = c.r;
+        lut[i * 3 + 1] = c.g;
+        lut[i * 3 + 2] = c.b;
+    }
+
+    // The error is largest between the entries, check a few points in
+    // every interval, each with a different value of the ignored
+    // coordinate. A ramp can also turn or step at its knots, which the
+    // entries around a knot miss, so check at every knot too. Steps in the
+    // ramp, as with constant interpolation, or nans leave the map
+    // evaluating the ramp exactly.
+    const float tolerance = get(attrLutTolerance);
+    const auto withinTolerance = [&](const float t, const float s) {
+        const Color error = lookupLut(lut, t) - evalRamp(t, s);
+        return max(abs(error.r), max(abs(error.g), abs(error.b))) <= tolerance;
+    };
+    for (int i = 0; i < size - 1; ++i) {
+        for (int j = 1; j < 4; ++j) {
+            const float t = (i + 0.25f * j) / (size - 1);
+            const float s = static_cast<float>((i * 3 + j) % 17) / 16.0f;
+            if (!withinTolerance(t, s)) {
+                return;
+            }
+        }
+    }
+    for (const float position : get(attrPositions)) {
+        if (!withinTolerance(saturate(position), 0.5f)) {
+            return;
+        }
+    }
+
+    mLut = std::move(lut);
+    mIspc.mLut = mLut.data();
+    mIspc.mLutSize = size;
 }
 
 Color
@@ -227,6 +326,20 @@ RampMap::evaluateRamp(const Vec3f& pos, const Map* self, moonray::shading::TLSta
 
     // Evaluate ramp result based on type of ramp and interpolation
     const ispc::RampInterpolator2DType rampType = (ispc::RampInterpolator2DType)get(attrRampType);
+    if (!mLut.empty()) {
+        if (rampType == ispc::RAMP_INTERPOLATOR_2D_TYPE_V_RAMP) {
+            return lookupLut(mLut, uv.y);
+        } else if (rampType == ispc::RAMP_INTERPOLATOR_2D_TYPE_U_RAMP) {
+            return lookupLut(mLut, uv.x);
+        }
+
+        // The LUT does not extend past either end of the ramp
+        const float input = evalFloat(self, attrInput, tls, state);
+        if (input >= 0.0f && input <= 1.0f) {
+            return lookupLut(mLut, input);
+        }
+        return mRampControl.eval2D(uv, rampType, input);
+    }
     Color result = mRampControl.eval2D(uv, rampType, evalFloat(self, attrInput, tls, state));
     return result;
 }
@@ -34,15 +34,7 @@ SwitchColorMap::SwitchColorMap(const scene_rdl2::rdl2::SceneClass& sceneClass, c
 {
     mSampleFunc = SwitchColorMap::sample;
     mSampleFuncv = (scene_rdl2::rdl2::SampleFuncv) ispc::SwitchColorMap_getSampleFunc();
-}
-
-SwitchColorMap::~SwitchColorMap()
-{
-}
 
-void
-SwitchColorMap::update()
-{
     mInputAttrs.push_back(attrInput0);
     mInputAttrs.push_back(attrInput1);
     mInputAttrs.push_back(attrInput2);
@@ -115,6 +107,15 @@ SwitchColorMap::update()
     mInputAttrs.push_back(attrInput63);
 }
 
+SwitchColorMap::~SwitchColorMap()
+{
+}
+
+void
+SwitchColorMap::update()
+{
+}
+
 void
 SwitchColorMap::sample(const scene_rdl2::rdl2::Map* self, moonray::shading::TLState *tls,
                  const moonray::shading::State& state, Color* sample)
@@ -34,15 +34,7 @@ SwitchFloatMap::SwitchFloatMap(const scene_rdl2::rdl2::SceneClass& sceneClass, c
 {
     mSampleFunc = SwitchFloatMap::sample;
     mSampleFuncv = (scene_rdl2::rdl2::SampleFuncv) ispc::SwitchFloatMap_getSampleFunc();
-}
-
-SwitchFloatMap::~SwitchFloatMap()
-{
-}
 
-void
-SwitchFloatMap::update()
-{
     mInputAttrs.push_back(attrInput0);
     mInputAttrs.push_back(attrInput1);
     mInputAttrs.push_back(attrInput2);
@@ -115,6 +107,15 @@ SwitchFloatMap::update()
     mInputAttrs.push_back(attrInput63);
 }
 
+SwitchFloatMap::~SwitchFloatMap()
+{
+}
+
+void
+SwitchFloatMap::update()
+{
+}
+
 void
 SwitchFloatMap::sample(const scene_rdl2::rdl2::Map* self, moonray::shading::TLState *tls,
                  const moonray::shading::State& state, Color* sample)
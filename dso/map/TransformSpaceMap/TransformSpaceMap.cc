@@ -5,6 +5,7 @@
 #include "attributes.cc"
 #include "TransformSpaceMap_ispc_stubs.h"
 
+#include <moonshine/map/projection/XformRegistry.h>
 #include <moonray/rendering/shading/MapApi.h>
 
 using namespace scene_rdl2::math;
@@ -21,7 +22,7 @@ public:
 private:
     static void sample(const Map* self, moonray::shading::TLState* tls, const moonray::shading::State& state, Color* sample);
     ispc::TransformSpaceMap mIspc;
-    std::unique_ptr<moonray::shading::Xform> mXform;
+    std::shared_ptr<moonray::shading::Xform> mXform;
 
 RDL2_DSO_CLASS_END(TransformSpaceMap)
 
@@ -66,7 +67,7 @@ TransformSpaceMap::update()
     SceneObject const * cam = get(attrCamera);
     Camera const *rdlCamera = cam ? cam->asA<Camera>() : nullptr;
 
-    mXform = std::make_unique<moonray::shading::Xform>(this, rdlGeometry, rdlCamera, &window);
+    mXform = moonshine::projection::acquireXform(this, rdlGeometry, rdlCamera, &window);
     mIspc.mXform = mXform->getIspcXform();
 
     // Use reference space
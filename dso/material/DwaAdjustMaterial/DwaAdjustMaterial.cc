@@ -133,6 +133,8 @@ DwaAdjustMaterial::DwaAdjustMaterial(
 
     mShadeFunc = DwaAdjustMaterial::shade;
     mShadeFuncv = (ShadeFuncv) ispc::DwaAdjustMaterial_getShadeFunc();
+
+    mIspc.mAdjustedLobeFamilies = 0;
 }
 
 void
@@ -163,6 +165,17 @@ DwaAdjustMaterial::update()
 
     mOptionalAttributes.clear();
 
+    // Setting the specular can turn on specular lobes the input material
+    // doesn't have. Those families are plain weights and values that every
+    // material initializes, so they can be added to what the input produces.
+    mIspc.mAdjustedLobeFamilies = 0;
+    if (get(attrEnableSpecular)) {
+        mIspc.mAdjustedLobeFamilies = ispc::LOBE_FAMILY_SPECULAR |
+                                      ispc::LOBE_FAMILY_OUTER_SPECULAR |
+                                      ispc::LOBE_FAMILY_FABRIC;
+    }
+    setLobeFamilies(getLobeFamilies(mInputMtl) | mIspc.mAdjustedLobeFamilies);
+
     if (get(attrEnableSpecular)) {
         mIspc.mSpecularSet       = TypedAttributeKey<float>("specular_set");
         mIspc.mSpecularSetBlend  = TypedAttributeKey<float>("specular_set_blend");
@@ -249,6 +262,7 @@ DwaAdjustMaterial::resolveParameters(TLState *tls,
     bool result = false;
     if (mInputMtl) {
         result = mInputMtl->resolveParameters(tls, state, castsCaustics, params);
+        params.mLobeFamilies |= mIspc.mAdjustedLobeFamilies;
         if (result) {
             modifyParameters(tls, state, params);
         }
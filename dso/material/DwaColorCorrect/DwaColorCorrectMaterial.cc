@@ -156,6 +156,29 @@ DwaColorCorrectMaterial::update()
 {
     mInputMtl = registerLayerable(get(attrInputMaterial), mIspc.mSubMaterial);
     resolveUniformParameters(mIspc.mUParams);
+    setLobeFamilies(getLobeFamilies(mInputMtl));
+
+    // When nothing is bound the correction is the same at every shading
+    // point, so it is compiled once here, if it is linear, instead of being
+    // evaluated and applied one step at a time for each of them
+    ispc::ColorCorrectParameters& cc = mIspc.mCompiledParams;
+    cc.mCompiled = 0;
+    if (!getBinding(attrMix) &&
+        !getBinding(attrHueShift) &&
+        !getBinding(attrSaturation) &&
+        !getBinding(attrGain) &&
+        !getBinding(attrTMI)) {
+        cc.mOn = get(attrOn);
+        cc.mMix = saturate(get(attrMix));
+        cc.mHueShift = get(attrHueShift);
+        cc.mSaturation = max(0.f, get(attrSaturation));
+        cc.mGain = get(attrGain);
+        cc.mTmiEnabled = get(attrTMIEnabled);
+        asCpp(cc.mTmi) = get(attrTMI);
+        if (DwaBaseLayerable::compileColorCorrection(cc, mIspc.mCompiledMatrix)) {
+            cc.mCompiled = reinterpret_cast<intptr_t>(&mIspc.mCompiledMatrix);
+        }
+    }
 }
 
 bool
@@ -187,13 +210,18 @@ DwaColorCorrectMaterial::resolveParameters(TLState *tls,
     bool result = false;
     if (mInputMtl) {
         const size_t cc = params.mNumColorCorrections;
-        params.mColorCorrectParams[cc].mOn = get(attrOn);
-        params.mColorCorrectParams[cc].mMix = saturate(evalFloat(this, attrMix, tls, state));
-        params.mColorCorrectParams[cc].mHueShift = evalFloat(this, attrHueShift, tls, state);
-        params.mColorCorrectParams[cc].mSaturation = max(0.f, evalFloat(this, attrSaturation, tls, state));
-        params.mColorCorrectParams[cc].mGain = evalFloat(this, attrGain, tls, state);
-        params.mColorCorrectParams[cc].mTmiEnabled = get(attrTMIEnabled);
-        asCpp(params.mColorCorrectParams[cc].mTmi) = evalColor(this, attrTMI, tls, state);
+        if (mIspc.mCompiledParams.mCompiled) {
+            params.mColorCorrectParams[cc] = mIspc.mCompiledParams;
+        } else {
+            params.mColorCorrectParams[cc].mOn = get(attrOn);
+            params.mColorCorrectParams[cc].mMix = saturate(evalFloat(this, attrMix, tls, state));
+            params.mColorCorrectParams[cc].mHueShift = evalFloat(this, attrHueShift, tls, state);
+            params.mColorCorrectParams[cc].mSaturation = max(0.f, evalFloat(this, attrSaturation, tls, state));
+            params.mColorCorrectParams[cc].mGain = evalFloat(this, attrGain, tls, state);
+            params.mColorCorrectParams[cc].mTmiEnabled = get(attrTMIEnabled);
+            asCpp(params.mColorCorrectParams[cc].mTmi) = evalColor(this, attrTMI, tls, state);
+            params.mColorCorrectParams[cc].mCompiled = 0;
+        }
         params.mNumColorCorrections++;
 
         params.mNumColorCorrections = min(ispc::DWABASE_MAX_COLOR_CORRECTIONS,
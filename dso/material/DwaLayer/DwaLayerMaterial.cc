@@ -13,9 +13,13 @@
 #include <moonray/rendering/shading/MaterialApi.h>
 #include <moonshine/material/dwabase/DwaBase.h>
 #include <moonshine/material/dwabase/DwaBaseLayerable.h>
+#include <moonshine/material/dwabase/BlendWeightCache.h>
 #include <moonshine/material/dwabase/Blending.h>
+#include <scene_rdl2/render/util/Arena.h>
 
+#include <algorithm>
 #include <string>
+#include <vector>
 
 using namespace scene_rdl2::math;
 using namespace moonray::shading;
@@ -42,6 +46,7 @@ collectAttributeKeys()
     keys.mGlitterStyleBFrequency                = attrFallbackGlitterStyleBFrequency;
     keys.mGlitterFlakeTextureB                  = attrFallbackGlitterTextureB;
     keys.mGlitterDenseLodQuality                = attrFallbackGlitterLodQuality;
+    keys.mGlitterFlakeCacheCellFactor           = attrFallbackGlitterFlakeCacheCellFactor;
     keys.mGlitterLayeringMode                   = attrFallbackGlitterLayeringMode;
     keys.mGlitterDebugMode                      = attrFallbackGlitterDebugMode;
 
@@ -130,9 +135,27 @@ private:
                                       TLState *tls,
                                       const State& state);
 
+    // Saturated "mask" value, shared by all the resolve functions
+    // at one shading point when "mask" is bound
+    float resolveMask(TLState *tls, const State& state) const;
+
+    // Flatten this layer and any DwaLayerMaterials nested below it into
+    // mBlendOps, see DwaLayerBlendOp in DwaLayerMaterial.ispc
+    void compileBlendOps();
+    void appendLayerOps(const DwaLayerMaterial* layer, int depth, int& maxDepth);
+    void appendSubMaterialOps(const DwaBaseLayerable* layerable,
+                              const ispc::SubMtlData& subMtl,
+                              int depth, int& maxDepth);
+
+    bool runBlendOps(TLState *tls,
+                     const State& state,
+                     bool castsCaustics,
+                     ispc::DwaBaseParameters &params) const;
+
     ispc::DwaLayerMaterial  mIspc;
     const DwaBaseLayerable* mLayerableA;
     const DwaBaseLayerable* mLayerableB;
+    std::vector<ispc::DwaLayerBlendOp> mBlendOps;
 
 RDL2_DSO_CLASS_END(DwaLayerMaterial)
 
@@ -157,6 +180,10 @@ DwaLayerMaterial::DwaLayerMaterial(const SceneClass& sceneClass, const std::stri
 
     // This is used to get the glitter pointer and uniform parameters in ispc
     mIspc.mDwaBase = getISPCBaseMaterialStruct();
+    mIspc.mMaskIsBound = false;
+    mIspc.mBlendOps = nullptr;
+    mIspc.mNumBlendOps = 0;
+    mIspc.mNumBlendSlots = 0;
 }
 
 void
@@ -184,6 +211,11 @@ DwaLayerMaterial::resolveUniformParameters(ispc::DwaBaseUniformParameters &uPara
 void
 DwaLayerMaterial::update()
 {
+    // Nothing can be resolved until the blend ops are compiled below
+    mBlendOps.clear();
+    mIspc.mBlendOps = nullptr;
+    mIspc.mNumBlendOps = 0;
+
     if (hasChanged(attrMaterialA) || hasChanged(attrMaterialB)) {
         mIspc.mColorSpace = static_cast<ispc::BlendColorSpace>(get(attrColorSpace));
 
@@ -219,6 +251,16 @@ DwaLayerMaterial::update()
     }
 
     mIspc.mSubsurfaceTraceSet = (TraceSet *)get(attrSubsurfaceTraceSet);
+
+    // The sub-materials have already been updated, but nested layers may
+    // have changed even when our own inputs haven't, so always recompile
+    setLobeFamilies(getLobeFamilies(mLayerableA) | getLobeFamilies(mLayerableB));
+    compileBlendOps();
+
+    // An unbound mask is cheaper to evaluate than to look up. Any change to
+    // a bound network updates this material, so drop any cached values.
+    mIspc.mMaskIsBound = getBinding(attrMask) != nullptr;
+    invalidateBlendWeightCaches();
 }
 
 bool
@@ -254,25 +296,188 @@ DwaLayerMaterial::resolveSubsurfaceType(const State& state) const
     return mIspc.mDwaBase->mUParams.mSubsurface;
 }
 
+float
+DwaLayerMaterial::resolveMask(TLState *tls,
+                              const State& state) const
+{
+    const auto eval = [&]() {
+        return saturate(evalFloat(this, attrMask, tls, state));
+    };
+    return mIspc.mMaskIsBound ? resolveBlendWeight(this, state, eval) : eval();
+}
+
+void
+DwaLayerMaterial::compileBlendOps()
+{
+    int maxDepth = 0;
+    appendLayerOps(this, 0, maxDepth);
+
+    mIspc.mBlendOps = mBlendOps.data();
+    mIspc.mNumBlendOps = static_cast<int>(mBlendOps.size());
+    // A layer at depth d writes to a slot no higher than 2d and, when it
+    // blends, resolves its sides into the two slots above that
+    mIspc.mNumBlendSlots = 2 * maxDepth + 3;
+}
+
+void
+DwaLayerMaterial::appendLayerOps(const DwaLayerMaterial* layer,
+                                 int depth,
+                                 int& maxDepth)
+{
+    maxDepth = std::max(maxDepth, depth);
+
+    ispc::DwaLayerBlendOp op = {};
+    op.mDepth = depth;
+    op.mMaterial = (intptr_t)static_cast<const Material*>(layer);
+    op.mLayer = (intptr_t)layer->getISPCLayerMaterialStruct();
+
+    const size_t begin = mBlendOps.size();
+    op.mType = ispc::DWALAYER_BLEND_OP_BEGIN;
+    mBlendOps.push_back(op);
+
+    appendSubMaterialOps(layer->mLayerableB, layer->mIspc.mSubMtlB, depth + 1, maxDepth);
+
+    const size_t next = mBlendOps.size();
+    op.mType = ispc::DWALAYER_BLEND_OP_NEXT;
+    mBlendOps.push_back(op);
+
+    if (layer->mLayerableA) {
+        appendSubMaterialOps(layer->mLayerableA, layer->mIspc.mSubMtlA, depth + 1, maxDepth);
+    }
+
+    const size_t end = mBlendOps.size();
+    op.mType = ispc::DWALAYER_BLEND_OP_END;
+    mBlendOps.push_back(op);
+
+    mBlendOps[begin].mJump = static_cast<int>(next);
+    mBlendOps[next].mJump = static_cast<int>(end);
+}
+
+void
+DwaLayerMaterial::appendSubMaterialOps(const DwaBaseLayerable* layerable,
+                                       const ispc::SubMtlData& subMtl,
+                                       int depth,
+                                       int& maxDepth)
+{
+    const DwaLayerMaterial* layer = dynamic_cast<const DwaLayerMaterial*>(layerable);
+    if (layer && depth < ispc::DWALAYER_MAX_BLEND_DEPTH) {
+        appendLayerOps(layer, depth, maxDepth);
+        return;
+    }
+
+    // Anything else, including a missing sub-material, which fails to
+    // resolve, is resolved through its own resolveParameters()
+    ispc::DwaLayerBlendOp op = {};
+    op.mType = ispc::DWALAYER_BLEND_OP_LEAF;
+    op.mLayerable = (intptr_t)layerable;
+    op.mSubMtl = subMtl;
+    mBlendOps.push_back(op);
+}
+
+bool
+DwaLayerMaterial::runBlendOps(TLState *tls,
+                              const State& state,
+                              const bool castsCaustics,
+                              ispc::DwaBaseParameters &params) const
+{
+    const int numOps = mIspc.mNumBlendOps;
+    if (numOps == 0) {
+        return false;
+    }
+    const ispc::DwaLayerBlendOp* ops = mIspc.mBlendOps;
+
+    // Slot 0 is params, and a layer that blends resolves its material_B
+    // into the slot above its own and its material_A into the one above that
+    // The extra slots are only needed until the result is in params
+    scene_rdl2::alloc::Arena *arena = getArena(tls);
+    SCOPED_MEM(arena);
+    ispc::DwaBaseParameters* extraSlots =
+        arena->allocArray<ispc::DwaBaseParameters>(mIspc.mNumBlendSlots - 1);
+    const auto slot = [&](int i) -> ispc::DwaBaseParameters& {
+        return i == 0 ? params : extraSlots[i - 1];
+    };
+
+    int frameSlot[ispc::DWALAYER_MAX_BLEND_DEPTH];
+    int frameMode[ispc::DWALAYER_MAX_BLEND_DEPTH];
+    float frameMask[ispc::DWALAYER_MAX_BLEND_DEPTH];
+
+    int target = 0;
+    for (int i = 0; i < numOps; ++i) {
+        const ispc::DwaLayerBlendOp& op = ops[i];
+
+        if (op.mType == ispc::DWALAYER_BLEND_OP_LEAF) {
+            const DwaBaseLayerable* layerable = reinterpret_cast<const DwaBaseLayerable*>(op.mLayerable);
+            if (!layerable || !layerable->resolveParameters(tls, state, castsCaustics, slot(target))) {
+                return false;
+            }
+            continue;
+        }
+
+        const DwaLayerMaterial* layer = static_cast<const DwaLayerMaterial*>(
+            reinterpret_cast<const Material*>(op.mMaterial));
+        const int depth = op.mDepth;
+
+        if (op.mType == ispc::DWALAYER_BLEND_OP_BEGIN) {
+            frameSlot[depth] = target;
+            if (!layer->mLayerableA) {
+                frameMode[depth] = ispc::DWALAYER_BLEND_MODE_B_ONLY;
+                continue;
+            }
+            const float mask = layer->resolveMask(tls, state);
+            frameMask[depth] = mask;
+            if (isZero(mask)) {
+                frameMode[depth] = ispc::DWALAYER_BLEND_MODE_MASK_ZERO;
+            } else if (isOne(mask)) {
+                frameMode[depth] = ispc::DWALAYER_BLEND_MODE_MASK_ONE;
+                i = op.mJump;
+            } else {
+                frameMode[depth] = ispc::DWALAYER_BLEND_MODE_BLEND;
+                DwaBaseLayerable::copyColorCorrectParameters(slot(target), slot(target + 1));
+                DwaBaseLayerable::copyColorCorrectParameters(slot(target), slot(target + 2));
+                target = target + 1;
+            }
+        } else if (op.mType == ispc::DWALAYER_BLEND_OP_NEXT) {
+            if (frameMode[depth] == ispc::DWALAYER_BLEND_MODE_BLEND) {
+                target = frameSlot[depth] + 2;
+            } else {
+                // skip material_A
+                i = op.mJump - 1;
+            }
+        } else {
+            target = frameSlot[depth];
+            ispc::DwaBaseParameters& out = slot(target);
+            if (frameMode[depth] == ispc::DWALAYER_BLEND_MODE_BLEND) {
+                blendResolvedParameters(layer->mIspc.mColorSpace,
+                                        layer->getLobeFamilies(),
+                                        layer->getGlitterPointer(),
+                                        layer->mIspc.mEvalSubsurfaceNormal,
+                                        slot(target + 1),
+                                        slot(target + 2),
+                                        frameMask[depth],
+                                        out);
+            } else if (frameMode[depth] != ispc::DWALAYER_BLEND_MODE_B_ONLY &&
+                       layer->mIspc.mSubMtlA.mHasGlitter && layer->mIspc.mSubMtlB.mHasGlitter) {
+                // Glitter uniform parameters can't be blended, so when both
+                // sides have glitter this layer's Glitter object is used
+                const moonshine::glitter::Glitter* glitterPtr = layer->getGlitterPointer();
+                if (!glitterPtr) {
+                    return false;
+                }
+                out.mGlitterPointerScalar = (intptr_t)glitterPtr;
+                out.mGlitterUniformParameters = glitterPtr->getIspcUniformParameters();
+            }
+        }
+    }
+    return true;
+}
+
 bool
 DwaLayerMaterial::resolveParameters(TLState *tls,
                                     const State& state,
                                     const bool castsCaustics,
                                     ispc::DwaBaseParameters &params) const
 {
-    return blendParameters(tls,
-                           state,
-                           castsCaustics,
-                           params,
-                           mIspc.mDwaBase->mUParams,
-                           mIspc.mColorSpace,
-                           getGlitterPointer(),
-                           mIspc.mEvalSubsurfaceNormal,
-                           mIspc.mSubMtlB.mHasGlitter,
-                           mIspc.mSubMtlA.mHasGlitter,
-                           mLayerableB,
-                           mLayerableA,
-                           saturate(evalFloat(this, attrMask, tls, state)));
+    return runBlendOps(tls, state, castsCaustics, params);
 }
 
 float
@@ -283,7 +488,7 @@ DwaLayerMaterial::resolvePresence(TLState *tls,
                          state,
                          mLayerableB,
                          mLayerableA,
-                         saturate(evalFloat(this, attrMask, tls, state)));
+                         resolveMask(tls, state));
 }
 
 float
@@ -294,7 +499,7 @@ DwaLayerMaterial::resolveRefractiveIndex(TLState *tls,
                                 state,
                                 mLayerableB,
                                 mLayerableA,
-                                saturate(evalFloat(this, attrMask, tls, state)));
+                                resolveMask(tls, state));
 }
 
 Vec3f
@@ -305,7 +510,7 @@ DwaLayerMaterial::resolveSubsurfaceNormal(TLState *tls,
                                  state,
                                  mLayerableB,
                                  mLayerableA,
-                                 saturate(evalFloat(this, attrMask, tls, state)));
+                                 resolveMask(tls, state));
 }
 
 
@@ -13,6 +13,7 @@
 #include <moonshine/material/dwabase/DwaBase.h>
 #include <moonray/common/mcrt_macros/moonray_static_check.h>
 #include <moonray/rendering/shading/MaterialApi.h>
+#include <moonshine/material/dwabase/BlendWeightCache.h>
 #include <moonshine/material/dwabase/Blending.h>
 
 #include <string>
@@ -44,6 +45,7 @@ collectAttributeKeys()
     keys.mGlitterStyleBFrequency                = attrFallbackGlitterStyleBFrequency;
     keys.mGlitterFlakeTextureB                  = attrFallbackGlitterTextureB;
     keys.mGlitterDenseLodQuality                = attrFallbackGlitterLodQuality;
+    keys.mGlitterFlakeCacheCellFactor           = attrFallbackGlitterFlakeCacheCellFactor;
     keys.mGlitterLayeringMode                   = attrFallbackGlitterLayeringMode;
     keys.mGlitterDebugMode                      = attrFallbackGlitterDebugMode;
 
@@ -161,6 +163,10 @@ private:
                                       TLState *tls,
                                       const State& state);
 
+    // Clamped and interpolated "mix" value, shared by all the resolve
+    // functions at one shading point when "mix" is bound
+    float resolveMix(TLState *tls, const State& state) const;
+
     ispc::DwaMixMaterial mIspc;
     unsigned int mGlitterCount;
 
@@ -185,6 +191,7 @@ DwaMixMaterial::DwaMixMaterial(const SceneClass& sceneClass, const std::string&
 
     // This is used to get the glitter pointer and uniform parameters in ispc
     mIspc.mDwaBase = getISPCBaseMaterialStruct();
+    mIspc.mMixIsBound = false;
 }
 
 void
@@ -305,6 +312,7 @@ DwaMixMaterial::update()
     // and varies per shading point.
     mGlitterCount = 0;
     mIspc.mCastsCaustics = false;
+    int lobeFamilies = 0;
     size_t i = 0;
     while (i < ispc::DWA_MIX_MAX_MATERIALS) {
         mIspc.mSubMaterials[i] = (intptr_t)registerLayerable(dwaMaterials[i], mIspc.mSubMaterialData[i]);
@@ -318,6 +326,7 @@ DwaMixMaterial::update()
                 // If any attached material casts caustics, they all should.
                 mIspc.mCastsCaustics = true;
             }
+            lobeFamilies |= currSubMaterial->getLobeFamilies();
         } else {
             // Warning message is printed by SceneObject if the bound
             // interface type is incorrect.
@@ -326,6 +335,7 @@ DwaMixMaterial::update()
         ++i;
     }
     unsigned int numValidInputs = i;
+    setLobeFamilies(lobeFamilies);
 
     resolveUniformParameters(mIspc.mUParams);
 
@@ -348,6 +358,11 @@ DwaMixMaterial::update()
 
     mIspc.mMixInterpolation = static_cast<ispc::MixInterpolation>(get(attrMixInterpolation));
 
+    // An unbound mix is cheaper to evaluate than to look up. Any change to
+    // a bound network updates this material, so drop any cached values.
+    mIspc.mMixIsBound = getBinding(attrMix) != nullptr;
+    invalidateBlendWeightCaches();
+
     mIspc.mSubsurfaceTraceSet = static_cast<TraceSet *>(get(attrSubsurfaceTraceSet));
 }
 
@@ -369,14 +384,24 @@ DwaMixMaterial::resolveSubsurfaceType(const State& state) const
     return mIspc.mDwaBase->mUParams.mSubsurface;
 }
 
+float
+DwaMixMaterial::resolveMix(TLState *tls,
+                           const State& state) const
+{
+    const auto eval = [&]() {
+        const float mix = clamp(evalFloat(this, attrMix, tls, state), 0.f, mIspc.mMaxMixValue);
+        return interpolateMix(mix, mIspc.mMixInterpolation, mIspc.mInputMultiplier);
+    };
+    return mIspc.mMixIsBound ? resolveBlendWeight(this, state, eval) : eval();
+}
+
 bool
 DwaMixMaterial::resolveParameters(TLState *tls,
                                   const State& state,
                                   const bool castsCaustics,
                                   ispc::DwaBaseParameters &params) const
 {
-    float mix = clamp(evalFloat(this, attrMix, tls, state), 0.f, mIspc.mMaxMixValue);
-    mix = interpolateMix(mix, mIspc.mMixInterpolation, mIspc.mInputMultiplier);
+    const float mix = resolveMix(tls, state);
     const unsigned int t0 = static_cast<int>(mix);
     const DwaBaseLayerable* material0 = reinterpret_cast<DwaBaseLayerable*>(mIspc.mSubMaterials[t0]);
     const DwaBaseLayerable* material1 = reinterpret_cast<DwaBaseLayerable*>(mIspc.mSubMaterials[t0 + 1]);
@@ -387,6 +412,7 @@ DwaMixMaterial::resolveParameters(TLState *tls,
                            params,
                            mIspc.mDwaBase->mUParams,
                            mIspc.mColorSpace,
+                           getLobeFamilies(),
                            getGlitterPointer(),
                            mIspc.mEvalSubsurfaceNormalFn,
                            mIspc.mSubMaterialData[t0].mHasGlitter,
@@ -406,8 +432,7 @@ float
 DwaMixMaterial::resolvePresence(TLState *tls,
                                 const State& state) const
 {
-    float mix = clamp(evalFloat(this, attrMix, tls, state), 0.f, mIspc.mMaxMixValue);
-    mix = interpolateMix(mix, mIspc.mMixInterpolation, mIspc.mInputMultiplier);
+    const float mix = resolveMix(tls, state);
     const unsigned int t0 = static_cast<int>(mix);
     const DwaBaseLayerable* material0 = reinterpret_cast<DwaBaseLayerable*>(mIspc.mSubMaterials[t0]);
     const DwaBaseLayerable* material1 = reinterpret_cast<DwaBaseLayerable*>(mIspc.mSubMaterials[t0 + 1]);
@@ -423,8 +448,7 @@ float
 DwaMixMaterial::resolveRefractiveIndex(TLState *tls,
                                        const State& state) const
 {
-    float mix = clamp(evalFloat(this, attrMix, tls, state), 0.f, mIspc.mMaxMixValue);
-    mix = interpolateMix(mix, mIspc.mMixInterpolation, mIspc.mInputMultiplier);
+    const float mix = resolveMix(tls, state);
     const unsigned int t0 = static_cast<int>(mix);
     const DwaBaseLayerable* material0 = reinterpret_cast<DwaBaseLayerable*>(mIspc.mSubMaterials[t0]);
     const DwaBaseLayerable* material1 = reinterpret_cast<DwaBaseLayerable*>(mIspc.mSubMaterials[t0 + 1]);
@@ -441,8 +465,7 @@ DwaMixMaterial::resolveSubsurfaceNormal(TLState *tls,
                                         const State& state) const
 
 {
-    float mix = clamp(evalFloat(this, attrMix, tls, state), 0.f, mIspc.mMaxMixValue);
-    mix = interpolateMix(mix, mIspc.mMixInterpolation, mIspc.mInputMultiplier);
+    const float mix = resolveMix(tls, state);
     const unsigned int t0 = static_cast<int>(mix);
     const DwaBaseLayerable* material0 = reinterpret_cast<DwaBaseLayerable*>(mIspc.mSubMaterials[t0]);
     const DwaBaseLayerable* material1 = reinterpret_cast<DwaBaseLayerable*>(mIspc.mSubMaterials[t0 + 1]);
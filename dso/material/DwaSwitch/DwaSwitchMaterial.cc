@@ -219,6 +219,7 @@ DwaSwitchMaterial::update()
     dwaMaterials[63] = get(attrMaterial63);
 
     mMaterial = registerLayerable(dwaMaterials[choice], mIspc.mSubMaterial);
+    setLobeFamilies(getLobeFamilies(mMaterial));
     resolveUniformParameters(mIspc.mUParams);
     mIspc.mSubsurfaceTraceSet = (scene_rdl2::rdl2::TraceSet *)get(attrSubsurfaceTraceSet);
 
@@ -180,6 +180,8 @@ DwaTwoSidedMaterial::update()
         mBackMaterial = registerLayerable(get(attrBackMaterial), mIspc.mBackMaterial);
         resolveUniformParameters(mIspc.mUParams);
     }
+    // The sub-materials may have changed even when the bindings haven't
+    setLobeFamilies(getLobeFamilies(mFrontMaterial) | getLobeFamilies(mBackMaterial));
     mIspc.mSubsurfaceTraceSet = (TraceSet *)get(attrSubsurfaceTraceSet);
 }
 
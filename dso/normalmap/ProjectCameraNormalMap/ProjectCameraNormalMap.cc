@@ -8,6 +8,7 @@
 
 #include <moonray/map/primvar/Primvar.h>
 #include <moonshine/map/projection/ProjectionUtil.h>
+#include <moonshine/map/projection/XformRegistry.h>
 
 #include <moonray/common/mcrt_macros/moonray_static_check.h>
 #include <moonray/rendering/shading/BasicTexture.h>
@@ -34,7 +35,7 @@ private:
                              const moonray::shading::State &state, Vec3f *sample);
 
     ispc::ProjectCameraNormalMap mIspc;
-    std::unique_ptr<moonray::shading::Xform> mXform;
+    std::shared_ptr<moonray::shading::Xform> mXform;
     std::unique_ptr<moonray::shading::BasicTexture> mTexture;
 
 RDL2_DSO_CLASS_END(ProjectCameraNormalMap)
@@ -126,7 +127,7 @@ ProjectCameraNormalMap::update()
             window = { -aspectRatio, 1.0f, aspectRatio, -1.0f};
         }
 
-        mXform = std::make_unique<moonray::shading::Xform>(this, nullptr, projectorCamera, &window);
+        mXform = projection::acquireXform(this, nullptr, projectorCamera, &window);
         mIspc.mXform = mXform->getIspcXform();
     }
 
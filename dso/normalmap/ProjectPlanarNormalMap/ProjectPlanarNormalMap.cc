@@ -8,6 +8,7 @@
 #include <moonray/map/primvar/Primvar.h>
 #include <moonshine/map/projection/TriplanarTexture.h>
 #include <moonshine/map/projection/ProjectionUtil.h>
+#include <moonshine/map/projection/XformRegistry.h>
 
 #include <moonray/common/mcrt_macros/moonray_static_check.h>
 #include <moonray/rendering/shading/MapApi.h>
@@ -47,8 +48,8 @@ private:
                              Vec3f* sample);
     ispc::ProjectPlanarNormalMap mIspc; // must be first member
     std::unique_ptr<moonray::shading::BasicTexture> mTexture;
-    std::unique_ptr<moonray::shading::Xform> mProjectorXform;
-    std::unique_ptr<moonray::shading::Xform> mObjXform;
+    std::shared_ptr<moonray::shading::Xform> mProjectorXform;
+    std::shared_ptr<moonray::shading::Xform> mObjXform;
 
 RDL2_DSO_CLASS_END(ProjectPlanarNormalMap)
 
@@ -135,7 +136,7 @@ ProjectPlanarNormalMap::update()
     }
 
     // Construct Xform for space of object being rendered to transform texture normals into
-    mObjXform = std::make_unique<moonray::shading::Xform>(this, nullptr, nullptr, nullptr);
+    mObjXform = projection::acquireXform(this, nullptr, nullptr, nullptr);
     mIspc.mObjXform = mObjXform->getIspcXform();
 
     // Note below we use a hard coded 0.5 value for the transition width.
@@ -6,6 +6,7 @@
 #include "ProjectTriplanarNormalMap_v2_ispc_stubs.h"
 
 #include <moonshine/map/projection/ProjectionUtil.h>
+#include <moonshine/map/projection/XformRegistry.h>
 #include <moonshine/map/projection/TriplanarTexture.h>
 #include <moonray/map/primvar/Primvar.h>
 
@@ -39,8 +40,8 @@ private:
     ispc::ProjectTriplanarNormalMap_v2 mIspc; // must be first member
     projection::TriplanarFaceAttrs mFaceAttrs;
     std::array<std::unique_ptr<projection::TriplanarTexture>, 6> mTriplanarTextures;
-    std::unique_ptr<moonray::shading::Xform> mProjectorXform;
-    std::unique_ptr<moonray::shading::Xform> mObjXform;
+    std::shared_ptr<moonray::shading::Xform> mProjectorXform;
+    std::shared_ptr<moonray::shading::Xform> mObjXform;
 
 RDL2_DSO_CLASS_END(ProjectTriplanarNormalMap_v2)
 
@@ -80,6 +81,7 @@ ProjectTriplanarNormalMap_v2::update()
                                    get(attrRandomOffset),
                                    get(attrRandomRot),
                                    get(attrTransitionWidth),
+                                   get(attrSingleFaceSecondary),
                                    get(attrNumTextures),
                                    get(attrProjector),
                                    static_cast<ispc::PROJECTION_Mode>(get(attrProjectionMode)),
@@ -107,7 +109,7 @@ ProjectTriplanarNormalMap_v2::update()
     }
 
     // Construct Xform for space of object being rendered to transform texture normals into
-    mObjXform = std::make_unique<moonray::shading::Xform>(this, nullptr, nullptr, nullptr);
+    mObjXform = projection::acquireXform(this, nullptr, nullptr, nullptr);
     mIspc.mTriplanarData.mObjXform = mObjXform->getIspcXform();
 
     // Get whether or not the normals have been reversed
@@ -172,27 +174,28 @@ ProjectTriplanarNormalMap_v2::sampleNormal(const NormalMap* self,
     }
 
     Vec3f blending;
-    Vec3f oNormal[6];
-    float tNormalLength[6];
+    Vec3f oNormal[3];
+    float tNormalLength[3];
     fillTriplanarNormalTextures(me->get(attrNormalEncoding),
                                 tls, state,
                                 me->mIspc.mTriplanarData.mTextureIndices,
                                 me->mTriplanarTextures,
                                 data.mTransitionWidthPower,
+                                data.mSingleFaceSecondary && !state.isHifi(),
                                 normal,
                                 pos, pos_ddx, pos_ddy, pos_ddz,
                                 blending,
                                 oNormal, tNormalLength);
 
     // Blend directions
-    const Vec3f bNormal = ((normal.x > 0.0f) ? oNormal[0] : oNormal[3]) * blending.x +
-                          ((normal.y > 0.0f) ? oNormal[1] : oNormal[4]) * blending.y +
-                          ((normal.z > 0.0f) ? oNormal[2] : oNormal[5]) * blending.z;
+    const Vec3f bNormal = oNormal[0] * blending.x +
+                          oNormal[1] * blending.y +
+                          oNormal[2] * blending.z;
 
     const float bNormalLength =
-        ((normal.x > 0.0f) ? tNormalLength[0] : tNormalLength[3]) * blending.x +
-        ((normal.y > 0.0f) ? tNormalLength[1] : tNormalLength[4]) * blending.y +
-        ((normal.z > 0.0f) ? tNormalLength[2] : tNormalLength[5]) * blending.z;
+        tNormalLength[0] * blending.x +
+        tNormalLength[1] * blending.y +
+        tNormalLength[2] * blending.z;
 
     Vec3f rNormal;
     if (inputSourceMode == ispc::INPUT_SOURCE_MODE_REF_P_REF_N) {
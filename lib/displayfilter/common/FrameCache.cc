@@ -0,0 +1,170 @@
+// Copyright 2023-2024 DreamWorks Animation LLC
+// SPDX-License-Identifier: Apache-2.0
+
+///
+/// @file FrameCache.cc
+/// $Id$
+///
+
+#include "FrameCache.h"
+
+#include <tbb/task_arena.h>
+
+#include <mutex>
+
+namespace moonshine {
+namespace displayfilter {
+
+FrameCache::FrameCache(BuildFunc build) :
+    mBuild(std::move(build)),
+    mNumPixels(0),
+    mCountWidth(0),
+    mCountHeight(0),
+    mNoPass(false),
+    mData(nullptr),
+    mWidth(0),
+    mHeight(0),
+    mPass(0)
+{
+}
+
+void
+FrameCache::resize(int width, int height)
+{
+    std::unique_lock<std::shared_mutex> lock(mMutex);
+    if (mFilterCounts && mCountWidth == width && mCountHeight == height) {
+        return;
+    }
+
+    const size_t frameSize = static_cast<size_t>(width) * static_cast<size_t>(height);
+    mFilterCounts.reset(new std::atomic<uint32_t>[frameSize]);
+    for (size_t i = 0; i < frameSize; ++i) {
+        mFilterCounts[i].store(0, std::memory_order_relaxed);
+    }
+    mCountWidth = width;
+    mCountHeight = height;
+    mNumPixels.store(0, std::memory_order_relaxed);
+    mNoPass.store(false, std::memory_order_relaxed);
+}
+
+uint64_t
+FrameCache::countPixels(const int* xs, const int* ys, int numPixels, int width, int height)
+{
+    if (width <= 0 || height <= 0) {
+        return sNoPass;
+    }
+
+    std::shared_lock<std::shared_mutex> lock(mMutex);
+    if (!mFilterCounts || mCountWidth != width || mCountHeight != height) {
+        // A new frame size, so a new frame
+        lock.unlock();
+        resize(width, height);
+        lock.lock();
+    }
+    if (mNoPass.load(std::memory_order_relaxed)) {
+        return sNoPass;
+    }
+
+    const uint64_t frameSize = static_cast<uint64_t>(width) * static_cast<uint64_t>(height);
+    const uint64_t before = mNumPixels.fetch_add(numPixels, std::memory_order_relaxed);
+    const uint64_t pass = before / frameSize;
+
+    bool onePerPass = true;
+    for (int i = 0; i < numPixels; ++i) {
+        if (xs[i] < 0 || xs[i] >= width || ys[i] < 0 || ys[i] >= height) {
+            onePerPass = false;
+            continue;
+        }
+        const size_t pixel = static_cast<size_t>(ys[i]) * static_cast<size_t>(width) + xs[i];
+        const uint32_t count = mFilterCounts[pixel].fetch_add(1, std::memory_order_relaxed);
+        onePerPass &= count == pass;
+    }
+
+    if (!onePerPass) {
+        mNoPass.store(true, std::memory_order_relaxed);
+        return sNoPass;
+    }
+    return pass;
+}
+
+const void*
+FrameCache::acquire(const void* inBuffer, int width, int height, uint64_t pass)
+{
+    if (pass == sNoPass) {
+        return nullptr;
+    }
+
+    while (true) {
+        // The data is only read with the lock held shared from the check
+        // on, so it is always the data that was checked
+        mMutex.lock_shared();
+        if (mData && mWidth == width && mHeight == height) {
+            if (mPass == pass) {
+                return mData;
+            }
+            if (mPass > pass) {
+                // A later pass started before this gang got here, and this
+                // pass's data is gone
+                mMutex.unlock_shared();
+                return nullptr;
+            }
+        }
+        mMutex.unlock_shared();
+
+        std::unique_lock<std::shared_mutex> lock(mMutex);
+        // Every gang of the pass gets here, only the first rebuilds
+        if (!mData || mWidth != width || mHeight != height || mPass < pass) {
+            tbb::this_task_arena::isolate([&] {
+                mData = mBuild(inBuffer, width, height);
+            });
+            mWidth = width;
+            mHeight = height;
+            mPass = pass;
+        }
+    }
+}
+
+void
+FrameCache::release()
+{
+    mMutex.unlock_shared();
+}
+
+void
+FrameCache::invalidate()
+{
+    std::unique_lock<std::shared_mutex> lock(mMutex);
+    mNumPixels.store(0, std::memory_order_relaxed);
+    mFilterCounts.reset();
+    mCountWidth = 0;
+    mCountHeight = 0;
+    mNoPass.store(false, std::memory_order_relaxed);
+    mData = nullptr;
+    mWidth = 0;
+    mHeight = 0;
+    mPass = 0;
+}
+
+} // namespace displayfilter
+} // namespace moonshine
+
+extern "C" {
+uint64_t
+FrameCache_countPixels(intptr_t cache, const int* xs, const int* ys, int numPixels, int width, int height)
+{
+    return reinterpret_cast<moonshine::displayfilter::FrameCache*>(cache)->countPixels(xs, ys, numPixels, width, height);
+}
+
+const void*
+FrameCache_acquire(intptr_t cache, const void* inBuffer, int width, int height, uint64_t pass)
+{
+    return reinterpret_cast<moonshine::displayfilter::FrameCache*>(cache)->acquire(inBuffer, width, height, pass);
+}
+
+void
+FrameCache_release(intptr_t cache)
+{
+    reinterpret_cast<moonshine::displayfilter::FrameCache*>(cache)->release();
+}
+}
+
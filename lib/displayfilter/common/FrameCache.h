@@ -0,0 +1,96 @@
+// Copyright 2023-2024 DreamWorks Animation LLC
+// SPDX-License-Identifier: Apache-2.0
+
+///
+/// @file FrameCache.h
+/// $Id$
+///
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <shared_mutex>
+
+namespace moonshine {
+namespace displayfilter {
+
+// Data a display filter derives from a whole frame of its input, such as a
+// summed area table, built by whichever thread first needs it in a pass
+// and then shared by every thread running the filter for the rest of that
+// pass. The data itself belongs to the filter, which fills it in from the
+// build function.
+//
+// Display filters are not told when a pass starts. So the filter reports
+// the pixels of every gang it runs, before any early out, with
+// countPixels(), and the pass a gang belongs to is the number of pixels
+// filtered before it divided by the frame size. That only holds while
+// every pass filters each output pixel of the frame exactly once, and
+// passes don't overlap, which region renders, skipped or re-filtered
+// tiles and re-runs for snapshots all break. So countPixels() also counts
+// how many times each pixel was filtered, and checks that this is the
+// pass it works out for every pixel of the gang. From the first pixel that
+// is not, it returns sNoPass until invalidate(), and the filter falls back
+// to computing its pixels from the input directly. See ispc/FrameCache.isph
+// for the ISPC side.
+class FrameCache
+{
+public:
+    // Fill the filter's data from a width x height input buffer and return
+    // a pointer to it. Called with the cache locked exclusively, inside an
+    // isolated task arena so that it may use TBB without the waiting thread
+    // picking up another gang of the filter, which would block on the lock.
+    using BuildFunc = std::function<const void*(const void* inBuffer, int width, int height)>;
+
+    // Returned by countPixels() once the passes can no longer be told apart
+    static constexpr uint64_t sNoPass = ~uint64_t(0);
+
+    explicit FrameCache(BuildFunc build);
+
+    // Count the numPixels output pixels (xs[i], ys[i]) of a width x height
+    // frame and return the pass they belong to, or sNoPass
+    uint64_t countPixels(const int* xs, const int* ys, int numPixels, int width, int height);
+
+    // Lock the cache shared and return its data, building it first if it
+    // was not built from this pass of a frame of this size. Returns
+    // nullptr, without locking, for sNoPass and if the data was already
+    // rebuilt for a later pass, in which case the filter must compute its
+    // pixels from the input. Every acquire() that returns data must be
+    // followed by a release().
+    const void* acquire(const void* inBuffer, int width, int height, uint64_t pass);
+    void release();
+
+    // Drop the data and restart the pass count. Called from update(), which
+    // never overlaps filtering.
+    void invalidate();
+
+private:
+    // Reallocate mFilterCounts for a width x height frame and restart the
+    // pass count, unless that was already done
+    void resize(int width, int height);
+
+    BuildFunc mBuild;
+
+    // Threads hold mMutex shared while counting pixels and reading the
+    // data, and exclusively while rebuilding the data or resizing the
+    // filter counts
+    std::shared_mutex mMutex;
+    std::atomic<uint64_t> mNumPixels;
+    // Times each pixel of a mCountWidth x mCountHeight frame was filtered
+    std::unique_ptr<std::atomic<uint32_t>[]> mFilterCounts;
+    int mCountWidth;
+    int mCountHeight;
+    // Set once a pixel was filtered other than once per pass
+    std::atomic<bool> mNoPass;
+
+    const void* mData;
+    int mWidth;
+    int mHeight;
+    uint64_t mPass;
+};
+
+} // namespace displayfilter
+} // namespace moonshine
+
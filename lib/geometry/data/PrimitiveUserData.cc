@@ -5,6 +5,10 @@
 
 #include "PrimitiveUserData.h"
 
+#include <tbb/parallel_for.h>
+
+#include <functional>
+
 using namespace moonray;
 using namespace moonray::geom;
 using namespace moonray::shading;
@@ -14,14 +18,84 @@ namespace geometry {
 
 #define INVALID_MESH_PART_INDEX -1
 
-template <class T>
+namespace {
+
+// The attributes made from one UserData, gathered away from the
+// PrimitiveAttributeTable so that UserData objects can be processed in
+// parallel, then added to the table in their original order
+class PendingAttributes
+{
+public:
+    // data is a std::vector<T>, or one std::vector<T> per motion sample
+    template <class T, class Data>
+    void
+    add(const scene_rdl2::rdl2::String& key, shading::AttributeRate rate, Data data)
+    {
+        mAdds.emplace_back([&key, rate, data = std::move(data)]
+                           (shading::PrimitiveAttributeTable& table) mutable {
+            table.addAttribute(shading::TypedAttributeKey<T>(key), rate, std::move(data));
+        });
+    }
+
+    void
+    commit(shading::PrimitiveAttributeTable& primitiveAttributeTable)
+    {
+        for (auto& add : mAdds) {
+            add(primitiveAttributeTable);
+        }
+    }
+
+private:
+    std::vector<std::function<void(shading::PrimitiveAttributeTable&)>> mAdds;
+};
+
+} // anonymous namespace
+
+// Process every UserData of arbitraryData with process(userData, pending),
+// in parallel, then add the attributes to primitiveAttributeTable in order
+template <class Process>
 static void
-addPrimitiveAttribute(shading::PrimitiveAttributeTable& primitiveAttributeTable,
+processInParallel(const scene_rdl2::rdl2::SceneObjectVector& arbitraryData,
+                  shading::PrimitiveAttributeTable& primitiveAttributeTable,
+                  const Process& process)
+{
+    std::vector<PendingAttributes> pending(arbitraryData.size());
+    tbb::parallel_for(size_t(0), arbitraryData.size(), [&](size_t i) {
+        const scene_rdl2::rdl2::UserData* userData =
+            arbitraryData[i]->asA<scene_rdl2::rdl2::UserData>();
+        if (userData) {
+            process(*userData, pending[i]);
+        }
+    });
+
+    for (PendingAttributes& attributes : pending) {
+        attributes.commit(primitiveAttributeTable);
+    }
+}
+
+template <class Values>
+static std::vector<std::vector<typename Values::value_type>>
+copySamples(const std::vector<const Values*>& samples)
+{
+    std::vector<std::vector<typename Values::value_type>> data;
+    data.reserve(samples.size());
+    for (const Values* values : samples) {
+        data.emplace_back(values->begin(), values->end());
+    }
+    return data;
+}
+
+// The UserData values are read in place, only the values this mesh uses are copied
+template <class Values>
+static void
+addPrimitiveAttribute(PendingAttributes& pending,
                       const scene_rdl2::rdl2::String& key,
                       const std::vector<int>& facesetPartIndices,
                       int meshPartIndex,
-                      std::vector<T>&& data)
+                      const Values& data)
 {
+    using T = typename Values::value_type;
+
     // Only constant and part rates are currently supported.  Higher rates will
     //  need additional attributes on the ABC object, such as the number of attribute elements
     //  per part... as the attribute data is just one big list and we would need to
@@ -30,9 +104,8 @@ addPrimitiveAttribute(shading::PrimitiveAttributeTable& primitiveAttributeTable,
         // One value is specified for the entire ABC geom.  Assume a constant rate on the mesh.
         //  Just assign the value to the attribute.  We don't care about the facesets or parts
         //  specified on the ABC "part names" attr.
-        primitiveAttributeTable.addAttribute(shading::TypedAttributeKey<T>(key),
-                                             shading::AttributeRate::RATE_CONSTANT,
-                                             std::move(data));
+        pending.add<T>(key, shading::AttributeRate::RATE_CONSTANT,
+                       std::vector<T>(data.begin(), data.end()));
     } else {
         // Multiple values are specified, so assume one value per part specified in the ABC's
         //  "part names" attr.
@@ -69,36 +142,33 @@ addPrimitiveAttribute(shading::PrimitiveAttributeTable& primitiveAttributeTable,
         }
 
         if (perPartData.size() == 1) {
-            primitiveAttributeTable.addAttribute(shading::TypedAttributeKey<T>(key),
-                                                 shading::AttributeRate::RATE_CONSTANT,
-                                                 std::move(perPartData));
+            pending.add<T>(key, shading::AttributeRate::RATE_CONSTANT, std::move(perPartData));
         } else {
-            primitiveAttributeTable.addAttribute(shading::TypedAttributeKey<T>(key),
-                                                 shading::AttributeRate::RATE_PART,
-                                                 std::move(perPartData));
+            pending.add<T>(key, shading::AttributeRate::RATE_PART, std::move(perPartData));
         }
     }
 }
 
-template <class T>
+// As above, with one set of values per motion sample
+template <class Values>
 static void
-addPrimitiveAttribute(shading::PrimitiveAttributeTable& primitiveAttributeTable,
+addPrimitiveAttribute(PendingAttributes& pending,
                       const scene_rdl2::rdl2::String& key,
                       const std::vector<int>& facesetPartIndices,
                       int meshPartIndex,
-                      std::vector<std::vector<T>>&& data)
+                      const std::vector<const Values*>& samples)
 {
+    using T = typename Values::value_type;
+
     // Only constant and part rates are currently supported.  Higher rates will
     //  need additional attributes on the ABC object, such as the number of attribute elements
     //  per part... as the attribute data is just one big list and we would need to
     //  know which block of values was for each part.
-    if (data[0].size() == 1) {
+    if (samples[0]->size() == 1) {
         // One value is specified for the entire ABC geom.  Assume a constant rate on the mesh.
         //  Just assign the value to the attribute.  We don't care about the facesets or parts
         //  specified on the ABC "part names" attr.
-        primitiveAttributeTable.addAttribute(shading::TypedAttributeKey<T>(key),
-                                             shading::AttributeRate::RATE_CONSTANT,
-                                             std::move(data));
+        pending.add<T>(key, shading::AttributeRate::RATE_CONSTANT, copySamples(samples));
     } else {
         // Multiple values are specified, so assume one value per part specified in the ABC's
         //  "part names" attr.
@@ -111,12 +181,13 @@ addPrimitiveAttribute(shading::PrimitiveAttributeTable& primitiveAttributeTable,
         //  Note that facesetPartIndices.size() == number of facesets on the current mesh
 
         // fill with default value for the type T
-        std::vector<std::vector<T>> perPartData(data.size(), std::vector<T>(facesetPartIndices.size(), T()));
-        for (size_t t = 0; t < data.size(); ++t) {
+        std::vector<std::vector<T>> perPartData(samples.size(), std::vector<T>(facesetPartIndices.size(), T()));
+        for (size_t t = 0; t < samples.size(); ++t) {
+            const Values& data = *samples[t];
             for (size_t i = 0; i < facesetPartIndices.size(); i++) {
                 // in part list and data is available?
-                if (facesetPartIndices[i] != -1 && (size_t)facesetPartIndices[i] < data[t].size()) {
-                    perPartData[t][i] = data[t][facesetPartIndices[i]];
+                if (facesetPartIndices[i] != -1 && (size_t)facesetPartIndices[i] < data.size()) {
+                    perPartData[t][i] = data[facesetPartIndices[i]];
                 } // else keep the default value
             }
 
@@ -125,12 +196,12 @@ addPrimitiveAttribute(shading::PrimitiveAttributeTable& primitiveAttributeTable,
             if (meshPartIndex != INVALID_MESH_PART_INDEX) {
                 // The mesh was specified in the global part list and thus has an index
                 //  into the attribute data array.
-                if (meshPartIndex < (int)data[t].size()) {
+                if (meshPartIndex < (int)data.size()) {
                     if (facesetPartIndices.size() == 1 && facesetPartIndices.front() == -1) {
                         // The mesh has no facesets in the part list
-                        perPartData[t].front() = data[t][meshPartIndex];
+                        perPartData[t].front() = data[meshPartIndex];
                     } else {
-                        perPartData[t].push_back(data[t][meshPartIndex]);
+                        perPartData[t].push_back(data[meshPartIndex]);
                     }
                 } else {
                     // The index is out of bounds of the data array, just use a default value.
@@ -144,13 +215,9 @@ addPrimitiveAttribute(shading::PrimitiveAttributeTable& primitiveAttributeTable,
         }
 
         if (perPartData[0].size() == 1) {
-            primitiveAttributeTable.addAttribute(shading::TypedAttributeKey<T>(key),
-                                                 shading::AttributeRate::RATE_CONSTANT,
-                                                 std::move(perPartData));
+            pending.add<T>(key, shading::AttributeRate::RATE_CONSTANT, std::move(perPartData));
         } else {
-            primitiveAttributeTable.addAttribute(shading::TypedAttributeKey<T>(key),
-                                                 shading::AttributeRate::RATE_PART,
-                                                 std::move(perPartData));
+            pending.add<T>(key, shading::AttributeRate::RATE_PART, std::move(perPartData));
         }
     }
 }
@@ -165,117 +232,100 @@ processMeshUserData(const scene_rdl2::rdl2::SceneObjectVector& arbitraryData,
 {
     // Similar to the RdlMesh code
 
-    for (auto sceneObject : arbitraryData) {
-        const scene_rdl2::rdl2::UserData* userData = sceneObject->asA<scene_rdl2::rdl2::UserData>();
-        if (!userData) {
-            continue;
-        }
-
-        if (userData->hasBoolData()) {
-            const scene_rdl2::rdl2::String& key = userData->getBoolKey();
-            // bool vector is a std::deque
-            const scene_rdl2::rdl2::BoolVector& constData = userData->getBoolValues();
-            std::vector<scene_rdl2::rdl2::Bool> data(constData.begin(), constData.end());
-            addPrimitiveAttribute(primitiveAttributeTable, key, partIndices, meshPartIndex, std::move(data));
+    processInParallel(arbitraryData, primitiveAttributeTable,
+                      [&](const scene_rdl2::rdl2::UserData& userData, PendingAttributes& pending) {
+        if (userData.hasBoolData()) {
+            const scene_rdl2::rdl2::String& key = userData.getBoolKey();
+            // bool vector is a std::deque, its values are gathered from it directly
+            addPrimitiveAttribute(pending, key, partIndices, meshPartIndex, userData.getBoolValues());
         }
 
-        if (userData->hasIntData()) {
-            const scene_rdl2::rdl2::String& key = userData->getIntKey();
-            scene_rdl2::rdl2::IntVector data = userData->getIntValues();
-            addPrimitiveAttribute(primitiveAttributeTable, key, partIndices, meshPartIndex, std::move(data));
+        if (userData.hasIntData()) {
+            const scene_rdl2::rdl2::String& key = userData.getIntKey();
+            addPrimitiveAttribute(pending, key, partIndices, meshPartIndex, userData.getIntValues());
         }
 
-        std::vector<scene_rdl2::rdl2::FloatVector> floatData;
-        if (userData->hasFloatData0() && useFirstFrame) {
-            const scene_rdl2::rdl2::FloatVector& data0 = userData->getFloatValues0();
-            floatData.push_back(data0);
+        std::vector<const scene_rdl2::rdl2::FloatVector*> floatData;
+        if (userData.hasFloatData0() && useFirstFrame) {
+            floatData.push_back(&userData.getFloatValues0());
         }
-        if (userData->hasFloatData1() && useSecondFrame) {
-            const scene_rdl2::rdl2::FloatVector& data1 = userData->getFloatValues1();
-            floatData.push_back(data1);
+        if (userData.hasFloatData1() && useSecondFrame) {
+            floatData.push_back(&userData.getFloatValues1());
         }
         if (!floatData.empty()) {
-            const scene_rdl2::rdl2::String& key = userData->getFloatKey();
-            addPrimitiveAttribute(primitiveAttributeTable, key, partIndices, meshPartIndex, std::move(floatData));
+            const scene_rdl2::rdl2::String& key = userData.getFloatKey();
+            addPrimitiveAttribute(pending, key, partIndices, meshPartIndex, floatData);
         }
 
-        if (userData->hasStringData()) {
-            const scene_rdl2::rdl2::String& key = userData->getStringKey();
-            scene_rdl2::rdl2::StringVector data = userData->getStringValues();
-            addPrimitiveAttribute(primitiveAttributeTable, key, partIndices, meshPartIndex, std::move(data));
+        if (userData.hasStringData()) {
+            const scene_rdl2::rdl2::String& key = userData.getStringKey();
+            addPrimitiveAttribute(pending, key, partIndices, meshPartIndex, userData.getStringValues());
         }
 
-        std::vector<scene_rdl2::rdl2::RgbVector> colorData;
-        if (userData->hasColorData0() && useFirstFrame) {
-            const scene_rdl2::rdl2::RgbVector& data0 = userData->getColorValues0();
-            colorData.push_back(data0);
+        std::vector<const scene_rdl2::rdl2::RgbVector*> colorData;
+        if (userData.hasColorData0() && useFirstFrame) {
+            colorData.push_back(&userData.getColorValues0());
         }
-        if (userData->hasColorData1() && useSecondFrame) {
-            const scene_rdl2::rdl2::RgbVector& data1 = userData->getColorValues1();
-            colorData.push_back(data1);
+        if (userData.hasColorData1() && useSecondFrame) {
+            colorData.push_back(&userData.getColorValues1());
         }
         if (!colorData.empty()) {
-            const scene_rdl2::rdl2::String& key = userData->getColorKey();
-            addPrimitiveAttribute(primitiveAttributeTable, key, partIndices, meshPartIndex, std::move(colorData));
+            const scene_rdl2::rdl2::String& key = userData.getColorKey();
+            addPrimitiveAttribute(pending, key, partIndices, meshPartIndex, colorData);
         }
 
-        std::vector<scene_rdl2::rdl2::Vec2fVector> vec2fData;
-        if (userData->hasVec2fData0() && useFirstFrame) {
-            const scene_rdl2::rdl2::Vec2fVector& data0 = userData->getVec2fValues();
-            vec2fData.push_back(data0);
+        std::vector<const scene_rdl2::rdl2::Vec2fVector*> vec2fData;
+        if (userData.hasVec2fData0() && useFirstFrame) {
+            vec2fData.push_back(&userData.getVec2fValues());
         }
-        if (userData->hasVec2fData1() && useSecondFrame) {
-            const scene_rdl2::rdl2::Vec2fVector& data1 = userData->getVec2fValues1();
-            vec2fData.push_back(data1);
+        if (userData.hasVec2fData1() && useSecondFrame) {
+            vec2fData.push_back(&userData.getVec2fValues1());
         }
         if (!vec2fData.empty()) {
-            const scene_rdl2::rdl2::String& key = userData->getVec2fKey();
-            addPrimitiveAttribute(primitiveAttributeTable, key, partIndices, meshPartIndex, std::move(vec2fData));
+            const scene_rdl2::rdl2::String& key = userData.getVec2fKey();
+            addPrimitiveAttribute(pending, key, partIndices, meshPartIndex, vec2fData);
         }
 
-        std::vector<scene_rdl2::rdl2::Vec3fVector> vec3fData;
-        if (userData->hasVec3fData0() && useFirstFrame) {
-            const scene_rdl2::rdl2::Vec3fVector& data0 = userData->getVec3fValues();
-            vec3fData.push_back(data0);
+        std::vector<const scene_rdl2::rdl2::Vec3fVector*> vec3fData;
+        if (userData.hasVec3fData0() && useFirstFrame) {
+            vec3fData.push_back(&userData.getVec3fValues());
         }
-        if (userData->hasVec3fData1() && useSecondFrame) {
-            const scene_rdl2::rdl2::Vec3fVector& data1 = userData->getVec3fValues1();
-            vec3fData.push_back(data1);
+        if (userData.hasVec3fData1() && useSecondFrame) {
+            vec3fData.push_back(&userData.getVec3fValues1());
         }
         if (!vec3fData.empty()) {
-            const scene_rdl2::rdl2::String& key = userData->getVec3fKey();
-            addPrimitiveAttribute(primitiveAttributeTable, key, partIndices, meshPartIndex, std::move(vec3fData));
+            const scene_rdl2::rdl2::String& key = userData.getVec3fKey();
+            addPrimitiveAttribute(pending, key, partIndices, meshPartIndex, vec3fData);
         }
 
-        std::vector<scene_rdl2::rdl2::Mat4fVector> mat4fData;
-        if (userData->hasMat4fData0() && useFirstFrame) {
-            const scene_rdl2::rdl2::Mat4fVector& data0 = userData->getMat4fValues();
-            mat4fData.push_back(data0);
+        std::vector<const scene_rdl2::rdl2::Mat4fVector*> mat4fData;
+        if (userData.hasMat4fData0() && useFirstFrame) {
+            mat4fData.push_back(&userData.getMat4fValues());
         }
-        if (userData->hasMat4fData1() && useSecondFrame) {
-            const scene_rdl2::rdl2::Mat4fVector& data1 = userData->getMat4fValues1();
-            mat4fData.push_back(data1);
+        if (userData.hasMat4fData1() && useSecondFrame) {
+            mat4fData.push_back(&userData.getMat4fValues1());
         }
         if (!mat4fData.empty()) {
-            const scene_rdl2::rdl2::String& key = userData->getMat4fKey();
-            addPrimitiveAttribute(primitiveAttributeTable, key, partIndices, meshPartIndex, std::move(mat4fData));
+            const scene_rdl2::rdl2::String& key = userData.getMat4fKey();
+            addPrimitiveAttribute(pending, key, partIndices, meshPartIndex, mat4fData);
         }
-    }
+    });
 }
 
-template <class T>
+template <class Values>
 static void
-addCurvesPrimitiveAttribute(shading::PrimitiveAttributeTable& primitiveAttributeTable,
+addCurvesPrimitiveAttribute(PendingAttributes& pending,
                             const scene_rdl2::rdl2::String& key,
                             const std::vector<std::string> * const partList,
                             const std::string& partName,
-                            std::vector<T>&& data)
+                            const Values& data)
 {
+    using T = typename Values::value_type;
+
     if (data.size() == 1) {
         // One value is specified for all of the curves.
-        primitiveAttributeTable.addAttribute(TypedAttributeKey<T>(key),
-                                             shading::AttributeRate::RATE_CONSTANT,
-                                             std::move(data));
+        pending.add<T>(key, shading::AttributeRate::RATE_CONSTANT,
+                       std::vector<T>(data.begin(), data.end()));
 
     } else if (partList != nullptr && partName != "" && partList->size() == data.size()) {
         // If the size of the part list matches the size of the data, try
@@ -283,55 +333,50 @@ addCurvesPrimitiveAttribute(shading::PrimitiveAttributeTable& primitiveAttribute
         // at the partName's index at constant rate.
         for (size_t j = 0; j < partList->size(); ++j) {
             if (partName == (*partList)[j]) {
-                primitiveAttributeTable.addAttribute(TypedAttributeKey<T>(key),
-                                                     shading::AttributeRate::RATE_CONSTANT,
-                                                     std::move(std::vector<T>(1, data[j])));
+                pending.add<T>(key, shading::AttributeRate::RATE_CONSTANT,
+                               std::vector<T>(1, data[j]));
             }
         }
 
     } else {
-        // One value is specified for each curve
-        primitiveAttributeTable.addAttribute(TypedAttributeKey<T>(key),
-                                             shading::AttributeRate::RATE_UNIFORM,
-                                             std::move(data));
+        // One value is specified for each curve.  The table owns its
+        // values, so this is the one case where all of them are copied.
+        pending.add<T>(key, shading::AttributeRate::RATE_UNIFORM,
+                       std::vector<T>(data.begin(), data.end()));
     }
 }
 
-template <class T>
+template <class Values>
 static void
-addCurvesPrimitiveAttribute(shading::PrimitiveAttributeTable& primitiveAttributeTable,
+addCurvesPrimitiveAttribute(PendingAttributes& pending,
                             const scene_rdl2::rdl2::String& key,
                             const std::vector<std::string> * const partList,
                             const std::string& partName,
-                            std::vector<std::vector<T>>&& data)
+                            const std::vector<const Values*>& samples)
 {
-    if (data[0].size() == 1) {
+    using T = typename Values::value_type;
+
+    if (samples[0]->size() == 1) {
         // One value is specified for all of the curves.
-        primitiveAttributeTable.addAttribute(TypedAttributeKey<T>(key),
-                                             shading::AttributeRate::RATE_CONSTANT,
-                                             std::move(data));
+        pending.add<T>(key, shading::AttributeRate::RATE_CONSTANT, copySamples(samples));
 
-    } else if (partList != nullptr && partName != "" && partList->size() == data[0].size()) {
+    } else if (partList != nullptr && partName != "" && partList->size() == samples[0]->size()) {
         // If the size of the part list matches the size of the data, try
         // to find the partName in the partList.   If found, add the data
         // at the partName's index at constant rate.
         for (size_t j = 0; j < partList->size(); ++j) {
             if (partName == (*partList)[j]) {
-                std::vector<std::vector<T>> perPartData(data.size(), std::vector<T>(1, T()));
-                for (size_t t = 0; t < data.size(); t++) {
-                    perPartData[t][0] = data[t][j];
+                std::vector<std::vector<T>> perPartData(samples.size(), std::vector<T>(1, T()));
+                for (size_t t = 0; t < samples.size(); t++) {
+                    perPartData[t][0] = (*samples[t])[j];
                 }
-                primitiveAttributeTable.addAttribute(TypedAttributeKey<T>(key),
-                                                     shading::AttributeRate::RATE_CONSTANT,
-                                                     std::move(perPartData));
+                pending.add<T>(key, shading::AttributeRate::RATE_CONSTANT, std::move(perPartData));
             }
         }
 
     } else {
         // One value is specified for each curve
-        primitiveAttributeTable.addAttribute(TypedAttributeKey<T>(key),
-                                             shading::AttributeRate::RATE_UNIFORM,
-                                             std::move(data));
+        pending.add<T>(key, shading::AttributeRate::RATE_UNIFORM, copySamples(samples));
     }
 }
 
@@ -342,6 +387,140 @@ processUserData(const scene_rdl2::rdl2::SceneObjectVector& arbitraryData,
                 bool useFirstFrame, bool useSecondFrame,
                 shading::PrimitiveAttributeTable& primitiveAttributeTable)
 {
+    processInParallel(arbitraryData, primitiveAttributeTable,
+                      [&](const scene_rdl2::rdl2::UserData& userData, PendingAttributes& pending) {
+        if (userData.hasBoolData()) {
+            const scene_rdl2::rdl2::String& key = userData.getBoolKey();
+            // bool vector is a std::deque, its values are gathered from it directly
+            addCurvesPrimitiveAttribute(pending, key, partList, partName, userData.getBoolValues());
+        }
+
+        if (userData.hasIntData()) {
+            const scene_rdl2::rdl2::String& key = userData.getIntKey();
+            addCurvesPrimitiveAttribute(pending, key, partList, partName, userData.getIntValues());
+        }
+
+        std::vector<const scene_rdl2::rdl2::FloatVector*> floatData;
+        if (userData.hasFloatData0() && useFirstFrame) {
+            floatData.push_back(&userData.getFloatValues0());
+        }
+        if (userData.hasFloatData1() && useSecondFrame) {
+            floatData.push_back(&userData.getFloatValues1());
+        }
+        if (!floatData.empty()) {
+            const scene_rdl2::rdl2::String& key = userData.getFloatKey();
+            addCurvesPrimitiveAttribute(pending, key, partList, partName, floatData);
+        }
+
+        if (userData.hasStringData()) {
+            const scene_rdl2::rdl2::String& key = userData.getStringKey();
+            addCurvesPrimitiveAttribute(pending, key, partList, partName, userData.getStringValues());
+        }
+
+        std::vector<const scene_rdl2::rdl2::RgbVector*> colorData;
+        if (userData.hasColorData0() && useFirstFrame) {
+            colorData.push_back(&userData.getColorValues0());
+        }
+        if (userData.hasColorData1()) {
+            colorData.push_back(&userData.getColorValues1());
+        }
+        if (!colorData.empty()) {
+            const scene_rdl2::rdl2::String& key = userData.getColorKey();
+            addCurvesPrimitiveAttribute(pending, key, partList, partName, colorData);
+        }
+
+        std::vector<const scene_rdl2::rdl2::Vec2fVector*> vec2fData;
+        if (userData.hasVec2fData0() && useFirstFrame) {
+            vec2fData.push_back(&userData.getVec2fValues());
+        }
+        if (userData.hasVec2fData1() && useSecondFrame) {
+            vec2fData.push_back(&userData.getVec2fValues1());
+        }
+        if (!vec2fData.empty()) {
+            const scene_rdl2::rdl2::String& key = userData.getVec2fKey();
+            addCurvesPrimitiveAttribute(pending, key, partList, partName, vec2fData);
+        }
+
+        std::vector<const scene_rdl2::rdl2::Vec3fVector*> vec3fData;
+        if (userData.hasVec3fData0() && useFirstFrame) {
+            vec3fData.push_back(&userData.getVec3fValues());
+        }
+        if (userData.hasVec3fData1() && useSecondFrame) {
+            vec3fData.push_back(&userData.getVec3fValues1());
+        }
+        if (!vec3fData.empty()) {
+            const scene_rdl2::rdl2::String& key = userData.getVec3fKey();
+            addCurvesPrimitiveAttribute(pending, key, partList, partName, vec3fData);
+        }
+
+        std::vector<const scene_rdl2::rdl2::Mat4fVector*> mat4fData;
+        if (userData.hasMat4fData0() && useFirstFrame) {
+            mat4fData.push_back(&userData.getMat4fValues());
+        }
+        if (userData.hasMat4fData1() && useSecondFrame) {
+            mat4fData.push_back(&userData.getMat4fValues1());
+        }
+        if (!mat4fData.empty()) {
+            const scene_rdl2::rdl2::String& key = userData.getMat4fKey();
+            addCurvesPrimitiveAttribute(pending, key, partList, partName, mat4fData);
+        }
+    });
+}
+
+template <class Values>
+static typename Values::value_type
+instanceValue(const Values& data, size_t instanceIndex)
+{
+    using T = typename Values::value_type;
+
+    if (data.size() == 1) {
+        // One value is specified for all of the instances
+        return data[0];
+    }
+    return instanceIndex < data.size() ? data[instanceIndex] : T();
+}
+
+template <class Values>
+static void
+addInstancePrimitiveAttribute(shading::PrimitiveAttributeTable& primitiveAttributeTable,
+                              const scene_rdl2::rdl2::String& key,
+                              size_t instanceIndex,
+                              const Values& data)
+{
+    using T = typename Values::value_type;
+
+    primitiveAttributeTable.addAttribute(TypedAttributeKey<T>(key),
+                                         shading::AttributeRate::RATE_CONSTANT,
+                                         std::vector<T>(1, instanceValue(data, instanceIndex)));
+}
+
+template <class Values>
+static void
+addInstancePrimitiveAttribute(shading::PrimitiveAttributeTable& primitiveAttributeTable,
+                              const scene_rdl2::rdl2::String& key,
+                              size_t instanceIndex,
+                              const std::vector<const Values*>& samples)
+{
+    using T = typename Values::value_type;
+
+    std::vector<std::vector<T>> data;
+    data.reserve(samples.size());
+    for (const Values* values : samples) {
+        data.emplace_back(1, instanceValue(*values, instanceIndex));
+    }
+    primitiveAttributeTable.addAttribute(TypedAttributeKey<T>(key),
+                                         shading::AttributeRate::RATE_CONSTANT,
+                                         std::move(data));
+}
+
+void
+processInstanceUserData(const scene_rdl2::rdl2::SceneObjectVector& arbitraryData,
+                        size_t instanceIndex,
+                        bool useFirstFrame, bool useSecondFrame,
+                        shading::PrimitiveAttributeTable& primitiveAttributeTable)
+{
+    // Called once per instance, usually from a parallel loop over the
+    // instances, so the UserData objects are processed serially here
     for (auto sceneObject : arbitraryData) {
         const scene_rdl2::rdl2::UserData* userData = sceneObject->asA<scene_rdl2::rdl2::UserData>();
         if (!userData) {
@@ -350,92 +529,77 @@ processUserData(const scene_rdl2::rdl2::SceneObjectVector& arbitraryData,
 
         if (userData->hasBoolData()) {
             const scene_rdl2::rdl2::String& key = userData->getBoolKey();
-            // bool vector is a std::deque
-            const scene_rdl2::rdl2::BoolVector& constData = userData->getBoolValues();
-            std::vector<scene_rdl2::rdl2::Bool> data(constData.begin(), constData.end());
-            addCurvesPrimitiveAttribute(primitiveAttributeTable, key, partList, partName, std::move(data));
+            addInstancePrimitiveAttribute(primitiveAttributeTable, key, instanceIndex, userData->getBoolValues());
         }
 
         if (userData->hasIntData()) {
             const scene_rdl2::rdl2::String& key = userData->getIntKey();
-            scene_rdl2::rdl2::IntVector data = userData->getIntValues();
-            addCurvesPrimitiveAttribute(primitiveAttributeTable, key, partList, partName, std::move(data));
+            addInstancePrimitiveAttribute(primitiveAttributeTable, key, instanceIndex, userData->getIntValues());
         }
 
-        std::vector<scene_rdl2::rdl2::FloatVector> floatData;
+        std::vector<const scene_rdl2::rdl2::FloatVector*> floatData;
         if (userData->hasFloatData0() && useFirstFrame) {
-            const scene_rdl2::rdl2::FloatVector& data0 = userData->getFloatValues0();
-            floatData.push_back(data0);
+            floatData.push_back(&userData->getFloatValues0());
         }
         if (userData->hasFloatData1() && useSecondFrame) {
-            const scene_rdl2::rdl2::FloatVector& data1 = userData->getFloatValues1();
-            floatData.push_back(data1);
+            floatData.push_back(&userData->getFloatValues1());
         }
         if (!floatData.empty()) {
             const scene_rdl2::rdl2::String& key = userData->getFloatKey();
-            addCurvesPrimitiveAttribute(primitiveAttributeTable, key, partList, partName, std::move(floatData));
+            addInstancePrimitiveAttribute(primitiveAttributeTable, key, instanceIndex, floatData);
         }
 
         if (userData->hasStringData()) {
             const scene_rdl2::rdl2::String& key = userData->getStringKey();
-            scene_rdl2::rdl2::StringVector data = userData->getStringValues();
-            addCurvesPrimitiveAttribute(primitiveAttributeTable, key, partList, partName, std::move(data));
+            addInstancePrimitiveAttribute(primitiveAttributeTable, key, instanceIndex, userData->getStringValues());
         }
 
-        std::vector<scene_rdl2::rdl2::RgbVector> colorData;
+        std::vector<const scene_rdl2::rdl2::RgbVector*> colorData;
         if (userData->hasColorData0() && useFirstFrame) {
-            const scene_rdl2::rdl2::RgbVector& data0 = userData->getColorValues0();
-            colorData.push_back(data0);
+            colorData.push_back(&userData->getColorValues0());
         }
-        if (userData->hasColorData1()) {
-            const scene_rdl2::rdl2::RgbVector& data1 = userData->getColorValues1();
-            colorData.push_back(data1);
+        if (userData->hasColorData1() && useSecondFrame) {
+            colorData.push_back(&userData->getColorValues1());
         }
         if (!colorData.empty()) {
             const scene_rdl2::rdl2::String& key = userData->getColorKey();
-            addCurvesPrimitiveAttribute(primitiveAttributeTable, key, partList, partName, std::move(colorData));
+            addInstancePrimitiveAttribute(primitiveAttributeTable, key, instanceIndex, colorData);
         }
 
-        std::vector<scene_rdl2::rdl2::Vec2fVector> vec2fData;
+        std::vector<const scene_rdl2::rdl2::Vec2fVector*> vec2fData;
         if (userData->hasVec2fData0() && useFirstFrame) {
-            const scene_rdl2::rdl2::Vec2fVector& data0 = userData->getVec2fValues();
-            vec2fData.push_back(data0);
+            vec2fData.push_back(&userData->getVec2fValues());
         }
         if (userData->hasVec2fData1() && useSecondFrame) {
-            const scene_rdl2::rdl2::Vec2fVector& data1 = userData->getVec2fValues1();
-            vec2fData.push_back(data1);
+            vec2fData.push_back(&userData->getVec2fValues1());
         }
         if (!vec2fData.empty()) {
             const scene_rdl2::rdl2::String& key = userData->getVec2fKey();
-            addCurvesPrimitiveAttribute(primitiveAttributeTable, key, partList, partName, std::move(vec2fData));
+            addInstancePrimitiveAttribute(primitiveAttributeTable, key, instanceIndex, vec2fData);
         }
 
-        std::vector<scene_rdl2::rdl2::Vec3fVector> vec3fData;
+        std::vector<const scene_rdl2::rdl2::Vec3fVector*> vec3fData;
         if (userData->hasVec3fData0() && useFirstFrame) {
-            const scene_rdl2::rdl2::Vec3fVector& data0 = userData->getVec3fValues();
-            vec3fData.push_back(data0);
+            vec3fData.push_back(&userData->getVec3fValues());
         }
         if (userData->hasVec3fData1() && useSecondFrame) {
-            const scene_rdl2::rdl2::Vec3fVector& data1 = userData->getVec3fValues1();
-            vec3fData.push_back(data1);
+            vec3fData.push_back(&userData->getVec3fValues1());
         }
         if (!vec3fData.empty()) {
             const scene_rdl2::rdl2::String& key = userData->getVec3fKey();
-            addCurvesPrimitiveAttribute(primitiveAttributeTable, key, partList, partName, std::move(vec3fData));
+            addInstancePrimitiveAttribute(primitiveAttributeTable, key, instanceIndex, vec3fData);
         }
 
-        std::vector<scene_rdl2::rdl2::Mat4fVector> mat4fData;
+        std::vector<const scene_rdl2::rdl2::Mat4fVector*> mat4fData;
         if (userData->hasMat4fData0() && useFirstFrame) {
-            const scene_rdl2::rdl2::Mat4fVector& data0 = userData->getMat4fValues();
-            mat4fData.push_back(data0);
+            mat4fData.push_back(&userData->getMat4fValues());
         }
         if (userData->hasMat4fData1() && useSecondFrame) {
-            const scene_rdl2::rdl2::Mat4fVector& data1 = userData->getMat4fValues1();
-            mat4fData.push_back(data1);
+            mat4fData.push_back(&userData->getMat4fValues1());
         }
         if (!mat4fData.empty()) {
             const scene_rdl2::rdl2::String& key = userData->getMat4fKey();
-            addCurvesPrimitiveAttribute(primitiveAttributeTable, key, partList, partName, std::move(mat4fData));
+            addInstancePrimitiveAttribute(primitiveAttributeTable, key, instanceIndex, mat4fData);
         }
     }
 }
@@ -26,6 +26,15 @@ processUserData(const scene_rdl2::rdl2::SceneObjectVector& arbitraryData,
                 bool useFirstFrame, bool useSecondFrame,
                 moonray::shading::PrimitiveAttributeTable& primitiveAttributeTable);
 
+// Add the values of instance instanceIndex, one value per UserData array
+// entry, as constant rate attributes. Arrays with a single value apply to
+// every instance, instances past the end of an array get a default value.
+void
+processInstanceUserData(const scene_rdl2::rdl2::SceneObjectVector& arbitraryData,
+                        size_t instanceIndex,
+                        bool useFirstFrame, bool useSecondFrame,
+                        moonray::shading::PrimitiveAttributeTable& primitiveAttributeTable);
+
 } // namespace geometry 
 } // namespace moonshine 
 
@@ -0,0 +1,96 @@
+// Copyright 2023-2024 DreamWorks Animation LLC
+// SPDX-License-Identifier: Apache-2.0
+
+///
+
+#include "ScatterInstances.h"
+#include "PrimitiveUserData.h"
+
+#include <moonray/rendering/geom/Api.h>
+
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+
+using namespace moonray;
+using namespace scene_rdl2::math;
+
+namespace moonshine {
+namespace geometry {
+
+namespace {
+
+// The value of instance i of an array that holds one value for every
+// instance, or one value per instance. Empty or short arrays give
+// defaultValue.
+template <class T>
+const T&
+arrayValue(const std::vector<T>& values, size_t i, const T& defaultValue)
+{
+    if (values.size() == 1) {
+        return values.front();
+    }
+    return i < values.size() ? values[i] : defaultValue;
+}
+
+} // anonymous namespace
+
+Xform3f
+scatterXform(const Vec3f& position, const Vec4f& orientation, const Vec3f& scale)
+{
+    const float len2 = dot(orientation, orientation);
+    const Vec4f q = len2 > 0.0f ? orientation / sqrt(len2) : Vec4f(0.0f, 0.0f, 0.0f, 1.0f);
+
+    const float xx = q.x * q.x, yy = q.y * q.y, zz = q.z * q.z;
+    const float xy = q.x * q.y, xz = q.x * q.z, yz = q.y * q.z;
+    const float xw = q.x * q.w, yw = q.y * q.w, zw = q.z * q.w;
+
+    // Row vectors, so each row is the image of a scaled basis vector
+    const Mat3f l(Vec3f(1.0f - 2.0f * (yy + zz), 2.0f * (xy + zw), 2.0f * (xz - yw)) * scale.x,
+                  Vec3f(2.0f * (xy - zw), 1.0f - 2.0f * (xx + zz), 2.0f * (yz + xw)) * scale.y,
+                  Vec3f(2.0f * (xz + yw), 2.0f * (yz - xw), 1.0f - 2.0f * (xx + yy)) * scale.z);
+    return Xform3f(l, position);
+}
+
+std::vector<std::unique_ptr<geom::Instance>>
+createScatterInstances(const std::vector<std::shared_ptr<geom::SharedPrimitive>>& prototypes,
+                       const scene_rdl2::rdl2::IntVector& prototypeIndices,
+                       const scene_rdl2::rdl2::Vec3fVector& positions,
+                       const scene_rdl2::rdl2::Vec4fVector& orientations,
+                       const scene_rdl2::rdl2::Vec3fVector& scales,
+                       const scene_rdl2::rdl2::SceneObjectVector& arbitraryData,
+                       bool useFirstFrame, bool useSecondFrame)
+{
+    std::vector<std::unique_ptr<geom::Instance>> instances(positions.size());
+
+    const int defaultIndex = 0;
+    const Vec4f identity(0.0f, 0.0f, 0.0f, 1.0f);
+    const Vec3f unitScale(1.0f);
+
+    // Instances only hold a reference to their prototype, the prototype's
+    // primitives and BVH are built once however many instances there are
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, positions.size()),
+                      [&](const tbb::blocked_range<size_t>& range) {
+        for (size_t i = range.begin(); i != range.end(); ++i) {
+            const int index = arrayValue(prototypeIndices, i, defaultIndex);
+            if (index < 0 || static_cast<size_t>(index) >= prototypes.size() || !prototypes[index]) {
+                continue;
+            }
+
+            const Xform3f xform = scatterXform(positions[i],
+                                               arrayValue(orientations, i, identity),
+                                               arrayValue(scales, i, unitScale));
+
+            shading::PrimitiveAttributeTable primitiveAttributeTable;
+            processInstanceUserData(arbitraryData, i, useFirstFrame, useSecondFrame,
+                                    primitiveAttributeTable);
+
+            instances[i] = geom::createInstance(xform, prototypes[index],
+                                                std::move(primitiveAttributeTable));
+        }
+    });
+
+    return instances;
+}
+
+} // namespace geometry
+} // namespace moonshine
@@ -0,0 +1,44 @@
+// Copyright 2023-2024 DreamWorks Animation LLC
+// SPDX-License-Identifier: Apache-2.0
+
+///
+
+#pragma once
+
+#include <scene_rdl2/scene/rdl2/rdl2.h>
+#include <moonray/rendering/geom/Instance.h>
+#include <moonray/rendering/geom/Primitive.h>
+#include <moonray/rendering/geom/SharedPrimitive.h>
+
+#include <memory>
+#include <vector>
+
+namespace moonshine {
+namespace geometry {
+
+// The transform of one scattered instance: scaled, then rotated by the
+// quaternion orientation (x, y, z imaginary, w real, need not be normalized),
+// then translated to position.
+scene_rdl2::math::Xform3f
+scatterXform(const scene_rdl2::math::Vec3f& position,
+             const scene_rdl2::math::Vec4f& orientation,
+             const scene_rdl2::math::Vec3f& scale);
+
+// Create one Instance of a shared prototype per entry of positions, in
+// parallel. The other arrays hold either a single value that applies to
+// every instance or one value per instance. Instances past the end of an
+// array, empty ones included, use prototype 0, no rotation and unit scale.
+// Instances of a missing (null or out of range) prototype are left null.
+// Each instance gets its own values of arbitraryData as constant rate
+// attributes, see processInstanceUserData().
+std::vector<std::unique_ptr<moonray::geom::Instance>>
+createScatterInstances(const std::vector<std::shared_ptr<moonray::geom::SharedPrimitive>>& prototypes,
+                       const scene_rdl2::rdl2::IntVector& prototypeIndices,
+                       const scene_rdl2::rdl2::Vec3fVector& positions,
+                       const scene_rdl2::rdl2::Vec4fVector& orientations,
+                       const scene_rdl2::rdl2::Vec3fVector& scales,
+                       const scene_rdl2::rdl2::SceneObjectVector& arbitraryData,
+                       bool useFirstFrame, bool useSecondFrame);
+
+} // namespace geometry
+} // namespace moonshine
@@ -0,0 +1,77 @@
+// Copyright 2023-2024 DreamWorks Animation LLC
+// SPDX-License-Identifier: Apache-2.0
+
+/// @file PointwiseMaps.cc
+
+#include "PointwiseMaps.h"
+
+#include <moonray/rendering/shading/ColorCorrect.h>
+#include <scene_rdl2/common/math/MathUtil.h>
+
+using namespace moonray::shading;
+using namespace scene_rdl2::math;
+
+namespace moonshine {
+namespace pointwise {
+
+namespace {
+
+Color
+mixColor(const Color& input, const Color& result, float mix)
+{
+    if (isEqual(mix, 1.0f)) {
+        return result;
+    }
+    return Color(lerpOpt(input.r, result.r, mix),
+                 lerpOpt(input.g, result.g, mix),
+                 lerpOpt(input.b, result.b, mix));
+}
+
+} // anonymous namespace
+
+Color
+constantColor(const Color& colorValue)
+{
+    return colorValue;
+}
+
+Color
+constantScalar(float scalarValue)
+{
+    return Color(scalarValue);
+}
+
+Color
+floatToRgb(float r, float g, float b)
+{
+    return Color(r, g, b);
+}
+
+bool
+isColorCorrectOff(bool on, float mix)
+{
+    return !on || isZero(mix);
+}
+
+Color
+colorCorrectGamma(const Color& input, float mix, const Color& gamma)
+{
+    const Color invGamma = Color(1.0f / max(sEpsilon, gamma.r),
+                                 1.0f / max(sEpsilon, gamma.g),
+                                 1.0f / max(sEpsilon, gamma.b));
+    Color result(input);
+    applyGamma(invGamma, result);
+    return mixColor(input, result, mix);
+}
+
+Color
+colorCorrectGainOffset(const Color& input, float mix, const Color& gain, const Color& offset)
+{
+    Color result(input);
+    applyGainAndOffset(gain, offset, result);
+    return mixColor(input, result, mix);
+}
+
+} // pointwise
+} // moonshine
+
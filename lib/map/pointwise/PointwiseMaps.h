@@ -0,0 +1,45 @@
+// Copyright 2023-2024 DreamWorks Animation LLC
+// SPDX-License-Identifier: Apache-2.0
+
+/// @file PointwiseMaps.h
+
+#pragma once
+
+#include <scene_rdl2/common/math/Color.h>
+
+namespace moonshine {
+namespace pointwise {
+
+// The kernels of the maps whose result only depends on their attribute
+// values. Each map's scalar sample function calls its kernel on the
+// evaluated attributes, and DwaBase calls them on attribute values it has
+// folded at update time (see DwaBase::foldAttributes()), so they must stay
+// the only copy of what these maps compute.
+
+// ConstantColorMap
+scene_rdl2::math::Color constantColor(const scene_rdl2::math::Color& colorValue);
+
+// ConstantScalarMap
+scene_rdl2::math::Color constantScalar(float scalarValue);
+
+// FloatToRgbMap
+scene_rdl2::math::Color floatToRgb(float r, float g, float b);
+
+// ColorCorrectGammaMap and ColorCorrectGainOffsetMap return their input
+// unchanged when this is true, without evaluating their other attributes
+bool isColorCorrectOff(bool on, float mix);
+
+// ColorCorrectGammaMap, when isColorCorrectOff() is false
+scene_rdl2::math::Color colorCorrectGamma(const scene_rdl2::math::Color& input,
+                                          float mix,
+                                          const scene_rdl2::math::Color& gamma);
+
+// ColorCorrectGainOffsetMap, when isColorCorrectOff() is false
+scene_rdl2::math::Color colorCorrectGainOffset(const scene_rdl2::math::Color& input,
+                                               float mix,
+                                               const scene_rdl2::math::Color& gain,
+                                               const scene_rdl2::math::Color& offset);
+
+} // pointwise
+} // moonshine
+
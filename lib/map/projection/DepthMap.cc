@@ -0,0 +1,124 @@
+// Copyright 2023-2024 DreamWorks Animation LLC
+// SPDX-License-Identifier: Apache-2.0
+
+//
+#include "DepthMap.h"
+#include "SharedRegistry.h"
+
+#include <OpenImageIO/imageio.h>
+
+#include <algorithm>
+
+namespace moonshine {
+namespace projection {
+
+using namespace scene_rdl2::math;
+
+namespace {
+
+using DepthMapRegistry = SharedRegistry<std::string, DepthMap>;
+
+DepthMapRegistry&
+getDepthMapRegistry()
+{
+    static DepthMapRegistry* sRegistry = new DepthMapRegistry;
+    return *sRegistry;
+}
+
+} // anonymous namespace
+
+bool
+DepthMap::load(const std::string& filename, std::string& errorMsg)
+{
+    auto in = OIIO::ImageInput::open(filename);
+    if (!in) {
+        errorMsg = "Unable to open depth map " + filename + ": " + OIIO::geterror();
+        return false;
+    }
+
+    const OIIO::ImageSpec& spec = in->spec();
+    if (spec.width <= 0 || spec.height <= 0 || spec.nchannels <= 0) {
+        errorMsg = "Depth map " + filename + " is empty";
+        return false;
+    }
+
+    int channel = 0;
+    for (int c = 0; c < spec.nchannels; ++c) {
+        if (spec.channelnames[c] == "Z" || spec.channelnames[c] == "depth") {
+            channel = c;
+            break;
+        }
+    }
+
+    // The full resolution level only, depth cannot be filtered before the
+    // compare
+    mDepths.resize(static_cast<size_t>(spec.width) * spec.height);
+    if (!in->read_image(0, 0, channel, channel + 1, OIIO::TypeDesc::FLOAT, mDepths.data())) {
+        errorMsg = "Unable to read depth map " + filename + ": " + in->geterror();
+        mDepths.clear();
+        return false;
+    }
+    in->close();
+
+    mIspc.mDepths = mDepths.data();
+    mIspc.mWidth = spec.width;
+    mIspc.mHeight = spec.height;
+    mPixelAspectRatio = spec.get_float_attribute("PixelAspectRatio", 1.0f);
+    return true;
+}
+
+float
+DepthMap::visibility(const Vec2f& st, float depth, float bias, int filterRadius) const
+{
+    if (st.x < 0.f || st.x > 1.f || st.y < 0.f || st.y > 1.f) {
+        return 1.f;
+    }
+
+    const int width = mIspc.mWidth;
+    const int height = mIspc.mHeight;
+    // Rows are top first, see PROJECTION_depthMapVisibility(), which must
+    // match BasicTexture's t = 0 at the top row
+    const int x = std::min(static_cast<int>(st.x * width), width - 1);
+    const int y = std::min(static_cast<int>(st.y * height), height - 1);
+    const float biasedDepth = depth - bias;
+
+    // Percentage closer filtering, the taps are clamped to the edges
+    int visible = 0;
+    for (int dy = -filterRadius; dy <= filterRadius; ++dy) {
+        const int row = std::clamp(y + dy, 0, height - 1) * width;
+        for (int dx = -filterRadius; dx <= filterRadius; ++dx) {
+            const int column = std::clamp(x + dx, 0, width - 1);
+            if (mDepths[row + column] >= biasedDepth) {
+                ++visible;
+            }
+        }
+    }
+
+    const int size = 2 * filterRadius + 1;
+    return static_cast<float>(visible) / static_cast<float>(size * size);
+}
+
+bool
+acquireDepthMap(const std::string& filename,
+                std::shared_ptr<DepthMap>& depthMap,
+                std::string& errorMsg)
+{
+    DepthMapRegistry& registry = getDepthMapRegistry();
+    depthMap = registry.find(filename);
+    if (depthMap) {
+        return true;
+    }
+
+    // Load without holding the lock, two shaders may load the same file at
+    // once, only one of them is kept
+    std::unique_ptr<DepthMap> loaded = std::make_unique<DepthMap>();
+    if (!loaded->load(filename, errorMsg)) {
+        depthMap.reset();
+        return false;
+    }
+    depthMap = registry.insert(filename, std::move(loaded));
+    return true;
+}
+
+} // projection
+} // moonshine
@@ -0,0 +1,61 @@
+// Copyright 2023-2024 DreamWorks Animation LLC
+// SPDX-License-Identifier: Apache-2.0
+
+
+#pragma once
+
+#include <scene_rdl2/common/math/Vec2.h>
+
+#include "DepthMap_ispc_stubs.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace moonshine  {
+namespace projection  {
+
+// A depth map seen from a projector, loaded from the first channel named
+// "Z" or "depth", or else the first channel, of an image file. Each texel
+// holds the depth of the nearest surface along the projector's viewing
+// axis, that is -z in the projector's camera space, as rendered by a depth
+// AOV from the projector camera. It is not the distance along the ray from
+// the projector, which grows towards the edges of the frame.
+class DepthMap
+{
+public:
+    bool load(const std::string& filename, std::string& errorMsg);
+
+    const ispc::PROJECTION_DepthMap& getIspc() const { return mIspc; }
+
+    // Width over height of the image, including its pixel aspect ratio
+    float getAspectRatio() const
+    {
+        return static_cast<float>(mIspc.mWidth) * mPixelAspectRatio / mIspc.mHeight;
+    }
+
+    // Shadow map style visibility of a point at depth along the projector's
+    // viewing axis, that projects to st: the fraction of the
+    // (2 * filterRadius + 1)^2 texels around st whose depth is not in front
+    // of depth - bias. Points outside of the depth map are visible.
+    float visibility(const scene_rdl2::math::Vec2f& st,
+                     float depth,
+                     float bias,
+                     int filterRadius) const;
+
+private:
+    std::vector<float> mDepths;
+    float mPixelAspectRatio = 1.0f;
+    ispc::PROJECTION_DepthMap mIspc {};
+};
+
+// Returns the depth map of filename, shared with every other shader that
+// asked for the same file and still holds it. Fails, with errorMsg set, if
+// the file cannot be read.
+bool
+acquireDepthMap(const std::string& filename,
+                std::shared_ptr<DepthMap>& depthMap,
+                std::string& errorMsg);
+
+} // projection
+} // moonshine
@@ -3,6 +3,7 @@
 
 //
 #include "ProjectionUtil.h"
+#include "XformRegistry.h"
 
 #include <moonray/common/mcrt_macros/moonray_static_check.h>
 #include <moonray/common/mcrt_util/Atomic.h>
@@ -58,7 +59,7 @@ initLogEvents(ispc::PROJECTION_StaticData& staticData,
     MOONRAY_FINISH_THREADSAFE_STATIC_WRITE
 }
 
-std::unique_ptr<moonray::shading::Xform>
+std::shared_ptr<moonray::shading::Xform>
 getProjectorXform(const scene_rdl2::rdl2::SceneObject *shader,
                   const ispc::PROJECTION_Mode projectionMode,
                   const scene_rdl2::rdl2::SceneObject* projectorObject,
@@ -73,11 +74,11 @@ getProjectorXform(const scene_rdl2::rdl2::SceneObject *shader,
     case ispc::PROJECTION_MODE_PROJECTOR:
         if (projectorObject != nullptr) {
             const scene_rdl2::rdl2::Node* projectorNode = projectorObject->asA<scene_rdl2::rdl2::Node>();
-            return std::make_unique<moonray::shading::Xform>(shader, projectorNode, nullptr, nullptr);
+            return acquireXform(shader, projectorNode, nullptr, nullptr);
         }
         break;
     case ispc::PROJECTION_MODE_MATRIX:
-        return std::make_unique<moonray::shading::Xform>(shader, projectionMatrix);
+        return acquireXform(shader, projectionMatrix);
         break;
     case ispc::PROJECTION_MODE_TRS:
         Xform3d rot(scene_rdl2::math::one);
@@ -149,7 +150,7 @@ getProjectorXform(const scene_rdl2::rdl2::SceneObject *shader,
         }
 
         Mat4d projectionMatrix(transform);
-        return std::make_unique<moonray::shading::Xform>(shader, projectionMatrix);
+        return acquireXform(shader, projectionMatrix);
     }
 
     return nullptr;
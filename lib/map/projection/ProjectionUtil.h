@@ -19,7 +19,9 @@ initLogEvents(ispc::PROJECTION_StaticData& staticData,
               scene_rdl2::rdl2::ShaderLogEventRegistry& logEventRegistry,
               const scene_rdl2::rdl2::Shader * shader);
 
-std::unique_ptr<moonray::shading::Xform>
+// The projector transforms for the projection mode, shared through
+// acquireXform() (see XformRegistry.h), or null if there is no projector
+std::shared_ptr<moonray::shading::Xform>
 getProjectorXform(const scene_rdl2::rdl2::SceneObject *shader,
                   const ispc::PROJECTION_Mode projectionMode,
                   const scene_rdl2::rdl2::SceneObject* projectorObject,
@@ -0,0 +1,68 @@
+// Copyright 2023-2024 DreamWorks Animation LLC
+// SPDX-License-Identifier: Apache-2.0
+
+
+#pragma once
+
+#include <map>
+#include <memory>
+#include <mutex>
+
+namespace moonshine  {
+namespace projection  {
+
+// A map from Key to objects shared between every holder of the same key.
+// The registry only keeps weak references, an entry is erased when its last
+// holder lets go of the object. Registries are meant to be function statics
+// that are never destroyed, objects may be released after static
+// destruction has begun.
+template <typename Key, typename T>
+class SharedRegistry
+{
+public:
+    std::shared_ptr<T>
+    find(const Key& key)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        const auto it = mObjects.find(key);
+        return it == mObjects.end() ? nullptr : it->second.lock();
+    }
+
+    // Share object under key, unless another thread got there first, in
+    // which case its object is returned instead
+    std::shared_ptr<T>
+    insert(const Key& key, std::unique_ptr<T> object)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        std::weak_ptr<T>& entry = mObjects[key];
+        std::shared_ptr<T> shared = entry.lock();
+        if (!shared) {
+            shared.reset(object.release(),
+                         [this, key](T* t) {
+                             release(key);
+                             delete t;
+                         });
+            entry = shared;
+        }
+        return shared;
+    }
+
+private:
+    void
+    release(const Key& key)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        // The entry may already hold a newer object for the same key
+        const auto it = mObjects.find(key);
+        if (it != mObjects.end() && it->second.expired()) {
+            mObjects.erase(it);
+        }
+    }
+
+    std::mutex mMutex;
+    std::map<Key, std::weak_ptr<T>> mObjects;
+};
+
+} // projection
+} // moonshine
+
@@ -6,6 +6,7 @@
 #include "ProjectionUtil.h"
 #include <scene_rdl2/render/util/Random.h>
 
+#include <cstring>
 #include <memory>
 
 #define BLEND_EPSILON 0.0005f
@@ -276,6 +277,7 @@ updateTriplanarMap(scene_rdl2::rdl2::Shader* map,
                    const bool randomizeOffset,
                    const bool randomizeRotation,
                    const float transitionWidth,
+                   const bool singleFaceSecondary,
                    const int numTextures,
                    const scene_rdl2::rdl2::SceneObject* projectorObject,
                    const ispc::PROJECTION_Mode projectionMode,
@@ -290,7 +292,7 @@ updateTriplanarMap(scene_rdl2::rdl2::Shader* map,
                    scene_rdl2::rdl2::ShaderLogEventRegistry& logEventRegistry,
                    ispc::PROJECTION_TriplanarData& outputIspcData,
                    std::array<std::unique_ptr<projection::TriplanarTexture>, 6>& outputTriplanarTextures,
-                   std::unique_ptr<moonray::shading::Xform>& outputProjectorXform)
+                   std::shared_ptr<moonray::shading::Xform>& outputProjectorXform)
 {
     scene_rdl2::util::Random rand(randomSeed);
 
@@ -330,6 +332,7 @@ updateTriplanarMap(scene_rdl2::rdl2::Shader* map,
     // exponent for the normal blending, for an intuitive feel from 0..1
     outputIspcData.mTransitionWidthPower = 
         projection::calculateTransitionWidthPower(transitionWidth);
+    outputIspcData.mSingleFaceSecondary = singleFaceSecondary;
 
     outputIspcData.mHasValidProjector = false;
     outputIspcData.mProjectorXform = nullptr;
@@ -348,12 +351,74 @@ updateTriplanarMap(scene_rdl2::rdl2::Shader* map,
     }
 }
 
+Vec3f
+selectTriplanarAxis(const Vec3f& pos,
+                    const Vec3f& blending)
+{
+    // Hash the position into a number in [0, 1). This is stable for a given
+    // point, but decorrelated between neighboring points.
+    uint32_t bits[3];
+    std::memcpy(bits, &pos, sizeof(bits));
+    uint32_t h = (bits[0] * 73856093u) ^ (bits[1] * 19349663u) ^ (bits[2] * 83492791u);
+    h ^= h >> 16;
+    h *= 0x7feb352du;
+    h ^= h >> 15;
+    h *= 0x846ca68bu;
+    h ^= h >> 16;
+    const float u = static_cast<float>(h >> 8) * (1.0f / 16777216.0f);
+
+    if (u < blending.x) {
+        return Vec3f(1.0f, 0.0f, 0.0f);
+    } else if (u < blending.x + blending.y) {
+        return Vec3f(0.0f, 1.0f, 0.0f);
+    } else {
+        return Vec3f(0.0f, 0.0f, 1.0f);
+    }
+}
+
+namespace {
+
+// Project pos onto a cube face and apply the face's 2D texture transform,
+// giving the st coordinates and derivatives to sample its texture with
+void
+projectTriplanarFace(const int cubeface,
+                     const Xform3f& xform,
+                     const Vec3f& pos,
+                     const Vec3f& pos_ddx,
+                     const Vec3f& pos_ddy,
+                     const Vec3f& pos_ddz,
+                     Vec2f& st,
+                     float (&derivatives)[4])
+{
+    // Get our position w/ partial derivs as projected onto this cube face
+    Vec3f U, dUdx, dUdy, dUdz;
+    projection::swizzleTriplanarFace(pos, pos_ddx, pos_ddy, pos_ddz,
+                                     cubeface,
+                                     U, dUdx, dUdy, dUdz);
+
+    // apply our 2D texture transform, while the center is (0, 0)
+    U = transformPoint(xform, U);
+    dUdx = transformVector(xform, dUdx);
+    dUdy = transformVector(xform, dUdy);
+
+    // offset point so center is (0.5, 0.5)
+    st = Vec2f(U.x + 0.5f, U.y + 0.5f);
+
+    derivatives[0] = dUdx.x; // dsdx
+    derivatives[1] = dUdx.y; // dtdx
+    derivatives[2] = dUdy.x; // dsdy
+    derivatives[3] = dUdy.y; // dtdy
+}
+
+} // anonymous namespace
+
 void
 fillTriplanarTextures(moonray::shading::TLState* tls,
                       const moonray::shading::State& state, 
                       const int* textureIndices,
                       const std::array<std::unique_ptr<TriplanarTexture>, 6>& outputTriplanarTextures,
                       const float transitionWidthPower,
+                      const bool singleFace,
                       const Vec3f& normal,
                       const Vec3f& pos,
                       const Vec3f& pos_ddx,
@@ -364,43 +429,32 @@ fillTriplanarTextures(moonray::shading::TLState* tls,
 {
     outputBlending = calculateTriplanarBlending(normal,
                                                 transitionWidthPower);
+    if (singleFace) {
+        outputBlending = selectTriplanarAxis(pos, outputBlending);
+    }
 
+    // Only the face on the side of each axis that the normal points to is
+    // visible, so it is chosen before any texture lookup.
     // As an optimization, if the outputBlending value for an axis is less
     // than BLEND_EPSILON we skip it to avoid the expensive texture
     // lookup.  The value was chosen to minimize the difference with
     // the non-optimized version.   Values at or lower than 0.0005f
     // show no difference with r_diff.
-    for (size_t cubeface = 0; cubeface < 6; ++cubeface) {
-        outputColors[cubeface] = Color(0.f, 0.f, 0.f);
-
-        if  (((cubeface == 0 || cubeface == 3) && (outputBlending.x < BLEND_EPSILON)) ||
-             ((cubeface == 1 || cubeface == 4) && (outputBlending.y < BLEND_EPSILON)) ||
-             ((cubeface == 2 || cubeface == 5) && (outputBlending.z < BLEND_EPSILON))) continue;
-
-        // Get our position w/ partial derivs as projected onto this cube face
-        Vec3f U, dUdx, dUdy, dUdz;
-        projection::swizzleTriplanarFace(pos, pos_ddx, pos_ddy, pos_ddz,
-                                         cubeface,
-                                         U, dUdx, dUdy, dUdz);
+    for (int axis = 0; axis < 3; ++axis) {
+        outputColors[axis] = Color(0.f, 0.f, 0.f);
+        if (outputBlending[axis] < BLEND_EPSILON) continue;
 
-        // apply our 2D texture transform, while the center is (0, 0)
+        const int cubeface = (normal[axis] > 0.0f) ? axis : axis + 3;
         const int index = textureIndices[cubeface];
-        const Xform3f &xform = outputTriplanarTextures[index]->m2DXform;
-        U = transformPoint(xform, U);
-        dUdx = transformVector(xform, dUdx);
-        dUdy = transformVector(xform, dUdy);
-
-        // offset point so center is (0.5, 0.5)
-        const Vec2f st(U.x + 0.5f, U.y + 0.5f);
 
+        Vec2f st;
         float derivatives[4];
-        derivatives[0] = dUdx.x; // dsdx
-        derivatives[1] = dUdx.y; // dtdx
-        derivatives[2] = dUdy.x; // dsdy
-        derivatives[3] = dUdy.y; // dtdy
+        projectTriplanarFace(cubeface, outputTriplanarTextures[index]->m2DXform,
+                             pos, pos_ddx, pos_ddy, pos_ddz,
+                             st, derivatives);
 
         // Sample the texture
-        outputColors[cubeface] = outputTriplanarTextures[index]->sample(st, derivatives, tls, state);
+        outputColors[axis] = outputTriplanarTextures[index]->sample(st, derivatives, tls, state);
     }
 }
 
@@ -411,6 +465,7 @@ fillTriplanarNormalTextures(const int normalMapEncoding,
                             const int* textureIndices,
                             const std::array<std::unique_ptr<TriplanarTexture>, 6>& outputTriplanarTextures,
                             const float transitionWidthPower,
+                            const bool singleFace,
                             const Vec3f& normal,
                             const Vec3f& pos,
                             const Vec3f& pos_ddx,
@@ -422,56 +477,51 @@ fillTriplanarNormalTextures(const int normalMapEncoding,
 {
     outputBlending = calculateTriplanarBlending(normal,
                                                 transitionWidthPower);
+    if (singleFace) {
+        outputBlending = selectTriplanarAxis(pos, outputBlending);
+    }
 
+    bool reversedNormals = false;
+    if (state.isProvided(moonray::shading::StandardAttributes::sReversedNormals)) {
+        reversedNormals = state.getAttribute(moonray::shading::StandardAttributes::sReversedNormals);
+    }
+
+    // Only the face on the side of each axis that the normal points to is
+    // visible, so it is chosen before any texture lookup.
     // As an optimization, if the outputBlending value for an axis is less
     // than BLEND_EPSILON we skip it to avoid the expensive texture
     // lookup.  The value was chosen to minimize the difference with
     // the non-optimized version.   Values at or lower than 0.0005f
     // show no difference with r_diff.
-    for (size_t cubeface = 0; cubeface < 6; ++cubeface) {
-        outputNormals[cubeface] = normal;
-        if  (((cubeface == 0 || cubeface == 3) && (outputBlending.x < BLEND_EPSILON)) ||
-             ((cubeface == 1 || cubeface == 4) && (outputBlending.y < BLEND_EPSILON)) ||
-             ((cubeface == 2 || cubeface == 5) && (outputBlending.z < BLEND_EPSILON))) {
+    for (int axis = 0; axis < 3; ++axis) {
+        outputNormals[axis] = normal;
+        if (outputBlending[axis] < BLEND_EPSILON) {
             // Initialize value to state normal length so we don't get NaNs.
-            outputNormalLengths[cubeface] = 1.f;
+            outputNormalLengths[axis] = 1.f;
             continue;
         }
 
-        // Get 'U', our position w/ partial derivs as projected onto this cube face
-        Vec3f U, dUdx, dUdy, dUdz;
-        projection::swizzleTriplanarFace(pos, pos_ddx, pos_ddy, pos_ddz,
-                                         cubeface,
-                                         U, dUdx, dUdy, dUdz);
-
-        // apply our 2D texture transform, while the center is (0, 0)
+        const int cubeface = (normal[axis] > 0.0f) ? axis : axis + 3;
         const int index = textureIndices[cubeface];
-        const Xform3f &xform = outputTriplanarTextures[index]->m2DXform;
-        U = transformPoint(xform, U);
-        dUdx = transformVector(xform, dUdx);
-        dUdy = transformVector(xform, dUdy);
-
-        // offset point so center is (0.5, 0.5)
-        const Vec2f st(U.x + 0.5f, U.y + 0.5f);
 
+        Vec2f st;
         float derivatives[4];
-        derivatives[0] = dUdx.x; // dsdx
-        derivatives[1] = dUdx.y; // dtdx
-        derivatives[2] = dUdy.x; // dsdy
-        derivatives[3] = dUdy.y; // dtdy
+        projectTriplanarFace(cubeface, outputTriplanarTextures[index]->m2DXform,
+                             pos, pos_ddx, pos_ddy, pos_ddz,
+                             st, derivatives);
 
         // Sample the texture
         Color tx = outputTriplanarTextures[index]->sample(st, derivatives, tls, state);
 
         Vec3f tNormal =  Vec3f(tx.r, tx.g, tx.b);
-        outputNormalLengths[cubeface] = length(tNormal);
+        outputNormalLengths[axis] = length(tNormal);
 
         // Remap the normals from the texture texture map (which, by default,
         // are assumed to be in the 0 to 1 range) to the -1 to 1 range.
         if (normalMapEncoding == 0) { // [0,1]
             tNormal = 2.0f * Vec3f(tx.r, tx.g, tx.b) - Vec3f(1.0f);
-            outputNormalLengths[cubeface] = length(tNormal);
-            tNormal = tNormal / outputNormalLengths[cubeface]; // normalize
+            outputNormalLengths[axis] = length(tNormal);
+            tNormal = tNormal / outputNormalLengths[axis]; // normalize
         }
 
         // projector object-space tangent
@@ -497,10 +547,6 @@ fillTriplanarNormalTextures(const int normalMapEncoding,
             break;
         }
 
-        bool reversedNormals = false;
-        if (state.isProvided(moonray::shading::StandardAttributes::sReversedNormals)) {
-            reversedNormals = state.getAttribute(moonray::shading::StandardAttributes::sReversedNormals);
-        }
         if (reversedNormals) {
             tangent *= -1.0f;
         }
@@ -508,11 +554,10 @@ fillTriplanarNormalTextures(const int normalMapEncoding,
         // projector object-space ReferenceFrame
         ReferenceFrame frame(normal, tangent);
 
-        outputNormals[cubeface] = frame.localToGlobal(tNormal);
+        outputNormals[axis] = frame.localToGlobal(tNormal);
     }
 }
 
-
 } // projection
 } // moonshine
 
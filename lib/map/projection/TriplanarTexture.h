@@ -103,6 +103,11 @@ float calculateTransitionWidthPower(float transitionWidth);
 scene_rdl2::math::Vec3f calculateTriplanarBlending(const scene_rdl2::math::Vec3f& normal,
                                               float twp);
 
+// Pick one axis at random, with probability equal to its blend weight,
+// and return blending that puts all the weight on it
+scene_rdl2::math::Vec3f selectTriplanarAxis(const scene_rdl2::math::Vec3f& pos,
+                                            const scene_rdl2::math::Vec3f& blending);
+
 void fillTriplanarTextureIndices(const int numTextures, int (&indexArray)[6]);
 
 // Inputs:
@@ -146,6 +151,7 @@ void updateTriplanarMap(scene_rdl2::rdl2::Shader* map,
                         const bool randomizeOffset,
                         const bool randomizeRotation,
                         const float transitionWidth,
+                        const bool singleFaceSecondary,
                         const int numTextures,
                         const scene_rdl2::rdl2::SceneObject* projectorObject,
                         const ispc::PROJECTION_Mode projectionMode,
@@ -160,13 +166,17 @@ void updateTriplanarMap(scene_rdl2::rdl2::Shader* map,
                         scene_rdl2::rdl2::ShaderLogEventRegistry& logEventRegistry,
                         ispc::PROJECTION_TriplanarData& outputIspcData,
                         std::array<std::unique_ptr<projection::TriplanarTexture>, 6>& outputTriplanarTextures,
-                        std::unique_ptr<moonray::shading::Xform>& outputProjectorXform);
+                        std::shared_ptr<moonray::shading::Xform>& outputProjectorXform);
 
+// The outputs hold one entry per axis, sampled from the face of that axis
+// which the normal points to. If singleFace is true, only one axis, picked
+// by selectTriplanarAxis(), is sampled and given all of the blending.
 void fillTriplanarTextures(moonray::shading::TLState* tls,
                            const moonray::shading::State& state, 
                            const int* textureIndices,
                            const std::array<std::unique_ptr<TriplanarTexture>, 6>& outputTriplanarTextures,
                            const float transitionWidthPower,
+                           const bool singleFace,
                            const scene_rdl2::math::Vec3f& normal,
                            const scene_rdl2::math::Vec3f& pos,
                            const scene_rdl2::math::Vec3f& pos_ddx,
@@ -181,6 +191,7 @@ void fillTriplanarNormalTextures(const int normalMapEncoding,
                                  const int* textureIndices,
                                  const std::array<std::unique_ptr<TriplanarTexture>, 6>& outputTriplanarTextures,
                                  const float transitionWidthPower,
+                                 const bool singleFace,
                                  const scene_rdl2::math::Vec3f& normal,
                                  const scene_rdl2::math::Vec3f& pos,
                                  const scene_rdl2::math::Vec3f& pos_ddx,
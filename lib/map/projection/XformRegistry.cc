@@ -0,0 +1,226 @@
+// Copyright 2023-2024 DreamWorks Animation LLC
+// SPDX-License-Identifier: Apache-2.0
+
+//
+#include "XformRegistry.h"
+#include "SharedRegistry.h"
+
+#include <scene_rdl2/common/math/Viewport.h>
+
+#include <algorithm>
+#include <tuple>
+#include <vector>
+
+namespace moonshine {
+namespace projection {
+
+using namespace scene_rdl2::math;
+
+namespace {
+
+struct XformKey
+{
+    const scene_rdl2::rdl2::SceneContext* mContext;
+    const scene_rdl2::rdl2::Node* mNode;
+    const scene_rdl2::rdl2::Camera* mCamera;
+    const scene_rdl2::rdl2::Camera* mPrimaryCamera;
+    bool mHasWindow;
+    float mWindow[4];
+    bool mHasProjectionMatrix;
+    // The world transforms of the node at both motion steps, the attributes
+    // of the camera and the primary camera, the scene's resolution and
+    // windows, then the projection matrix, if any
+    std::vector<double> mValues;
+
+    bool operator<(const XformKey& other) const
+    {
+        return std::tie(mContext, mNode, mCamera, mPrimaryCamera, mHasWindow,
+                        mWindow[0], mWindow[1], mWindow[2], mWindow[3],
+                        mHasProjectionMatrix, mValues) <
+               std::tie(other.mContext, other.mNode, other.mCamera, other.mPrimaryCamera,
+                        other.mHasWindow,
+                        other.mWindow[0], other.mWindow[1], other.mWindow[2], other.mWindow[3],
+                        other.mHasProjectionMatrix, other.mValues);
+    }
+};
+
+using XformRegistry = SharedRegistry<XformKey, moonray::shading::Xform>;
+
+XformRegistry&
+getXformRegistry()
+{
+    static XformRegistry* sRegistry = new XformRegistry;
+    return *sRegistry;
+}
+
+void
+appendMatrix(std::vector<double>& values, const Mat4d& m)
+{
+    for (const Vec4d* row : { &m.vx, &m.vy, &m.vz, &m.vw }) {
+        values.insert(values.end(), { row->x, row->y, row->z, row->w });
+    }
+}
+
+void
+appendNodeXform(std::vector<double>& values, const scene_rdl2::rdl2::Node* node)
+{
+    if (node) {
+        appendMatrix(values, node->get(scene_rdl2::rdl2::Node::sNodeXformKey,
+                                        scene_rdl2::rdl2::TIMESTEP_BEGIN));
+        appendMatrix(values, node->get(scene_rdl2::rdl2::Node::sNodeXformKey,
+                                        scene_rdl2::rdl2::TIMESTEP_END));
+    }
+}
+
+template <typename T>
+T
+getValue(const scene_rdl2::rdl2::SceneObject* object,
+         const scene_rdl2::rdl2::Attribute& attr,
+         const scene_rdl2::rdl2::AttributeTimestep timestep)
+{
+    const scene_rdl2::rdl2::AttributeKey<T> key(attr);
+    return attr.isBlurrable() ? object->get(key, timestep) : object->get(key);
+}
+
+// Append the value of every numeric attribute of camera, which covers its
+// transform and whatever lens and projection attributes its class has,
+// without naming them
+void
+appendCameraState(std::vector<double>& values, const scene_rdl2::rdl2::Camera* camera)
+{
+    if (!camera) {
+        return;
+    }
+
+    const scene_rdl2::rdl2::SceneClass& sceneClass = camera->getSceneClass();
+    for (auto it = sceneClass.beginAttributes(); it != sceneClass.endAttributes(); ++it) {
+        const scene_rdl2::rdl2::Attribute& attr = **it;
+        for (const scene_rdl2::rdl2::AttributeTimestep timestep :
+                 { scene_rdl2::rdl2::TIMESTEP_BEGIN, scene_rdl2::rdl2::TIMESTEP_END }) {
+            switch (attr.getType()) {
+            case scene_rdl2::rdl2::TYPE_BOOL:
+                values.push_back(getValue<scene_rdl2::rdl2::Bool>(camera, attr, timestep));
+                break;
+            case scene_rdl2::rdl2::TYPE_INT:
+                values.push_back(getValue<scene_rdl2::rdl2::Int>(camera, attr, timestep));
+                break;
+            case scene_rdl2::rdl2::TYPE_LONG:
+                values.push_back(getValue<scene_rdl2::rdl2::Long>(camera, attr, timestep));
+                break;
+            case scene_rdl2::rdl2::TYPE_FLOAT:
+                values.push_back(getValue<scene_rdl2::rdl2::Float>(camera, attr, timestep));
+                break;
+            case scene_rdl2::rdl2::TYPE_DOUBLE:
+                values.push_back(getValue<scene_rdl2::rdl2::Double>(camera, attr, timestep));
+                break;
+            case scene_rdl2::rdl2::TYPE_VEC2F:
+            {
+                const Vec2f v = getValue<scene_rdl2::rdl2::Vec2f>(camera, attr, timestep);
+                values.insert(values.end(), { v.x, v.y });
+            }
+            break;
+            case scene_rdl2::rdl2::TYPE_VEC3F:
+            {
+                const Vec3f v = getValue<scene_rdl2::rdl2::Vec3f>(camera, attr, timestep);
+                values.insert(values.end(), { v.x, v.y, v.z });
+            }
+            break;
+            case scene_rdl2::rdl2::TYPE_MAT4D:
+                appendMatrix(values, getValue<scene_rdl2::rdl2::Mat4d>(camera, attr, timestep));
+                break;
+            default:
+                // strings, objects and vectors do not shape the projection
+                break;
+            }
+            if (!attr.isBlurrable()) {
+                break;
+            }
+        }
+    }
+}
+
+// Append the scene variables the camera's screen space depends on
+void
+appendSceneVariables(std::vector<double>& values, const scene_rdl2::rdl2::SceneContext* context)
+{
+    const scene_rdl2::rdl2::SceneVariables& sv = context->getSceneVariables();
+    values.push_back(sv.getRezedWidth());
+    values.push_back(sv.getRezedHeight());
+    for (const scene_rdl2::math::HalfOpenViewport& viewport :
+             { sv.getRezedApertureWindow(), sv.getRezedRegionWindow() }) {
+        values.insert(values.end(), { static_cast<double>(viewport.mMinX),
+                                      static_cast<double>(viewport.mMinY),
+                                      static_cast<double>(viewport.mMaxX),
+                                      static_cast<double>(viewport.mMaxY) });
+    }
+}
+
+XformKey
+makeKey(const scene_rdl2::rdl2::SceneObject* shader,
+        const scene_rdl2::rdl2::Node* node,
+        const scene_rdl2::rdl2::Camera* camera,
+        const std::array<float, 4>* window)
+{
+    const scene_rdl2::rdl2::SceneContext* context = shader->getSceneClass().getSceneContext();
+
+    XformKey key {
+        context,
+        node,
+        camera,
+        context->getPrimaryCamera(),
+        window != nullptr,
+        { 0.0f, 0.0f, 0.0f, 0.0f },
+        false,
+        {}
+    };
+    if (window) {
+        std::copy(window->begin(), window->end(), key.mWindow);
+    }
+    appendNodeXform(key.mValues, node);
+    appendCameraState(key.mValues, camera);
+    appendCameraState(key.mValues, key.mPrimaryCamera);
+    appendSceneVariables(key.mValues, context);
+    return key;
+}
+
+} // anonymous namespace
+
+std::shared_ptr<moonray::shading::Xform>
+acquireXform(const scene_rdl2::rdl2::SceneObject* shader,
+             const scene_rdl2::rdl2::Node* node,
+             const scene_rdl2::rdl2::Camera* camera,
+             const std::array<float, 4>* window)
+{
+    const XformKey key = makeKey(shader, node, camera, window);
+
+    XformRegistry& registry = getXformRegistry();
+    std::shared_ptr<moonray::shading::Xform> xform = registry.find(key);
+    if (xform) {
+        return xform;
+    }
+
+    // Build without holding the lock, two shaders may build the same
+    // transforms at once, only one of them is kept
+    return registry.insert(key, std::make_unique<moonray::shading::Xform>(shader, node, camera, window));
+}
+
+std::shared_ptr<moonray::shading::Xform>
+acquireXform(const scene_rdl2::rdl2::SceneObject* shader,
+             const Mat4d& projectionMatrix)
+{
+    XformKey key = makeKey(shader, nullptr, nullptr, nullptr);
+    key.mHasProjectionMatrix = true;
+    appendMatrix(key.mValues, projectionMatrix);
+
+    XformRegistry& registry = getXformRegistry();
+    std::shared_ptr<moonray::shading::Xform> xform = registry.find(key);
+    if (xform) {
+        return xform;
+    }
+
+    return registry.insert(key, std::make_unique<moonray::shading::Xform>(shader, projectionMatrix));
+}
+
+} // projection
+} // moonshine
+
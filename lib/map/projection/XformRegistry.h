@@ -0,0 +1,43 @@
+// Copyright 2023-2024 DreamWorks Animation LLC
+// SPDX-License-Identifier: Apache-2.0
+
+
+#pragma once
+
+#include <moonray/rendering/shading/Xform.h>
+#include <scene_rdl2/common/math/Mat4.h>
+#include <scene_rdl2/scene/rdl2/rdl2.h>
+
+#include <array>
+#include <memory>
+
+namespace moonshine  {
+namespace projection  {
+
+// Returns a moonray::shading::Xform for the given node, camera and window,
+// any of which may be null, as the Xform constructor taking the same
+// arguments would build it, shared with every other shader of the same scene
+// that asked for the same transforms and still holds them. The Xform is
+// released from the registry when its last holder lets go of it.
+//
+// Besides the objects themselves, the key holds the world transforms of the
+// node at both motion steps, every numeric attribute of the camera and of
+// the scene's primary camera (transform, focal length, film aperture,
+// near/far...), and the resolution, aperture and region windows of the
+// scene variables. A shader updated after any of them changed gets a new
+// Xform. A shared Xform is built with the shader that first asked for it,
+// the registry is scoped to that shader's SceneContext.
+std::shared_ptr<moonray::shading::Xform>
+acquireXform(const scene_rdl2::rdl2::SceneObject* shader,
+             const scene_rdl2::rdl2::Node* node,
+             const scene_rdl2::rdl2::Camera* camera,
+             const std::array<float, 4>* window);
+
+// As above, for the Xform whose object space is given by projectionMatrix
+std::shared_ptr<moonray::shading::Xform>
+acquireXform(const scene_rdl2::rdl2::SceneObject* shader,
+             const scene_rdl2::math::Mat4d& projectionMatrix);
+
+} // projection
+} // moonshine
+
@@ -0,0 +1,100 @@
+// Copyright 2023-2024 DreamWorks Animation LLC
+// SPDX-License-Identifier: Apache-2.0
+
+///
+/// @file BlendWeightCache.cc
+/// $Id$
+///
+
+#include "BlendWeightCache.h"
+#include "BlendWeightCache_ispc_stubs.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+
+namespace moonshine {
+namespace dwabase {
+
+namespace {
+
+// Bumped by invalidateBlendWeightCaches(). Updates never overlap
+// shading, so relaxed ordering is enough.
+std::atomic<uint32_t> sBlendWeightCacheEpoch(1);
+
+struct ThreadBlendWeightCaches
+{
+    ThreadBlendWeightCaches() :
+        mEpoch(0),
+        mVaryingSize(ispc::DWABASE_getBlendWeightCachevSize())
+    {
+        std::memset(mScalar, 0, sizeof(mScalar));
+        // The ispc entries hold varying members, so match the
+        // alignment of the widest vector registers. aligned_alloc()
+        // requires the size to be a multiple of the alignment.
+        mVaryingSize = (mVaryingSize + 63) & ~size_t(63);
+        mVarying = static_cast<char*>(std::aligned_alloc(64, mVaryingSize));
+        std::memset(mVarying, 0, mVaryingSize);
+    }
+
+    ~ThreadBlendWeightCaches()
+    {
+        std::free(mVarying);
+    }
+
+    void refresh()
+    {
+        const uint32_t epoch = sBlendWeightCacheEpoch.load(std::memory_order_relaxed);
+        if (mEpoch != epoch) {
+            std::memset(mScalar, 0, sizeof(mScalar));
+            std::memset(mVarying, 0, mVaryingSize);
+            mEpoch = epoch;
+        }
+    }
+
+    uint32_t mEpoch;
+    BlendWeightCacheEntry mScalar[sBlendWeightCacheSize];
+    size_t mVaryingSize;
+    char* mVarying;
+};
+
+ThreadBlendWeightCaches&
+getThreadBlendWeightCaches()
+{
+    thread_local ThreadBlendWeightCaches caches;
+    caches.refresh();
+    return caches;
+}
+
+} // anonymous namespace
+
+uint64_t
+hashBlendWeightState(const moonray::shading::State& state)
+{
+    return ispc::DWABASE_hashBlendWeightBytes(reinterpret_cast<const int8_t*>(&state),
+                                             sizeof(moonray::shading::State));
+}
+
+BlendWeightCacheEntry*
+getBlendWeightCache()
+{
+    return getThreadBlendWeightCaches().mScalar;
+}
+
+void
+invalidateBlendWeightCaches()
+{
+    sBlendWeightCacheEpoch.fetch_add(1, std::memory_order_relaxed);
+}
+
+} // namespace dwabase
+} // namespace moonshine
+
+extern "C" {
+void*
+DWABASE_getBlendWeightCachev()
+{
+    return moonshine::dwabase::getThreadBlendWeightCaches().mVarying;
+}
+}
+
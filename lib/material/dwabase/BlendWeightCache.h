@@ -0,0 +1,95 @@
+// Copyright 2023-2024 DreamWorks Animation LLC
+// SPDX-License-Identifier: Apache-2.0
+
+///
+/// @file BlendWeightCache.h
+/// $Id$
+///
+
+#pragma once
+
+#include <moonray/rendering/shading/MaterialApi.h>
+
+#include <cstdint>
+
+namespace moonshine {
+namespace dwabase {
+
+// DwaMixMaterial's "mix" and DwaLayerMaterial's "mask" are needed by
+// resolveParameters(), resolvePresence(), resolveRefractiveIndex() and
+// resolveSubsurfaceNormal(), which the renderer calls separately for the
+// same shading point. When the attribute is bound to a map network each of
+// those calls would evaluate the whole network again, as would every
+// nested layering material below it. The blend weight cache keeps the
+// most recent weights resolved by each thread, keyed on the material, the
+// State and a hash of every byte of the State, so the network runs once
+// per shading point.
+//
+// States live in storage the renderer reuses, so the address alone does
+// not tell shading points apart. Neither does any fixed subset of the
+// State's fields, since a map can read any of them: primitive attributes,
+// derivatives, the path flags and so on. So the key holds all of them.
+// The State refers to its primitive attribute values rather than holding
+// them, but those references are hashed along with the geometry and
+// primitive ids that say what they refer to. A renderer that changes the
+// State between the calls for one shading point only costs a reevaluation.
+//
+// Every entry is dropped whenever a layering material is updated, since a
+// change anywhere in the bound network updates the material that binds it.
+
+struct BlendWeightCacheEntry
+{
+    const void* mMaterial;
+    const moonray::shading::State* mState;
+    uint64_t mStateHash;
+    float mWeight;
+    bool mValid;
+};
+
+// The calling thread's cache, cleared first if the caches were invalidated
+// since this thread last used it
+BlendWeightCacheEntry* getBlendWeightCache();
+
+// Number of entries in each thread's cache, a power of 2
+constexpr unsigned sBlendWeightCacheSize = 16;
+
+// Drop every cached weight on every thread, called from update()
+void invalidateBlendWeightCaches();
+
+// Hash of every byte of state, see BlendWeightCacheEntry
+uint64_t hashBlendWeightState(const moonray::shading::State& state);
+
+// Return the weight cached for this material at this shading point or, if
+// there is none, call eval() and cache its result.
+template <typename EvalFunc>
+float
+resolveBlendWeight(const void* material,
+                   const moonray::shading::State& state,
+                   EvalFunc eval)
+{
+    const uintptr_t hash = (reinterpret_cast<uintptr_t>(material) >> 4) ^
+                           (reinterpret_cast<uintptr_t>(&state) >> 4) * 0x9e3779b1u;
+    BlendWeightCacheEntry& entry = getBlendWeightCache()[hash & (sBlendWeightCacheSize - 1)];
+    const uint64_t stateHash = hashBlendWeightState(state);
+
+    if (entry.mValid &&
+        entry.mMaterial == material &&
+        entry.mState == &state &&
+        entry.mStateHash == stateHash) {
+        return entry.mWeight;
+    }
+
+    // eval() may resolve nested layering materials, which can reuse this
+    // entry, so only fill it in once the weight is known
+    const float weight = eval();
+    entry.mMaterial = material;
+    entry.mState = &state;
+    entry.mStateHash = stateHash;
+    entry.mWeight = weight;
+    entry.mValid = true;
+    return weight;
+}
+
+} // namespace dwabase
+} // namespace moonshine
+
@@ -1047,6 +1047,7 @@ void blendColorCorrectParams(const ispc::BlendColorSpace colorSpace,
             params.mColorCorrectParams[cc].mGain = params0.mColorCorrectParams[cc].mGain;
             params.mColorCorrectParams[cc].mTmiEnabled = params0.mColorCorrectParams[cc].mTmiEnabled;
             params.mColorCorrectParams[cc].mTmi = params0.mColorCorrectParams[cc].mTmi;
+            params.mColorCorrectParams[cc].mCompiled = params0.mColorCorrectParams[cc].mCompiled;
         } else if (!params0.mColorCorrectParams[cc].mOn && params1.mColorCorrectParams[cc].mOn) {
             params.mColorCorrectParams[cc].mOn = params1.mColorCorrectParams[cc].mOn;
             params.mColorCorrectParams[cc].mMix = params1.mColorCorrectParams[cc].mMix;
@@ -1055,8 +1056,12 @@ void blendColorCorrectParams(const ispc::BlendColorSpace colorSpace,
             params.mColorCorrectParams[cc].mGain = params1.mColorCorrectParams[cc].mGain;
             params.mColorCorrectParams[cc].mTmiEnabled = params1.mColorCorrectParams[cc].mTmiEnabled;
             params.mColorCorrectParams[cc].mTmi = params1.mColorCorrectParams[cc].mTmi;
+            params.mColorCorrectParams[cc].mCompiled = params1.mColorCorrectParams[cc].mCompiled;
         } else {
             params.mColorCorrectParams[cc].mOn = true;
+            // The blend of two compiled corrections is not the blend of
+            // their matrices, so fall back to the blended fields
+            params.mColorCorrectParams[cc].mCompiled = 0;
 
             params.mColorCorrectParams[cc].mMix = lerp(params0.mColorCorrectParams[cc].mMix,
                                                        params1.mColorCorrectParams[cc].mMix,
@@ -1703,12 +1708,79 @@ scene_rdl2::math::Vec3f blendSubsurfaceNormal(TLState *tls,
     return safeNormalize(lerp(normal0, normal1, mask));
 }
 
+void blendResolvedParameters(ispc::BlendColorSpace colorSpace,
+                             int lobeFamilies,
+                             const glitter::Glitter* glitterPtr,
+                             intptr_t evalSubsurfaceNormal,
+                             const ispc::DwaBaseParameters &params0,
+                             const ispc::DwaBaseParameters &params1,
+                             float mask,
+                             ispc::DwaBaseParameters &params)
+{
+    // A family neither side has is left as initParameters() set it,
+    // which is what blending it would produce. Hair toon isn't blended
+    // here at all.
+    const int families = lobeFamilies &
+                         (params0.mLobeFamilies | params1.mLobeFamilies) &
+                         ~ispc::LOBE_FAMILY_HAIR_TOON;
+
+    // make sure all fields are initialized, except for the bulk of the
+    // families that aren't blended
+    DwaBaseLayerable::initParameters(params, families);
+
+    if (families & ispc::LOBE_FAMILY_GLITTER) {
+        blendGlitterParams(colorSpace, mask, glitterPtr, params0, params1, params);
+    }
+    blendCommonParams(colorSpace, mask, params0, params1, params);
+    if (families & ispc::LOBE_FAMILY_FUZZ) {
+        blendFuzzParams(colorSpace, mask, params0, params1, params);
+    }
+    if (families & ispc::LOBE_FAMILY_OUTER_SPECULAR) {
+        blendOuterSpecularParams(colorSpace, mask, params0, params1, params);
+    }
+    if (families & ispc::LOBE_FAMILY_SPECULAR) {
+        blendCommonSpecularParams(mask, params0, params1, params);
+    }
+    if (families & ispc::LOBE_FAMILY_IRIDESCENCE) {
+        blendIridescenceParams(colorSpace, mask, params0, params1, params);
+    }
+    if (families & ispc::LOBE_FAMILY_METALLIC) {
+        blendMetallicParams(colorSpace, mask, params0, params1, params);
+    }
+    blendColorCorrectParams(colorSpace, mask, params0, params1, params);
+    blendAccentParams(colorSpace, mask, params0, params1, params);
+
+    // Always blend params.mFabricAttenuation before calling
+    // blendRefractiveIndex, blendTransmission, blendDiffuse
+    params.mFabricAttenuation = lerp(params0.mFabricAttenuation, params1.mFabricAttenuation, mask);
+
+    if (families & ispc::LOBE_FAMILY_FABRIC) {
+        blendFabricParams(colorSpace, mask, params0, params1, params);
+    }
+    blendRefractiveIndexParams(mask, params0, params1, params);
+    if (families & ispc::LOBE_FAMILY_TRANSMISSION) {
+        blendTransmissionParams(colorSpace, mask, params0, params1, params);
+    }
+
+    // Blend Toon Diffuse
+    if (families & ispc::LOBE_FAMILY_TOON) {
+        blendToonParams(colorSpace, mask, params0, params1, params);
+    }
+
+    if (families & ispc::LOBE_FAMILY_DIFFUSE) {
+        blendDiffuseParams(colorSpace, mask, params0, params1, params);
+    }
+
+    params.mEvalSubsurfaceNormalFn = evalSubsurfaceNormal;
+}
+
 bool blendParameters(TLState *tls,
                      const State& state,
                      const bool castsCaustics,
                      ispc::DwaBaseParameters &params,
                      const ispc::DwaBaseUniformParameters &uParams,
                      ispc::BlendColorSpace colorSpace,
+                     int lobeFamilies,
                      const glitter::Glitter* glitterPtr,
                      intptr_t evalSubsurfaceNormal,
                      bool subMtl0HasGlitter,
@@ -1746,33 +1818,8 @@ bool blendParameters(TLState *tls,
                    layerable1->resolveParameters(tls, state, castsCaustics, params1);
     if (!success) { return false; }
 
-    // make sure all fields are initialized
-    DwaBaseLayerable::initParameters(params);
-
-    blendGlitterParams(colorSpace, mask, glitterPtr, params0, params1, params);
-    blendCommonParams(colorSpace, mask, params0, params1, params);
-    blendFuzzParams(colorSpace, mask, params0, params1, params);
-    blendOuterSpecularParams(colorSpace, mask, params0, params1, params);
-    blendCommonSpecularParams(mask, params0, params1, params);
-    blendIridescenceParams(colorSpace, mask, params0, params1, params);
-    blendMetallicParams(colorSpace, mask, params0, params1, params);
-    blendColorCorrectParams(colorSpace, mask, params0, params1, params);
-    blendAccentParams(colorSpace, mask, params0, params1, params);
-
-    // Always blend params.mFabricAttenuation before calling
-    // blendRefractiveIndex, blendTransmission, blendDiffuse
-    params.mFabricAttenuation = lerp(params0.mFabricAttenuation, params1.mFabricAttenuation, mask);
-
-    blendFabricParams(colorSpace, mask, params0, params1, params);
-    blendRefractiveIndexParams(mask, params0, params1, params);
-    blendTransmissionParams(colorSpace, mask, params0, params1, params);
-
-    // Blend Toon Diffuse
-    blendToonParams(colorSpace, mask, params0, params1, params);
-
-    blendDiffuseParams(colorSpace, mask, params0, params1, params);
-
-    params.mEvalSubsurfaceNormalFn = evalSubsurfaceNormal;
+    blendResolvedParameters(colorSpace, lobeFamilies, glitterPtr, evalSubsurfaceNormal,
+                            params0, params1, mask, params);
 
     return true;
 }
@@ -1820,8 +1867,10 @@ blendHairParameters(TLState *tls,
 
     params.mEvalSubsurfaceNormalFn = evalSubsurfaceNormal;
 
-    // make sure all fields are initialized
-    DwaBaseLayerable::initParameters(params);
+    // make sure all fields are initialized, except for the bulk of the
+    // families neither side uses
+    const int families = params0.mLobeFamilies | params1.mLobeFamilies;
+    DwaBaseLayerable::initParameters(params, families);
 
     blendEmissionParams(colorSpace,
                         mask,
@@ -1847,11 +1896,13 @@ blendHairParameters(TLState *tls,
                            params1,
                            params);
 
-    blendHairToonParams(colorSpace,
-                        mask,
-                        params0,
-                        params1,
-                        params);
+    if (families & ispc::LOBE_FAMILY_HAIR_TOON) {
+        blendHairToonParams(colorSpace,
+                            mask,
+                            params0,
+                            params1,
+                            params);
+    }
 
     return true;
 }
@@ -66,12 +66,26 @@ scene_rdl2::math::Vec3f blendSubsurfaceNormal(moonray::shading::TLState *tls,
                                               const DwaBaseLayerable* layerable1,
                                               float mask);
 
+// Blend two sets of resolved parameters into params, which must not be
+// either of them. Only the lobe families in lobeFamilies, a mask of
+// ispc::DwaBaseLobeFamily bits, are blended; any other family must be
+// absent from both params0 and params1.
+void blendResolvedParameters(ispc::BlendColorSpace colorSpace,
+                             int lobeFamilies,
+                             const glitter::Glitter* glitterPtr,
+                             intptr_t evalSubsurfaceNormal,
+                             const ispc::DwaBaseParameters &params0,
+                             const ispc::DwaBaseParameters &params1,
+                             float mask,
+                             ispc::DwaBaseParameters &params);
+
 bool blendParameters(moonray::shading::TLState *tls,
                      const moonray::shading::State& state,
                      const bool castsCaustics,
                      ispc::DwaBaseParameters &params,
                      const ispc::DwaBaseUniformParameters &uParams,
                      ispc::BlendColorSpace colorSpace,
+                     int lobeFamilies,
                      const glitter::Glitter* glitterPtr,
                      intptr_t evalSubsurfaceNormal,
                      bool subMtl0HasGlitter,
@@ -9,6 +9,7 @@
 #include "DwaBase.h"
 
 #include <scene_rdl2/scene/rdl2/rdl2.h>
+#include <moonshine/map/pointwise/PointwiseMaps.h>
 #include <moonray/rendering/shading/EvalAttribute.h>
 #include <scene_rdl2/common/math/MathUtil.h>
 
@@ -117,6 +118,224 @@ using namespace moonray::shading;
     MNRY_ASSERT(mIspc.mAttrFuncs.name.mEvalAttrRampPositionOffset8);               \
     MNRY_ASSERT(mIspc.mAttrFuncs.name.mEvalAttrRampPositionOffset9);
 
+namespace {
+
+// Constant folding of attribute bindings, see DwaBase::foldAttributes().
+// Each map class below only depends on the shading state through the maps
+// bound to its attributes. Its attributes are folded here and passed to the
+// same kernel its sample function calls (see PointwiseMaps.h).
+
+// Bound networks deeper than this are not folded, which also guards
+// against cycles
+constexpr int sMaxFoldDepth = 16;
+
+bool foldMap(const scene_rdl2::rdl2::SceneObject& map, int depth, Color& result);
+
+// Evaluate key of obj as evalColor() would
+bool
+foldColor(const scene_rdl2::rdl2::SceneObject& obj,
+          const scene_rdl2::rdl2::AttributeKey<scene_rdl2::rdl2::Rgb>& key,
+          int depth,
+          Color& result)
+{
+    result = obj.get(key);
+    if (key.isBindable()) {
+        const scene_rdl2::rdl2::SceneObject* bound = obj.getBinding(key);
+        if (bound) {
+            Color mapResult;
+            if (!foldMap(*bound, depth + 1, mapResult)) {
+                return false;
+            }
+            result *= mapResult;
+        }
+    }
+    return true;
+}
+
+// Evaluate key of obj as evalFloat() would. Only grey map results are
+// folded, so that it does not matter how evalFloat() reduces a map's
+// color to a float.
+bool
+foldFloat(const scene_rdl2::rdl2::SceneObject& obj,
+          const scene_rdl2::rdl2::AttributeKey<scene_rdl2::rdl2::Float>& key,
+          int depth,
+          float& result)
+{
+    result = obj.get(key);
+    if (key.isBindable()) {
+        const scene_rdl2::rdl2::SceneObject* bound = obj.getBinding(key);
+        if (bound) {
+            Color mapResult;
+            if (!foldMap(*bound, depth + 1, mapResult) ||
+                mapResult.r != mapResult.g || mapResult.r != mapResult.b) {
+                return false;
+            }
+            result *= mapResult.r;
+        }
+    }
+    return true;
+}
+
+template <typename T>
+scene_rdl2::rdl2::AttributeKey<T>
+getKey(const scene_rdl2::rdl2::SceneObject& obj, const char* name)
+{
+    return obj.getSceneClass().getAttributeKey<T>(name);
+}
+
+bool
+foldFloat(const scene_rdl2::rdl2::SceneObject& obj, const char* name, int depth, float& result)
+{
+    return foldFloat(obj, getKey<scene_rdl2::rdl2::Float>(obj, name), depth, result);
+}
+
+bool
+foldMap(const scene_rdl2::rdl2::SceneObject& map, int depth, Color& result)
+{
+    if (depth > sMaxFoldDepth) {
+        return false;
+    }
+
+    const std::string& className = map.getSceneClass().getName();
+    if (className == "ConstantColorMap") {
+        result = pointwise::constantColor(map.get(getKey<scene_rdl2::rdl2::Rgb>(map, "color_value")));
+        return true;
+    }
+
+    if (className == "ConstantScalarMap") {
+        result = pointwise::constantScalar(map.get(getKey<scene_rdl2::rdl2::Float>(map, "scalar_value")));
+        return true;
+    }
+
+    if (className == "FloatToRgbMap") {
+        float r, g, b;
+        if (!foldFloat(map, "R", depth, r) ||
+            !foldFloat(map, "G", depth, g) ||
+            !foldFloat(map, "B", depth, b)) {
+            return false;
+        }
+        result = pointwise::floatToRgb(r, g, b);
+        return true;
+    }
+
+    if (className == "ColorCorrectGammaMap") {
+        Color input;
+        float mix;
+        if (!foldColor(map, getKey<scene_rdl2::rdl2::Rgb>(map, "input"), depth, input) ||
+            !foldFloat(map, "mix", depth, mix)) {
+            return false;
+        }
+        if (pointwise::isColorCorrectOff(map.get(getKey<scene_rdl2::rdl2::Bool>(map, "on")), mix)) {
+            result = input;
+            return true;
+        }
+
+        Color gamma;
+        if (map.get(getKey<scene_rdl2::rdl2::Bool>(map, "use_per_channel_gamma"))) {
+            if (!foldFloat(map, "gamma_r", depth, gamma.r) ||
+                !foldFloat(map, "gamma_g", depth, gamma.g) ||
+                !foldFloat(map, "gamma_b", depth, gamma.b)) {
+                return false;
+            }
+        } else {
+            float g;
+            if (!foldFloat(map, "gamma", depth, g)) {
+                return false;
+            }
+            gamma = Color(g);
+        }
+        result = pointwise::colorCorrectGamma(input, mix, gamma);
+        return true;
+    }
+
+    if (className == "ColorCorrectGainOffsetMap") {
+        Color input;
+        float mix;
+        if (!foldColor(map, getKey<scene_rdl2::rdl2::Rgb>(map, "input"), depth, input) ||
+            !foldFloat(map, "mix", depth, mix)) {
+            return false;
+        }
+        if (pointwise::isColorCorrectOff(map.get(getKey<scene_rdl2::rdl2::Bool>(map, "on")), mix)) {
+            result = input;
+            return true;
+        }
+
+        Color gain;
+        Color offset;
+        if (map.get(getKey<scene_rdl2::rdl2::Bool>(map, "use_per_channel_gain_offset"))) {
+            if (!foldFloat(map, "gain_r", depth, gain.r) ||
+                !foldFloat(map, "gain_g", depth, gain.g) ||
+                !foldFloat(map, "gain_b", depth, gain.b) ||
+                !foldFloat(map, "offset_r", depth, offset.r) ||
+                !foldFloat(map, "offset_g", depth, offset.g) ||
+                !foldFloat(map, "offset_b", depth, offset.b)) {
+                return false;
+            }
+        } else {
+            float g, o;
+            if (!foldFloat(map, "gain", depth, g) ||
+                !foldFloat(map, "offset", depth, o)) {
+                return false;
+            }
+            gain = Color(g);
+            offset = Color(o);
+        }
+        result = pointwise::colorCorrectGainOffset(input, mix, gain, offset);
+        return true;
+    }
+
+    // Anything else may depend on the shading state
+    return false;
+}
+
+struct FoldableFloat
+{
+    ispc::DwaBaseFoldedAttribute mId;
+    scene_rdl2::rdl2::AttributeKey<scene_rdl2::rdl2::Float> DwaBaseAttributeKeys::* mKey;
+};
+
+struct FoldableColor
+{
+    ispc::DwaBaseFoldedAttribute mId;
+    scene_rdl2::rdl2::AttributeKey<scene_rdl2::rdl2::Rgb> DwaBaseAttributeKeys::* mKey;
+};
+
+const FoldableFloat sFoldableFloats[] = {
+    { ispc::DWABASE_FOLDED_FUZZ,                     &DwaBaseAttributeKeys::mFuzz },
+    { ispc::DWABASE_FOLDED_FUZZ_ROUGHNESS,           &DwaBaseAttributeKeys::mFuzzRoughness },
+    { ispc::DWABASE_FOLDED_OUTER_SPECULAR,           &DwaBaseAttributeKeys::mOuterSpecular },
+    { ispc::DWABASE_FOLDED_OUTER_SPECULAR_ROUGHNESS, &DwaBaseAttributeKeys::mOuterSpecularRoughness },
+    { ispc::DWABASE_FOLDED_OUTER_SPECULAR_THICKNESS, &DwaBaseAttributeKeys::mOuterSpecularThickness },
+    { ispc::DWABASE_FOLDED_IRIDESCENCE,              &DwaBaseAttributeKeys::mIridescence },
+    { ispc::DWABASE_FOLDED_SPECULAR,                 &DwaBaseAttributeKeys::mSpecular },
+    { ispc::DWABASE_FOLDED_ROUGHNESS,                &DwaBaseAttributeKeys::mRoughness },
+    { ispc::DWABASE_FOLDED_ANISOTROPY,               &DwaBaseAttributeKeys::mAnisotropy },
+    { ispc::DWABASE_FOLDED_METALLIC,                 &DwaBaseAttributeKeys::mMetallic },
+    { ispc::DWABASE_FOLDED_TRANSMISSION,             &DwaBaseAttributeKeys::mTransmission },
+    { ispc::DWABASE_FOLDED_DIFFUSE_ROUGHNESS,        &DwaBaseAttributeKeys::mDiffuseRoughness },
+    { ispc::DWABASE_FOLDED_SCATTERING_RADIUS,        &DwaBaseAttributeKeys::mScatteringRadius },
+    { ispc::DWABASE_FOLDED_DIFFUSE_TRANSMISSION,     &DwaBaseAttributeKeys::mDiffuseTransmission },
+    { ispc::DWABASE_FOLDED_PRESENCE,                 &DwaBaseAttributeKeys::mPresence }
+};
+
+const FoldableColor sFoldableColors[] = {
+    { ispc::DWABASE_FOLDED_HAIR_COLOR,                       &DwaBaseAttributeKeys::mHairColor },
+    { ispc::DWABASE_FOLDED_FUZZ_ALBEDO,                      &DwaBaseAttributeKeys::mFuzzAlbedo },
+    { ispc::DWABASE_FOLDED_OUTER_SPECULAR_ATTENUATION_COLOR, &DwaBaseAttributeKeys::mOuterSpecularAttenuationColor },
+    { ispc::DWABASE_FOLDED_METALLIC_COLOR,                   &DwaBaseAttributeKeys::mMetallicColor },
+    { ispc::DWABASE_FOLDED_METALLIC_EDGE_COLOR,              &DwaBaseAttributeKeys::mMetallicEdgeColor },
+    { ispc::DWABASE_FOLDED_TRANSMISSION_COLOR,               &DwaBaseAttributeKeys::mTransmissionColor },
+    { ispc::DWABASE_FOLDED_ALBEDO,                           &DwaBaseAttributeKeys::mAlbedo },
+    { ispc::DWABASE_FOLDED_SCATTERING_COLOR,                 &DwaBaseAttributeKeys::mScatteringColor },
+    { ispc::DWABASE_FOLDED_DIFFUSE_TRANSMISSION_COLOR,       &DwaBaseAttributeKeys::mDiffuseTransmissionColor },
+    { ispc::DWABASE_FOLDED_EMISSION,                         &DwaBaseAttributeKeys::mEmission }
+};
+
+static_assert(ispc::DWABASE_NUM_FOLDED_ATTRIBUTES <= 32,
+              "DwaBaseFoldedAttributes::mMask has one bit per attribute");
+
+} // anonymous namespace
+
 DwaBase::DwaBase(const scene_rdl2::rdl2::SceneClass& sceneClass,
                  const std::string& name,
                  const DwaBaseAttributeKeys& attrKeys,
@@ -131,6 +350,8 @@ DwaBase::DwaBase(const scene_rdl2::rdl2::SceneClass& sceneClass,
 
     mIspc.mAttrFuncs = attrFns;
     mIspc.mModel     = model;
+    mIspc.mHints.mLobeFamilies = ispc::LOBE_FAMILY_ALL;
+    mIspc.mFolded.mMask = 0;
 
     // The DwaLayerMaterial is derived from DwaBase because of glitter
     // but does not have the presence parameter like the other Dwa
@@ -802,6 +1023,26 @@ DwaBase::update()
 
     mIspc.mHints.mThinGeometry = mAttrKeys.mThinGeometry.isValid() && get(mAttrKeys.mThinGeometry);
 
+    // resolveParameters() leaves every family these hints rule out at
+    // its initial values, which lets layering materials skip blending it
+    int& families = mIspc.mHints.mLobeFamilies;
+    families = 0;
+    if (mIspc.mHints.mRequiresGlitterParams)        families |= ispc::LOBE_FAMILY_GLITTER;
+    if (mIspc.mHints.mRequiresFuzzParams)           families |= ispc::LOBE_FAMILY_FUZZ;
+    if (mIspc.mHints.mRequiresOuterSpecularParams)  families |= ispc::LOBE_FAMILY_OUTER_SPECULAR;
+    if (mIspc.mHints.mRequiresSpecularParams)       families |= ispc::LOBE_FAMILY_SPECULAR;
+    if (mIspc.mHints.mRequiresIridescenceParams)    families |= ispc::LOBE_FAMILY_IRIDESCENCE;
+    if (mIspc.mHints.mRequiresMetallicParams)       families |= ispc::LOBE_FAMILY_METALLIC;
+    if (mIspc.mHints.mRequiresFabricParams)         families |= ispc::LOBE_FAMILY_FABRIC;
+    if (mIspc.mHints.mRequiresTransmissionParams)   families |= ispc::LOBE_FAMILY_TRANSMISSION;
+    if (mIspc.mHints.mRequiresToonDiffuseParams ||
+        mIspc.mHints.mRequiresToonSpecularParams)   families |= ispc::LOBE_FAMILY_TOON;
+    if (mIspc.mHints.mRequiresDiffuseParams)        families |= ispc::LOBE_FAMILY_DIFFUSE;
+    if (mIspc.mHints.mRequiresHairToonS1Params ||
+        mIspc.mHints.mRequiresHairToonS2Params ||
+        mIspc.mHints.mRequiresHairToonS3Params)     families |= ispc::LOBE_FAMILY_HAIR_TOON;
+    setLobeFamilies(families);
+
     mIspc.mHints.mPreventLightCulling =
         mAttrKeys.mPreventLightCulling.isValid() && get(mAttrKeys.mPreventLightCulling);
 
@@ -863,6 +1104,39 @@ DwaBase::update()
 
     mIspc.mDiffuseLightSet = nullptr;
     mIspc.mSpecularLightSet = nullptr;
+
+    foldAttributes();
+}
+
+// Fold every attribute of sFoldableFloats and sFoldableColors that is bound
+// to a network of maps that foldMap() can evaluate without a shading state.
+// resolveParameters(), on both the C++ and the ISPC side, then uses the
+// stored value instead of sampling the maps.
+void
+DwaBase::foldAttributes()
+{
+    ispc::DwaBaseFoldedAttributes& folded = mIspc.mFolded;
+    folded.mMask = 0;
+
+    for (const FoldableFloat& attr : sFoldableFloats) {
+        const auto& key = mAttrKeys.*attr.mKey;
+        float value;
+        if (key.isValid() && key.isBindable() && getBinding(key) &&
+            foldFloat(*this, key, 0, value)) {
+            asCpp(folded.mValues[attr.mId]) = Color(value);
+            folded.mMask |= 1 << attr.mId;
+        }
+    }
+
+    for (const FoldableColor& attr : sFoldableColors) {
+        const auto& key = mAttrKeys.*attr.mKey;
+        Color value;
+        if (key.isValid() && key.isBindable() && getBinding(key) &&
+            foldColor(*this, key, 0, value)) {
+            asCpp(folded.mValues[attr.mId]) = value;
+            folded.mMask |= 1 << attr.mId;
+        }
+    }
 }
 
 void
@@ -875,6 +1149,7 @@ DwaBase::updateGlitter()
     uniformParams.mFlakeRandomness = get(mAttrKeys.mGlitterRandomness);
     uniformParams.mDenseGlitterLodQuality = get(mAttrKeys.mGlitterDenseLodQuality);
     uniformParams.mSearchRadiusFactor = 0.25f;
+    uniformParams.mFlakeCacheCellFactor = max(0.0f, get(mAttrKeys.mGlitterFlakeCacheCellFactor));
     uniformParams.mLayeringMode = get(mAttrKeys.mGlitterLayeringMode);
     uniformParams.mDebugMode = static_cast<ispc::GLITTER_DebugModes>(get(mAttrKeys.mGlitterDebugMode));
 
@@ -942,6 +1217,29 @@ DwaBase::updateIridescence()
     }
 }
 
+// evalFloat() and evalColor(), unless update() folded the attribute
+finline float
+evalFoldedFloat(const DwaBase* me,
+                ispc::DwaBaseFoldedAttribute id,
+                const scene_rdl2::rdl2::AttributeKey<scene_rdl2::rdl2::Float>& key,
+                moonray::shading::TLState *tls,
+                const moonray::shading::State& state)
+{
+    const ispc::DwaBaseFoldedAttributes& folded = me->getISPCBaseMaterialStruct()->mFolded;
+    return (folded.mMask & (1 << id)) ? folded.mValues[id].r : evalFloat(me, key, tls, state);
+}
+
+finline Color
+evalFoldedColor(const DwaBase* me,
+                ispc::DwaBaseFoldedAttribute id,
+                const scene_rdl2::rdl2::AttributeKey<scene_rdl2::rdl2::Rgb>& key,
+                moonray::shading::TLState *tls,
+                const moonray::shading::State& state)
+{
+    const ispc::DwaBaseFoldedAttributes& folded = me->getISPCBaseMaterialStruct()->mFolded;
+    return (folded.mMask & (1 << id)) ? asCpp(folded.mValues[id]) : evalColor(me, key, tls, state);
+}
+
 finline void
 resolveNormalParams(const DwaBase* me,
                     moonray::shading::TLState *tls,
@@ -1187,7 +1485,7 @@ resolveHairParams(const DwaBase* me,
     }
 
     if (hints.mRequiresHairParams && !hints.mHairDiffuseIsOne) {
-        asCpp(params.mHairColor) = clamp(evalColor(me, keys.mHairColor, tls, state),
+        asCpp(params.mHairColor) = clamp(evalFoldedColor(me, ispc::DWABASE_FOLDED_HAIR_COLOR, keys.mHairColor, tls, state),
                                          sBlack,
                                          sWhite);
     }
@@ -1317,7 +1615,7 @@ resolveHairParams(const DwaBase* me,
                                     sWhite);
             } else {
                 asCpp(params.mHairDiffuseFrontColor) =
-                    clamp(evalColor(me, keys.mHairColor, tls, state),
+                    clamp(evalFoldedColor(me, ispc::DWABASE_FOLDED_HAIR_COLOR, keys.mHairColor, tls, state),
                                     sBlack,
                                     sWhite);
                 params.mHairDiffuseBackColor = params.mHairDiffuseFrontColor;
@@ -1338,9 +1636,9 @@ resolveFuzzParams(const DwaBase* me,
     if (hints.mRequiresFuzzParams &&
         (castsCaustics || !state.isCausticPath())) {
 
-        params.mFuzz                 = saturate(evalFloat(me, keys.mFuzz, tls, state));
-        asCpp(params.mFuzzAlbedo)    = clamp(evalColor(me, keys.mFuzzAlbedo, tls, state));
-        params.mFuzzRoughness        = saturate(evalFloat(me, keys.mFuzzRoughness, tls, state));
+        params.mFuzz                 = saturate(evalFoldedFloat(me, ispc::DWABASE_FOLDED_FUZZ, keys.mFuzz, tls, state));
+        asCpp(params.mFuzzAlbedo)    = clamp(evalFoldedColor(me, ispc::DWABASE_FOLDED_FUZZ_ALBEDO, keys.mFuzzAlbedo, tls, state));
+        params.mFuzzRoughness        = saturate(evalFoldedFloat(me, ispc::DWABASE_FOLDED_FUZZ_ROUGHNESS, keys.mFuzzRoughness, tls, state));
 
         params.mFuzzNormalDial = evalFloat(me, keys.mFuzzNormalDial, tls, state);
         asCpp(params.mFuzzNormal) = evalNormal(me,
@@ -1366,9 +1664,9 @@ resolveOuterSpecularParams(const DwaBase* me,
     asCpp(params.mOuterSpecularNormal) = state.getN();
     if (hints.mRequiresOuterSpecularParams &&
         (castsCaustics || !state.isCausticPath())) {
-        params.mOuterSpecular = saturate(evalFloat(me, keys.mOuterSpecular, tls, state));
+        params.mOuterSpecular = saturate(evalFoldedFloat(me, ispc::DWABASE_FOLDED_OUTER_SPECULAR, keys.mOuterSpecular, tls, state));
         params.mOuterSpecularRefractiveIndex = max(sEpsilon, me->get(keys.mOuterSpecularRefractiveIndex));
-        params.mOuterSpecularRoughness = saturate(evalFloat(me, keys.mOuterSpecularRoughness, tls, state));
+        params.mOuterSpecularRoughness = saturate(evalFoldedFloat(me, ispc::DWABASE_FOLDED_OUTER_SPECULAR_ROUGHNESS, keys.mOuterSpecularRoughness, tls, state));
 
         params.mOuterSpecularNormalDial = evalFloat(me, keys.mOuterSpecularNormalDial, tls, state);
         if (me->get(keys.mUseOuterSpecularNormal)) {
@@ -1383,10 +1681,10 @@ resolveOuterSpecularParams(const DwaBase* me,
 
         if (hints.mRequiresOuterSpecularAbsorptionParams) {
             params.mOuterSpecularThickness =
-                max(0.0f, evalFloat(me, keys.mOuterSpecularThickness, tls, state));
+                max(0.0f, evalFoldedFloat(me, ispc::DWABASE_FOLDED_OUTER_SPECULAR_THICKNESS, keys.mOuterSpecularThickness, tls, state));
 
             asCpp(params.mOuterSpecularAttenuationColor) =
-                clamp(evalColor(me, keys.mOuterSpecularAttenuationColor, tls, state));
+                clamp(evalFoldedColor(me, ispc::DWABASE_FOLDED_OUTER_SPECULAR_ATTENUATION_COLOR, keys.mOuterSpecularAttenuationColor, tls, state));
         }
     }
 }
@@ -1403,7 +1701,7 @@ resolveIridescenceParams(const DwaBase* me,
 {
     if (hints.mRequiresIridescenceParams &&
         (castsCaustics || !state.isCausticPath())) {
-        params.mIridescence = saturate(evalFloat(me, keys.mIridescence, tls, state));
+        params.mIridescence = saturate(evalFoldedFloat(me, ispc::DWABASE_FOLDED_IRIDESCENCE, keys.mIridescence, tls, state));
         params.mIridescenceApplyTo = (ispc::IridescenceLobe)me->get(keys.mIridescenceApplyTo);
         params.mIridescenceColorControl = (ispc::SHADING_IridescenceColorMode)me->get(keys.mIridescenceColorControl);
         asCpp(params.mIridescencePrimaryColor) = clamp(evalColor(me, keys.mIridescencePrimaryColor, tls, state));
@@ -1441,11 +1739,11 @@ resolveSpecularParams(const DwaBase* me,
 {
     if (hints.mRequiresSpecularParams &&
         (castsCaustics || !state.isCausticPath())) {
-        params.mSpecular = saturate(evalFloat(me, keys.mSpecular, tls, state));
-        params.mRoughness = saturate(evalFloat(me, keys.mRoughness, tls, state));
+        params.mSpecular = saturate(evalFoldedFloat(me, ispc::DWABASE_FOLDED_SPECULAR, keys.mSpecular, tls, state));
+        params.mRoughness = saturate(evalFoldedFloat(me, ispc::DWABASE_FOLDED_ROUGHNESS, keys.mRoughness, tls, state));
 
         if (hints.mRequiresAnisotropyParams) {
-            params.mAnisotropy = evalFloat(me, keys.mAnisotropy, tls, state);
+            params.mAnisotropy = evalFoldedFloat(me, ispc::DWABASE_FOLDED_ANISOTROPY, keys.mAnisotropy, tls, state);
             params.mAnisotropy = clamp(params.mAnisotropy, -1.0f, 1.0f);
             if (!isZero(params.mAnisotropy)) {
                 asCpp(params.mShadingTangent) = evalVec2f(me, keys.mShadingTangent, tls, state);
@@ -1458,10 +1756,10 @@ resolveSpecularParams(const DwaBase* me,
         if (ispcDwaBase.mModel == ispc::Model::Metal || hints.mMetallicIsOne) {
             params.mMetallic = 1.0f;
         } else {
-            params.mMetallic = saturate(evalFloat(me, keys.mMetallic, tls, state));
+            params.mMetallic = saturate(evalFoldedFloat(me, ispc::DWABASE_FOLDED_METALLIC, keys.mMetallic, tls, state));
         }
-        asCpp(params.mMetallicColor) = clamp(evalColor(me, keys.mMetallicColor, tls, state));
-        asCpp(params.mMetallicEdgeColor) = clamp(evalColor(me, keys.mMetallicEdgeColor, tls, state));
+        asCpp(params.mMetallicColor) = clamp(evalFoldedColor(me, ispc::DWABASE_FOLDED_METALLIC_COLOR, keys.mMetallicColor, tls, state));
+        asCpp(params.mMetallicEdgeColor) = clamp(evalFoldedColor(me, ispc::DWABASE_FOLDED_METALLIC_EDGE_COLOR, keys.mMetallicEdgeColor, tls, state));
     }
 }
 
@@ -1479,14 +1777,14 @@ resolveTransmissionParams(const DwaBase* me,
         (castsCaustics || !state.isCausticPath())) {
         // Evaluate roughness here if specular params are not required
         if (!hints.mRequiresSpecularParams) {
-            params.mRoughness = saturate(evalFloat(me, keys.mRoughness, tls, state));
+            params.mRoughness = saturate(evalFoldedFloat(me, ispc::DWABASE_FOLDED_ROUGHNESS, keys.mRoughness, tls, state));
         }
         if (ispcDwaBase.mModel == ispc::Model::Refractive) {
             params.mTransmission = 1.0f;
         } else {
-            params.mTransmission = saturate(evalFloat(me, keys.mTransmission, tls, state));
+            params.mTransmission = saturate(evalFoldedFloat(me, ispc::DWABASE_FOLDED_TRANSMISSION, keys.mTransmission, tls, state));
         }
-        asCpp(params.mTransmissionColor) = clamp(evalColor(me, keys.mTransmissionColor, tls, state));
+        asCpp(params.mTransmissionColor) = clamp(evalFoldedColor(me, ispc::DWABASE_FOLDED_TRANSMISSION_COLOR, keys.mTransmissionColor, tls, state));
 
         if (hints.mRequiresTransmissionRefractiveIndex) {
             params.mUseIndependentTransmissionRefractiveIndex = true;
@@ -1657,8 +1955,9 @@ DwaBase::resolveParameters(moonray::shading::TLState *tls,
     // mThinGeometry
     // mPreventLightCulling
 
-    // make sure all fields are initialized
-    DwaBaseLayerable::initParameters(params);
+    // make sure all fields are initialized, except for the bulk of the
+    // lobe families the hints rule out
+    DwaBaseLayerable::initParameters(params, mIspc.mHints.mLobeFamilies);
 
     // We want to avoid evaluating any attributes which are not ultimately needed,
     // especially in the context of indirect or caustic light paths.  We use the
@@ -1682,17 +1981,17 @@ DwaBase::resolveParameters(moonray::shading::TLState *tls,
     resolveFabricSpecularParams(this, tls, state, castsCaustics, mIspc, mIspc.mHints, mAttrKeys, params);
 
     if (mIspc.mHints.mRequiresDiffuseParams) {
-        asCpp(params.mAlbedo) = clamp(evalColor(this, mAttrKeys.mAlbedo, tls, state));
+        asCpp(params.mAlbedo) = clamp(evalFoldedColor(this, ispc::DWABASE_FOLDED_ALBEDO, mAttrKeys.mAlbedo, tls, state));
     }
 
     if (mIspc.mHints.mRequiresDiffuseParams || mIspc.mHints.mRequiresToonDiffuseParams) {
-        params.mDiffuseRoughness = saturate(evalFloat(this, mAttrKeys.mDiffuseRoughness, tls, state));
+        params.mDiffuseRoughness = saturate(evalFoldedFloat(this, ispc::DWABASE_FOLDED_DIFFUSE_ROUGHNESS, mAttrKeys.mDiffuseRoughness, tls, state));
     }
 
     if (mIspc.mHints.mRequiresSubsurfaceParams && state.isSubsurfaceAllowed()) {
         asCpp(params.mScatteringRadius) =
-            clamp(evalColor(this, mAttrKeys.mScatteringColor, tls, state)) *
-            max(0.0f, evalFloat(this, mAttrKeys.mScatteringRadius, tls, state));
+            clamp(evalFoldedColor(this, ispc::DWABASE_FOLDED_SCATTERING_COLOR, mAttrKeys.mScatteringColor, tls, state)) *
+            max(0.0f, evalFoldedFloat(this, ispc::DWABASE_FOLDED_SCATTERING_RADIUS, mAttrKeys.mScatteringRadius, tls, state));
         params.mCreaseAttenuation = max(0.0f, mAttrKeys.mCreaseAttenuation.isValid() ?
                 get(mAttrKeys.mCreaseAttenuation) : 0.0f);
         params.mSubsurfaceTraceSet = (ispc::TraceSet *)get(mAttrKeys.mSubsurfaceTraceSet);
@@ -1701,15 +2000,15 @@ DwaBase::resolveParameters(moonray::shading::TLState *tls,
     }
 
     if (mIspc.mHints.mRequiresDiffuseTransmissionParams) {
-        const float diffuseTransmission = clamp(evalFloat(this, mAttrKeys.mDiffuseTransmission, tls, state),
+        const float diffuseTransmission = clamp(evalFoldedFloat(this, ispc::DWABASE_FOLDED_DIFFUSE_TRANSMISSION, mAttrKeys.mDiffuseTransmission, tls, state),
                                                 0.0f, 1.0f);
         asCpp(params.mDiffuseTransmission) = diffuseTransmission *
-                                             clamp(evalColor(this, mAttrKeys.mDiffuseTransmissionColor, tls, state));
+                                             clamp(evalFoldedColor(this, ispc::DWABASE_FOLDED_DIFFUSE_TRANSMISSION_COLOR, mAttrKeys.mDiffuseTransmissionColor, tls, state));
         params.mDiffuseTransmissionBlendingBehavior = get(mAttrKeys.mDiffuseTransmissionBlendingBehavior);
     }
 
     if (mIspc.mHints.mRequiresEmissionParams) {
-        asCpp(params.mEmission) = max(sBlack, evalColor(this, mAttrKeys.mEmission, tls, state));
+        asCpp(params.mEmission) = max(sBlack, evalFoldedColor(this, ispc::DWABASE_FOLDED_EMISSION, mAttrKeys.mEmission, tls, state));
     }
 
     params.mDiffuseLightSet = mIspc.mDiffuseLightSet;
@@ -1743,7 +2042,7 @@ DwaBase::resolvePresence(moonray::shading::TLState *tls,
                          const State& state) const
 {
     if (mAttrKeys.mPresence.isValid()) {
-        return saturate(evalFloat(this, mAttrKeys.mPresence, tls, state));
+        return saturate(evalFoldedFloat(this, ispc::DWABASE_FOLDED_PRESENCE, mAttrKeys.mPresence, tls, state));
     }
     return 1.f;
 }
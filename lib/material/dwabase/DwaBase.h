@@ -46,6 +46,7 @@ namespace dwabase {
     keys.mGlitterSpace                       = attrGlitterSpace;                        \
     keys.mGlitterRandomness                  = attrGlitterRandomness;                   \
     keys.mGlitterDenseLodQuality             = attrGlitterLodQuality;                   \
+    keys.mGlitterFlakeCacheCellFactor        = attrGlitterFlakeCacheCellFactor;         \
     keys.mGlitterLayeringMode                = attrGlitterLayeringMode;                 \
     keys.mGlitterFlakeTextureA               = attrGlitterTextureA;                     \
     keys.mGlitterFlakeTextureB               = attrGlitterTextureB;                     \
@@ -181,6 +182,7 @@ struct DwaBaseAttributeKeys
     scene_rdl2::rdl2::AttributeKey<scene_rdl2::rdl2::Int>     mGlitterSpace;
     scene_rdl2::rdl2::AttributeKey<scene_rdl2::rdl2::Float>   mGlitterRandomness;
     scene_rdl2::rdl2::AttributeKey<scene_rdl2::rdl2::Float>   mGlitterDenseLodQuality;
+    scene_rdl2::rdl2::AttributeKey<scene_rdl2::rdl2::Float>   mGlitterFlakeCacheCellFactor;
     scene_rdl2::rdl2::AttributeKey<scene_rdl2::rdl2::Bool>    mGlitterDecoupleFlakeSize;
     scene_rdl2::rdl2::AttributeKey<scene_rdl2::rdl2::Int>     mGlitterLayeringMode;
     scene_rdl2::rdl2::AttributeKey<scene_rdl2::rdl2::String>  mGlitterFlakeTextureA;
@@ -385,6 +387,10 @@ public:
 
     void updateIridescence();
 
+    // Evaluates the attributes bound to constant map networks once, so
+    // that resolveParameters() does not sample those maps
+    void foldAttributes();
+
     bool getCastsCaustics() const override
     {
         return mAttrKeys.mCastsCaustics.isValid() && get(mAttrKeys.mCastsCaustics);
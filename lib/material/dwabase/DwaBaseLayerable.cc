@@ -140,7 +140,8 @@ DwaBaseLayerable::createLobes(const DwaBaseLayerable * const dwaBaseLayerable,
     // setup iridescence if needed
     const moonray::shading::Iridescence * iridescence = nullptr;
     const ispc::IridescenceParameters &iridescenceParams = params.mIridescenceParameters;
-    if (!scene_rdl2::math::isZero(iridescenceParams.mIridescence)) {
+    if ((params.mLobeFamilies & ispc::LOBE_FAMILY_IRIDESCENCE) &&
+        !scene_rdl2::math::isZero(iridescenceParams.mIridescence)) {
         // Cast to CPP Type
         if (iridescenceParams.mIridescenceColorControl == ispc::SHADING_IRIDESCENCE_COLOR_USE_HUE_INTERPOLATION) {
             iridescence = arena->allocWithArgs<moonray::shading::Iridescence>(
@@ -185,7 +186,8 @@ DwaBaseLayerable::createLobes(const DwaBaseLayerable * const dwaBaseLayerable,
     }
 
     // Glitter lobes
-    if (!scene_rdl2::math::isZero(params.mGlitterVaryingParameters.mGlitterMask)) {
+    if ((params.mLobeFamilies & ispc::LOBE_FAMILY_GLITTER) &&
+        !scene_rdl2::math::isZero(params.mGlitterVaryingParameters.mGlitterMask)) {
         bool exitEarly = false;
         addGlitterLobes(dwaBaseLayerable, builder, tls, state, params, labels, exitEarly, eventMessages, specularLightSet);
         if (exitEarly) return;
@@ -249,7 +251,8 @@ DwaBaseLayerable::createLobes(const DwaBaseLayerable * const dwaBaseLayerable,
     }
 
     // Hair toon specular 1
-    if (!scene_rdl2::math::isZero(params.mHairToonS1Params.mToonSpecular)) {
+    if ((params.mLobeFamilies & ispc::LOBE_FAMILY_HAIR_TOON) &&
+        !scene_rdl2::math::isZero(params.mHairToonS1Params.mToonSpecular)) {
         if (uParams.mHairToonS1Model == ispc::ToonSpecularModel::ToonSpecularSurface) {
             addToonSpecularLobes(builder,
                                  params.mHairToonS1Params,
@@ -264,7 +267,8 @@ DwaBaseLayerable::createLobes(const DwaBaseLayerable * const dwaBaseLayerable,
     }
 
     // Hair toon specular 2
-    if (!scene_rdl2::math::isZero(params.mHairToonS2Params.mToonSpecular)) {
+    if ((params.mLobeFamilies & ispc::LOBE_FAMILY_HAIR_TOON) &&
+        !scene_rdl2::math::isZero(params.mHairToonS2Params.mToonSpecular)) {
         if (uParams.mHairToonS2Model == ispc::ToonSpecularModel::ToonSpecularSurface) {
             addToonSpecularLobes(builder,
                                  params.mHairToonS2Params,
@@ -279,7 +283,8 @@ DwaBaseLayerable::createLobes(const DwaBaseLayerable * const dwaBaseLayerable,
     }
 
     // Hair toon specular 3
-    if (!scene_rdl2::math::isZero(params.mHairToonS3Params.mToonSpecular)) {
+    if ((params.mLobeFamilies & ispc::LOBE_FAMILY_HAIR_TOON) &&
+        !scene_rdl2::math::isZero(params.mHairToonS3Params.mToonSpecular)) {
         if (uParams.mHairToonS3Model == ispc::ToonSpecularModel::ToonSpecularSurface) {
             addToonSpecularLobes(builder,
                                  params.mHairToonS3Params,
@@ -396,7 +401,8 @@ DwaBaseLayerable::createLobes(const DwaBaseLayerable * const dwaBaseLayerable,
         builder.startAdjacentComponents();
 
         // Toon Specular
-        if (!scene_rdl2::math::isZero(params.mToonSpecularParams.mToonSpecular)) {
+        if ((params.mLobeFamilies & ispc::LOBE_FAMILY_TOON) &&
+            !scene_rdl2::math::isZero(params.mToonSpecularParams.mToonSpecular)) {
             const ispc::ToonSpecularParameters& toonParams = params.mToonSpecularParams;
 
             addToonSpecularLobes(builder,
@@ -698,117 +704,334 @@ applyColorCorrections(const float hueShift,
     }
 }
 
-void
-DwaBaseLayerable::applyColorCorrectParameters(moonray::shading::TLState *tls,
-                                              const moonray::shading::State &state,
-                                              ispc::DwaBaseParameters &params) const
+// m * c, for a row major m
+static Color
+transformColor(const float (&m)[9], const Color& c)
 {
-    // We'll apply color correction to these particular params.
-    // Use pointer array to allow for processing them in a loop.
-    // We'll also apply color correction to emission later....
+    return Color(m[0] * c.r + m[1] * c.g + m[2] * c.b,
+                 m[3] * c.r + m[4] * c.g + m[5] * c.b,
+                 m[6] * c.r + m[7] * c.g + m[8] * c.b);
+}
 
-    #define NUM_COLOR_ARRAY_ELEMS 15
-    Color * colors[NUM_COLOR_ARRAY_ELEMS] = {
-        asCpp(&params.mFuzzAlbedo),
-        asCpp(&params.mMetallicColor),
-        asCpp(&params.mMetallicEdgeColor),
-        asCpp(&params.mWarpColor),
-        asCpp(&params.mWeftColor),
-        asCpp(&params.mTransmissionColor),
-        asCpp(&params.mAlbedo),
-        asCpp(&params.mDiffuseTransmission),
-        asCpp(&params.mHairParameters.mHairDiffuseFrontColor),
-        asCpp(&params.mHairParameters.mHairDiffuseBackColor),
-        asCpp(&params.mToonSpecularParams.mTint),
-        asCpp(&params.mAccentParams.mSubsurfaceColor),
-        asCpp(&params.mScatteringRadius),
-        asCpp(&params.mIridescenceParameters.mIridescencePrimaryColor),
-        asCpp(&params.mIridescenceParameters.mIridescenceSecondaryColor)
+// result = a * b, result may alias b
+static void
+multiplyMatrices(const float (&a)[9], const float (&b)[9], float (&result)[9])
+{
+    float m[9];
+    for (int row = 0; row < 3; ++row) {
+        for (int col = 0; col < 3; ++col) {
+            m[row * 3 + col] = a[row * 3 + 0] * b[0 * 3 + col] +
+                               a[row * 3 + 1] * b[1 * 3 + col] +
+                               a[row * 3 + 2] * b[2 * 3 + col];
+        }
+    }
+    for (int i = 0; i < 9; ++i) {
+        result[i] = m[i];
+    }
+}
+
+bool
+DwaBaseLayerable::compileColorCorrection(const ispc::ColorCorrectParameters &cc,
+                                         ispc::ColorCorrectMatrix &compiled)
+{
+    // Saturation blends the color with its luminance and gain scales it,
+    // and mixing with the original color is a blend too, so a correction
+    // made only of those is linear. A hue shift, done in hsv, is not, and
+    // neither is TMI in general, so those keep the step by step path.
+    if (!isZero(cc.mHueShift) || cc.mTmiEnabled) {
+        return false;
+    }
+
+    const auto correct = [&cc](Color c) {
+        const Color original = c;
+        applyColorCorrections(cc.mHueShift,
+                              cc.mSaturation,
+                              cc.mGain,
+                              cc.mTmiEnabled,
+                              asCpp(cc.mTmi),
+                              c);
+        return lerpOpt(original, c, cc.mMix);
     };
 
-    for (size_t cc = 0; cc < params.mNumColorCorrections; ++cc) {
-        if (!params.mColorCorrectParams[cc].mOn) { continue; }
+    // The columns of the matrix are the corrected primaries
+    const Color columns[3] = {
+        correct(Color(1.0f, 0.0f, 0.0f)),
+        correct(Color(0.0f, 1.0f, 0.0f)),
+        correct(Color(0.0f, 0.0f, 1.0f))
+    };
+    float (&m)[9] = compiled.mMatrix;
+    for (int col = 0; col < 3; ++col) {
+        m[0 * 3 + col] = columns[col].r;
+        m[1 * 3 + col] = columns[col].g;
+        m[2 * 3 + col] = columns[col].b;
+    }
+
+    bool positive = true;
+    bool unitRange = true;
+    for (int row = 0; row < 3; ++row) {
+        positive = positive && m[row * 3 + 0] >= 0.0f && m[row * 3 + 1] >= 0.0f && m[row * 3 + 2] >= 0.0f;
+        unitRange = unitRange && m[row * 3 + 0] + m[row * 3 + 1] + m[row * 3 + 2] <= 1.0f;
+    }
+    compiled.mPreservesPositive = positive;
+    compiled.mPreservesUnitRange = positive && unitRange;
+    return true;
+}
 
-        if (isZero(params.mColorCorrectParams[cc].mMix)) { continue; }
+// A run of compiled color corrections, folded into as few matrices as the
+// clamps that follow each correction allow. A clamp can be dropped, and the
+// next correction folded into the matrix before it, when the input of the
+// matrix was already clamped and every correction in it keeps clamped
+// colors in range, since the clamp then changes nothing.
+struct FoldedColorCorrection
+{
+    float mMatrix[9];
+    bool mPending = false;
+    bool mCanFold = false;
+};
 
+#define NUM_COLOR_ARRAY_ELEMS 15
 
-        // process refl/trans values
-        for (uint8_t i = 0; i < NUM_COLOR_ARRAY_ELEMS; ++i) {
-            Color& c = *colors[i];
-            const Color original = c;
-            applyColorCorrections(params.mColorCorrectParams[cc].mHueShift,
-                                  params.mColorCorrectParams[cc].mSaturation,
-                                  params.mColorCorrectParams[cc].mGain,
-                                  params.mColorCorrectParams[cc].mTmiEnabled,
-                                  asCpp(params.mColorCorrectParams[cc].mTmi),
-                                  c);
-            c = lerpOpt(original, c, params.mColorCorrectParams[cc].mMix);
+// The colors clamped to [0,1] by every color correction
+struct ColorCorrectTargets
+{
+    Color* mColors[NUM_COLOR_ARRAY_ELEMS];
+    uint8_t mNumColors;
+    bool mToonRamp;
+    bool mIridescenceRamp;
+};
 
-            // clamp refl/trans vals to [0,1]
+static void
+transformTargets(const float (&m)[9],
+                 const ColorCorrectTargets& targets,
+                 ispc::DwaBaseParameters &params)
+{
+    for (uint8_t i = 0; i < targets.mNumColors; ++i) {
+        Color& c = *targets.mColors[i];
+        c = transformColor(m, c);
+        clampTo0(c);
+        clampTo1(c);
+    }
+    if (targets.mToonRamp) {
+        const int rampPts = params.mToonDiffuseParams.mRampNumPoints;
+        for (int i = 0; i < rampPts; ++i) {
+            Color& c = asCpp(params.mToonDiffuseParams.mRampColors[i]);
+            c = transformColor(m, c);
             clampTo0(c);
             clampTo1(c);
         }
+    }
+    if (targets.mIridescenceRamp) {
+        const int rampPts = params.mIridescenceParameters.mIridescenceRampNumPoints;
+        for (int i = 0; i < rampPts; ++i) {
+            Color& c = asCpp(params.mIridescenceParameters.mIridescenceRampColors[i]);
+            c = transformColor(m, c);
+            clampTo0(c);
+            clampTo1(c);
+        }
+    }
+}
 
-        // handle toon ramp, if present
-        if (!isZero(params.mToonDiffuseParams.mToonDiffuse) && 
-            params.mToonDiffuseParams.mModel == ispc::TOON_DIFFUSE_RAMP) {
-            const int rampPts = params.mToonDiffuseParams.mRampNumPoints;
-            for (int i = 0; i < rampPts; ++i) {
-                Color c = asCpp(params.mToonDiffuseParams.mRampColors[i]);
-                const Color original = c;
-                applyColorCorrections(params.mColorCorrectParams[cc].mHueShift,
-                                      params.mColorCorrectParams[cc].mSaturation,
-                                      params.mColorCorrectParams[cc].mGain,
-                                      params.mColorCorrectParams[cc].mTmiEnabled,
-                                      asCpp(params.mColorCorrectParams[cc].mTmi),
-                                      c);
-                c = lerpOpt(original, c, params.mColorCorrectParams[cc].mMix);
-
-                // clamp refl/trans vals to [0,1]
-                clampTo0(c);
-                clampTo1(c);
-                asCpp(params.mToonDiffuseParams.mRampColors[i]) = c;
-            }
+static void
+applyFoldedColorCorrection(const FoldedColorCorrection& folded,
+                           const ColorCorrectTargets& targets,
+                           ispc::DwaBaseParameters &params,
+                           const bool emission)
+{
+    if (!folded.mPending) {
+        return;
+    }
+    if (emission) {
+        Color& c = asCpp(params.mEmission);
+        c = transformColor(folded.mMatrix, c);
+        clampTo0(c);
+    } else {
+        transformTargets(folded.mMatrix, targets, params);
+    }
+}
+
+// Add a compiled correction to the pending matrix, or apply that matrix and
+// start a new one
+static void
+foldColorCorrection(const float (&matrix)[9],
+                    const bool inputClamped,
+                    const bool preservesRange,
+                    const ColorCorrectTargets& targets,
+                    ispc::DwaBaseParameters &params,
+                    const bool emission,
+                    FoldedColorCorrection& folded)
+{
+    if (folded.mCanFold) {
+        multiplyMatrices(matrix, folded.mMatrix, folded.mMatrix);
+    } else {
+        applyFoldedColorCorrection(folded, targets, params, emission);
+        for (int i = 0; i < 9; ++i) {
+            folded.mMatrix[i] = matrix[i];
         }
+        folded.mPending = true;
+    }
+    folded.mCanFold = (folded.mCanFold || inputClamped) && preservesRange;
+}
 
-        // handle iridescence ramp, if present
-        if (!isZero(params.mIridescenceParameters.mIridescence) &&
-            params.mIridescenceParameters.mIridescenceColorControl == ispc::SHADING_IRIDESCENCE_COLOR_USE_RAMP) {
-            const int rampPts = params.mIridescenceParameters.mIridescenceRampNumPoints;
-            for (uint8_t i = 0; i < rampPts; ++i) {
-                Color c = asCpp(params.mIridescenceParameters.mIridescenceRampColors[i]);
-                const Color original = c;
-                applyColorCorrections(params.mColorCorrectParams[cc].mHueShift,
-                                      params.mColorCorrectParams[cc].mSaturation,
-                                      params.mColorCorrectParams[cc].mGain,
-                                      params.mColorCorrectParams[cc].mTmiEnabled,
-                                      asCpp(params.mColorCorrectParams[cc].mTmi),
-                                      c);
-                c = lerpOpt(original, c, params.mColorCorrectParams[cc].mMix);
-
-                // clamp refl/trans vals to [0,1]
-                clampTo0(c);
-                clampTo1(c);
-                asCpp(params.mIridescenceParameters.mIridescenceRampColors[i]) = c;
-            }
+// Apply the pending matrices, if any
+static void
+flushFoldedColorCorrections(const ColorCorrectTargets& targets,
+                            ispc::DwaBaseParameters &params,
+                            FoldedColorCorrection& folded,
+                            FoldedColorCorrection& foldedEmission)
+{
+    applyFoldedColorCorrection(folded, targets, params, false);
+    applyFoldedColorCorrection(foldedEmission, targets, params, true);
+    folded.mPending = folded.mCanFold = false;
+    foldedEmission.mPending = foldedEmission.mCanFold = false;
+}
+
+// Apply a correction that is not compiled, one step at a time
+static void
+applyColorCorrection(const ispc::ColorCorrectParameters &cc,
+                     const ColorCorrectTargets& targets,
+                     ispc::DwaBaseParameters &params)
+{
+    // process refl/trans values
+    for (uint8_t i = 0; i < targets.mNumColors; ++i) {
+        Color& c = *targets.mColors[i];
+        const Color original = c;
+        applyColorCorrections(cc.mHueShift,
+                              cc.mSaturation,
+                              cc.mGain,
+                              cc.mTmiEnabled,
+                              asCpp(cc.mTmi),
+                              c);
+        c = lerpOpt(original, c, cc.mMix);
+
+        // clamp refl/trans vals to [0,1]
+        clampTo0(c);
+        clampTo1(c);
+    }
+
+    // handle toon ramp, if present
+    if (targets.mToonRamp) {
+        const int rampPts = params.mToonDiffuseParams.mRampNumPoints;
+        for (int i = 0; i < rampPts; ++i) {
+            Color c = asCpp(params.mToonDiffuseParams.mRampColors[i]);
+            const Color original = c;
+            applyColorCorrections(cc.mHueShift,
+                                  cc.mSaturation,
+                                  cc.mGain,
+                                  cc.mTmiEnabled,
+                                  asCpp(cc.mTmi),
+                                  c);
+            c = lerpOpt(original, c, cc.mMix);
+
+            // clamp refl/trans vals to [0,1]
+            clampTo0(c);
+            clampTo1(c);
+            asCpp(params.mToonDiffuseParams.mRampColors[i]) = c;
         }
+    }
 
-        // handle emission separately, don't clamp at 1.0
-        {
-            Color& c = asCpp(params.mEmission);
+    // handle iridescence ramp, if present
+    if (targets.mIridescenceRamp) {
+        const int rampPts = params.mIridescenceParameters.mIridescenceRampNumPoints;
+        for (uint8_t i = 0; i < rampPts; ++i) {
+            Color c = asCpp(params.mIridescenceParameters.mIridescenceRampColors[i]);
             const Color original = c;
-            applyColorCorrections(params.mColorCorrectParams[cc].mHueShift,
-                                  params.mColorCorrectParams[cc].mSaturation,
-                                  params.mColorCorrectParams[cc].mGain,
-                                  params.mColorCorrectParams[cc].mTmiEnabled,
-                                  asCpp(params.mColorCorrectParams[cc].mTmi),
+            applyColorCorrections(cc.mHueShift,
+                                  cc.mSaturation,
+                                  cc.mGain,
+                                  cc.mTmiEnabled,
+                                  asCpp(cc.mTmi),
                                   c);
-            c = lerpOpt(original, c, params.mColorCorrectParams[cc].mMix);
+            c = lerpOpt(original, c, cc.mMix);
 
-            // clamp emission to [0,inf]
+            // clamp refl/trans vals to [0,1]
             clampTo0(c);
+            clampTo1(c);
+            asCpp(params.mIridescenceParameters.mIridescenceRampColors[i]) = c;
+        }
+    }
+
+    // handle emission separately, don't clamp at 1.0
+    {
+        Color& c = asCpp(params.mEmission);
+        const Color original = c;
+        applyColorCorrections(cc.mHueShift,
+                              cc.mSaturation,
+                              cc.mGain,
+                              cc.mTmiEnabled,
+                              asCpp(cc.mTmi),
+                              c);
+        c = lerpOpt(original, c, cc.mMix);
+
+        // clamp emission to [0,inf]
+        clampTo0(c);
+    }
+}
+
+void
+DwaBaseLayerable::applyColorCorrectParameters(moonray::shading::TLState *tls,
+                                              const moonray::shading::State &state,
+                                              ispc::DwaBaseParameters &params) const
+{
+    // We'll apply color correction to these particular params.
+    // Use pointer array to allow for processing them in a loop.
+    // We'll also apply color correction to emission later....
+    ColorCorrectTargets targets = {
+        {
+            asCpp(&params.mFuzzAlbedo),
+            asCpp(&params.mMetallicColor),
+            asCpp(&params.mMetallicEdgeColor),
+            asCpp(&params.mWarpColor),
+            asCpp(&params.mWeftColor),
+            asCpp(&params.mTransmissionColor),
+            asCpp(&params.mAlbedo),
+            asCpp(&params.mDiffuseTransmission),
+            asCpp(&params.mHairParameters.mHairDiffuseFrontColor),
+            asCpp(&params.mHairParameters.mHairDiffuseBackColor),
+            asCpp(&params.mAccentParams.mSubsurfaceColor),
+            asCpp(&params.mScatteringRadius)
+        },
+        12,
+        !isZero(params.mToonDiffuseParams.mToonDiffuse) &&
+            params.mToonDiffuseParams.mModel == ispc::TOON_DIFFUSE_RAMP,
+        !isZero(params.mIridescenceParameters.mIridescence) &&
+            params.mIridescenceParameters.mIridescenceColorControl == ispc::SHADING_IRIDESCENCE_COLOR_USE_RAMP
+    };
+    // The colors of the families not in use are left uninitialized
+    if (params.mLobeFamilies & ispc::LOBE_FAMILY_TOON) {
+        targets.mColors[targets.mNumColors++] = asCpp(&params.mToonSpecularParams.mTint);
+    }
+    if (params.mLobeFamilies & ispc::LOBE_FAMILY_IRIDESCENCE) {
+        targets.mColors[targets.mNumColors++] = asCpp(&params.mIridescenceParameters.mIridescencePrimaryColor);
+        targets.mColors[targets.mNumColors++] = asCpp(&params.mIridescenceParameters.mIridescenceSecondaryColor);
+    }
+
+    // Consecutive compiled corrections are folded together, see
+    // FoldedColorCorrection, separately for emission which is only
+    // clamped to [0,inf]
+    FoldedColorCorrection folded, foldedEmission;
+    // Whether a correction, and so its clamp, has been applied yet
+    bool clamped = false;
+
+    for (size_t cc = 0; cc < params.mNumColorCorrections; ++cc) {
+        const ispc::ColorCorrectParameters &ccParams = params.mColorCorrectParams[cc];
+        if (!ccParams.mOn) { continue; }
+
+        if (isZero(ccParams.mMix)) { continue; }
+
+        if (ccParams.mCompiled) {
+            const ispc::ColorCorrectMatrix &compiled =
+                *reinterpret_cast<const ispc::ColorCorrectMatrix *>(ccParams.mCompiled);
+            foldColorCorrection(compiled.mMatrix, clamped, compiled.mPreservesUnitRange,
+                                targets, params, false, folded);
+            foldColorCorrection(compiled.mMatrix, clamped, compiled.mPreservesPositive,
+                                targets, params, true, foldedEmission);
+        } else {
+            flushFoldedColorCorrections(targets, params, folded, foldedEmission);
+            applyColorCorrection(ccParams, targets, params);
         }
+        clamped = true;
     }
+    flushFoldedColorCorrections(targets, params, folded, foldedEmission);
 }
 
 
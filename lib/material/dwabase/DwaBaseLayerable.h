@@ -31,6 +31,7 @@ finline std::ostream& operator<<(std::ostream& os,
         << "mFlakeRandomness: " << p.mFlakeRandomness << "\n"
         << "mDenseGlitterLodQuality: " << p.mDenseGlitterLodQuality << "\n"
         << "mSearchRadiusFactor: " << p.mSearchRadiusFactor << "\n"
+        << "mFlakeCacheCellFactor: " << p.mFlakeCacheCellFactor << "\n"
         << "mLayeringMode: " << p.mLayeringMode << "\n";
 }
 
@@ -447,6 +448,7 @@ public:
 
         registerShadeTimeEventMessages();
         mIspc.mScatterTagKey = moonray::shading::StandardAttributes::sScatterTag;
+        mIspc.mLobeFamilies = ispc::LOBE_FAMILY_ALL;
     }
 
     virtual ~DwaBaseLayerable() { }
@@ -467,6 +469,21 @@ public:
     // Otherwise, if only 1 submaterial has glitter then its values can be used.
     virtual bool hasGlitter() const { return false; }
 
+    // The lobe families, ispc::DwaBaseLobeFamily bits, that this material can
+    // produce. Every material sets them in update() from its own hints or
+    // from its sub-materials, which are updated first, so they are
+    // aggregated bottom-up through any layering. Layering materials use them
+    // to skip blending the families no leaf below them produces, and they
+    // are also visible to ISPC through DWABASELAYERABLE_getLobeFamilies().
+    // Materials that can't tell report every family.
+    int getLobeFamilies() const { return mIspc.mLobeFamilies; }
+
+    // The families of a sub-material, none when it isn't bound
+    static int getLobeFamilies(const DwaBaseLayerable* layerable)
+    {
+        return layerable ? layerable->getLobeFamilies() : 0;
+    }
+
     friend std::ostream& operator<<(std::ostream& os, const ispc::DwaBaseParameters& p);
 
     finline static void
@@ -1107,6 +1124,14 @@ public:
 
     finline static void
     initParameters(ispc::DwaBaseParameters &params)
+    {
+        initParameters(params, ispc::LOBE_FAMILY_ALL);
+    }
+
+    // Only initializes the weights of the lobe families not in lobeFamilies,
+    // see DwaBaseLobeFamily
+    finline static void
+    initParameters(ispc::DwaBaseParameters &params, int lobeFamilies)
     {
         // The following uniform params are set in update:
         // mOuterSpecularModel
@@ -1116,21 +1141,44 @@ public:
         // mThinGeometry
         // mPreventLightCulling
 
+        params.mLobeFamilies = lobeFamilies;
+
         // Glitter params
         params.mGlitterUniformParameters = nullptr;
-        initGlitterVaryingParameters(params.mGlitterVaryingParameters);
+        if (lobeFamilies & ispc::LOBE_FAMILY_GLITTER) {
+            initGlitterVaryingParameters(params.mGlitterVaryingParameters);
+        } else {
+            params.mGlitterVaryingParameters.mGlitterMask = 0.0f;
+        }
 
         // Hair params
         initHairParameters(params.mHairParameters);
 
         // Hair Toon params
-        initToonSpecularParameters(params.mHairToonS1Params);
-        initToonSpecularParameters(params.mHairToonS2Params);
-        initToonSpecularParameters(params.mHairToonS3Params);
+        if (lobeFamilies & ispc::LOBE_FAMILY_HAIR_TOON) {
+            initToonSpecularParameters(params.mHairToonS1Params);
+            initToonSpecularParameters(params.mHairToonS2Params);
+            initToonSpecularParameters(params.mHairToonS3Params);
+        } else {
+            params.mHairToonS1Params.mToonSpecular = 0.0f;
+            params.mHairToonS2Params.mToonSpecular = 0.0f;
+            params.mHairToonS3Params.mToonSpecular = 0.0f;
+        }
 
         // Toon params
-        initToonDiffuseParameters(params.mToonDiffuseParams);
-        initToonSpecularParameters(params.mToonSpecularParams);
+        if (lobeFamilies & ispc::LOBE_FAMILY_TOON) {
+            initToonDiffuseParameters(params.mToonDiffuseParams);
+            initToonSpecularParameters(params.mToonSpecularParams);
+        } else {
+            // the diffuse lobe reads these whether there is toon diffuse or not
+            params.mToonDiffuseParams.mToonDiffuse = 0.0f;
+            params.mToonDiffuseParams.mModel = ispc::TOON_DIFFUSE_OREN_NAYAR;
+            params.mToonDiffuseParams.mTerminatorShift = 0.0f;
+            params.mToonDiffuseParams.mFlatness = 0.0f;
+            params.mToonDiffuseParams.mFlatnessFalloff = 0.0f;
+            scene_rdl2::math::asCpp(params.mToonDiffuseParams.mNormal) = scene_rdl2::math::Vec3f(0.0f, 0.0f, 0.0f);
+            params.mToonSpecularParams.mToonSpecular = 0.0f;
+        }
 
         // Fuzz params
         params.mFuzz = 0.0f;
@@ -1175,7 +1223,12 @@ public:
         params.mFabricAttenuation = 1.0f;
 
         // iridescence params
-        initIridescenceParameters(params.mIridescenceParameters);
+        if (lobeFamilies & ispc::LOBE_FAMILY_IRIDESCENCE) {
+            initIridescenceParameters(params.mIridescenceParameters);
+        } else {
+            params.mIridescenceParameters.mIridescence = 0.0f;
+            params.mIridescenceParameters.mIridescenceApplyTo = ispc::IRIDESCENCE_PRIMARY_SPECULAR;
+        }
 
         // transmission params
         params.mTransmission = 0.0f;
@@ -1225,6 +1278,7 @@ public:
             params.mColorCorrectParams[i].mGain = 1.0f;
             params.mColorCorrectParams[i].mTmiEnabled = false;
             scene_rdl2::math::asCpp(params.mColorCorrectParams[i].mTmi) = scene_rdl2::math::Color(0.0f, 0.0f, 0.0f);
+            params.mColorCorrectParams[i].mCompiled = 0;
         }
     }
 
@@ -1242,9 +1296,18 @@ public:
             dst.mColorCorrectParams[i].mTmiEnabled = src.mColorCorrectParams[i].mTmiEnabled;
             scene_rdl2::math::asCpp(dst.mColorCorrectParams[i].mTmi) =
                 scene_rdl2::math::asCpp(src.mColorCorrectParams[i].mTmi);
+            dst.mColorCorrectParams[i].mCompiled = src.mColorCorrectParams[i].mCompiled;
         }
     }
 
+    // Compiles cc, a single color correction, into compiled and returns
+    // true if it is a linear map of the color. Corrections that are not
+    // are applied one step at a time. Call this at update() time, for
+    // corrections whose parameters are not bound, and point the
+    // mCompiled field of every copy of cc at compiled.
+    static bool compileColorCorrection(const ispc::ColorCorrectParameters &cc,
+                                       ispc::ColorCorrectMatrix &compiled);
+
     // This function's job is to resolve the BSSRDF type
     // Keeping this separate to mimic the vectorized code which needs to evaluate
     // this uniform value separately.
@@ -1339,6 +1402,9 @@ public:
                                      const moonray::shading::State &state,
                                      ispc::DwaBaseParameters &params) const;
 
+protected:
+    void setLobeFamilies(int lobeFamilies) { mIspc.mLobeFamilies = lobeFamilies; }
+
 private:
     ispc::DwaBaseLayerable mIspc;
     ispc::DwaBaseLabels mLabels;
@@ -0,0 +1,190 @@
+// Copyright 2023-2024 DreamWorks Animation LLC
+// SPDX-License-Identifier: Apache-2.0
+
+/// @file FlakeCache.cc
+
+#include "FlakeCache.h"
+
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+
+namespace moonshine {
+namespace glitter {
+
+namespace {
+
+// Every live cache, plus the totals of the caches of exited threads
+std::mutex sRegistryMutex;
+std::vector<FlakeCache*> sRegistry;
+FlakeCache::Stats sRetiredStats;
+
+std::atomic<unsigned int> sNextGlitterId(0);
+
+// Returned for cached searches that found no flakes, since nullptr means a miss
+const ispc::GLITTER_CachedFlake sNoFlakes = {};
+
+// The key is written member by member on both the C++ and the ISPC side, and
+// is made of 32 bit members only, so there is no padding and whole keys can be
+// hashed and compared as words.
+static_assert(sizeof(ispc::GLITTER_FlakeCacheKey) % sizeof(uint32_t) == 0,
+              "GLITTER_FlakeCacheKey must be a whole number of 32 bit words");
+
+uint32_t
+hashKey(const ispc::GLITTER_FlakeCacheKey& key)
+{
+    constexpr size_t numWords = sizeof(key) / sizeof(uint32_t);
+    uint32_t words[numWords];
+    std::memcpy(words, &key, sizeof(key));
+
+    // FNV-1a over the words, then a final mix so that the low bits, which
+    // pick the set, depend on every word
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < numWords; ++i) {
+        h = (h ^ words[i]) * 16777619u;
+    }
+    h ^= h >> 16;
+    h *= 0x85ebca6bu;
+    h ^= h >> 13;
+    return h;
+}
+
+inline void
+increment(std::atomic<uint64_t>& counter)
+{
+    // Only the owning thread writes its counters
+    counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+} // anonymous namespace
+
+FlakeCache::FlakeCache() :
+    mClock(0),
+    mHits(0),
+    mMisses(0)
+{
+    std::lock_guard<std::mutex> lock(sRegistryMutex);
+    sRegistry.push_back(this);
+}
+
+FlakeCache::~FlakeCache()
+{
+    std::lock_guard<std::mutex> lock(sRegistryMutex);
+    sRetiredStats.mHits += mHits.load(std::memory_order_relaxed);
+    sRetiredStats.mMisses += mMisses.load(std::memory_order_relaxed);
+    sRegistry.erase(std::find(sRegistry.begin(), sRegistry.end(), this));
+}
+
+FlakeCache&
+FlakeCache::get()
+{
+    static thread_local FlakeCache sCache;
+    return sCache;
+}
+
+unsigned int
+FlakeCache::newGlitterId()
+{
+    return sNextGlitterId.fetch_add(1, std::memory_order_relaxed);
+}
+
+FlakeCache::Stats
+FlakeCache::getStats()
+{
+    std::lock_guard<std::mutex> lock(sRegistryMutex);
+    Stats stats = sRetiredStats;
+    for (const FlakeCache* cache : sRegistry) {
+        stats.mHits += cache->mHits.load(std::memory_order_relaxed);
+        stats.mMisses += cache->mMisses.load(std::memory_order_relaxed);
+    }
+    return stats;
+}
+
+void
+FlakeCache::resetStats()
+{
+    std::lock_guard<std::mutex> lock(sRegistryMutex);
+    sRetiredStats = Stats();
+    for (FlakeCache* cache : sRegistry) {
+        cache->mHits.store(0, std::memory_order_relaxed);
+        cache->mMisses.store(0, std::memory_order_relaxed);
+    }
+}
+
+FlakeCache::Entry*
+FlakeCache::getSet(const ispc::GLITTER_FlakeCacheKey& key)
+{
+    return mEntries + (hashKey(key) % sNumSets) * sNumWays;
+}
+
+const ispc::GLITTER_CachedFlake*
+FlakeCache::find(const ispc::GLITTER_FlakeCacheKey& key,
+                 unsigned int& count)
+{
+    Entry* set = getSet(key);
+    for (unsigned int way = 0; way < sNumWays; ++way) {
+        Entry& entry = set[way];
+        if (entry.mLastUse != 0 && std::memcmp(&entry.mKey, &key, sizeof(key)) == 0) {
+            entry.mLastUse = ++mClock;
+            increment(mHits);
+            count = static_cast<unsigned int>(entry.mFlakes.size());
+            return entry.mFlakes.empty() ? &sNoFlakes : entry.mFlakes.data();
+        }
+    }
+    increment(mMisses);
+    return nullptr;
+}
+
+ispc::GLITTER_CachedFlake*
+FlakeCache::insert(const ispc::GLITTER_FlakeCacheKey& key,
+                   unsigned int count)
+{
+    if (count > sMaxFlakes) {
+        return nullptr;
+    }
+
+    // Reuse the entry already holding key, if any, otherwise the least
+    // recently used one. Empty entries have the oldest use of all.
+    Entry* set = getSet(key);
+    Entry* victim = set;
+    for (unsigned int way = 0; way < sNumWays; ++way) {
+        Entry& entry = set[way];
+        if (entry.mLastUse != 0 && std::memcmp(&entry.mKey, &key, sizeof(key)) == 0) {
+            victim = &entry;
+            break;
+        }
+        if (entry.mLastUse < victim->mLastUse) {
+            victim = &entry;
+        }
+    }
+
+    victim->mKey = key;
+    victim->mLastUse = ++mClock;
+    // The vector keeps its capacity, so a warm cache does not allocate
+    victim->mFlakes.resize(count);
+    return victim->mFlakes.data();
+}
+
+//----------------------------------------------------------------------------
+
+extern "C" {
+
+const ispc::GLITTER_CachedFlake*
+GLITTER_findCachedFlakes(const ispc::GLITTER_FlakeCacheKey* key,
+                         unsigned int* count)
+{
+    return FlakeCache::get().find(*key, *count);
+}
+
+ispc::GLITTER_CachedFlake*
+GLITTER_cacheFlakes(const ispc::GLITTER_FlakeCacheKey* key,
+                    unsigned int count)
+{
+    return FlakeCache::get().insert(*key, count);
+}
+
+} // extern "C"
+
+} // namespace glitter
+} // namespace moonshine
+
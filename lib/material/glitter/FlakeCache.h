@@ -0,0 +1,79 @@
+// Copyright 2023-2024 DreamWorks Animation LLC
+// SPDX-License-Identifier: Apache-2.0
+
+/// @file FlakeCache.h
+
+#pragma once
+
+#include "Glitter_ispc_stubs.h"
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+namespace moonshine {
+namespace glitter {
+
+// A small set associative cache of flake searches, keyed by
+// GLITTER_FlakeCacheKey (see Glitter.isph). Every thread has its own cache,
+// so lookups take no locks, and the least recently used entry of a set is
+// evicted first. Only the hit/miss totals are shared between threads.
+class FlakeCache
+{
+public:
+    struct Stats
+    {
+        uint64_t mHits = 0;
+        uint64_t mMisses = 0;
+    };
+
+    // Results with more flakes than this are not cached
+    static constexpr unsigned int sMaxFlakes = 256;
+
+    FlakeCache();
+    ~FlakeCache();
+
+    FlakeCache(const FlakeCache&) = delete;
+    FlakeCache& operator=(const FlakeCache&) = delete;
+
+    // The calling thread's cache
+    static FlakeCache& get();
+
+    // A new id for a Glitter instance, so that no instance sees the entries
+    // of one that came before it at the same address
+    static unsigned int newGlitterId();
+
+    // Hit/miss totals over every thread, including threads that have exited.
+    // Only reset them while no thread is shading.
+    static Stats getStats();
+    static void resetStats();
+
+    const ispc::GLITTER_CachedFlake* find(const ispc::GLITTER_FlakeCacheKey& key,
+                                          unsigned int& count);
+    ispc::GLITTER_CachedFlake* insert(const ispc::GLITTER_FlakeCacheKey& key,
+                                      unsigned int count);
+
+private:
+    static constexpr unsigned int sNumSets = 64;
+    static constexpr unsigned int sNumWays = 4;
+
+    struct Entry
+    {
+        ispc::GLITTER_FlakeCacheKey mKey;
+        uint64_t mLastUse = 0;  // 0 for an empty entry
+        std::vector<ispc::GLITTER_CachedFlake> mFlakes;
+    };
+
+    Entry* getSet(const ispc::GLITTER_FlakeCacheKey& key);
+
+    Entry mEntries[sNumSets * sNumWays];
+    uint64_t mClock;
+
+    // Only ever written by the owning thread, read by getStats()
+    std::atomic<uint64_t> mHits;
+    std::atomic<uint64_t> mMisses;
+};
+
+} // namespace glitter
+} // namespace moonshine
+
@@ -4,6 +4,7 @@
 /// @file Glitter.cc
 
 #include "Glitter.h"
+#include "FlakeCache.h"
 
 #include <moonray/map/primvar/Primvar.h>
 #include <moonshine/common/interpolation/Interpolation.h>
@@ -12,6 +13,7 @@
 #include <scene_rdl2/common/math/MathUtil.h>
 #include <scene_rdl2/render/util/Random.h>
 
+#include <cmath>
 #include <memory>
 
 namespace moonshine {
@@ -28,6 +30,12 @@ using namespace moonray;
 #define GLITTERFLAKES_MAX_BLEND_START 900
 #define GLITTERFLAKES_BLEND_START_RANGE (GLITTERFLAKES_MAX_BLEND_START - GLITTERFLAKES_MIN_BLEND_START)
 
+// Flake cache keys quantize normals and deformation factors to steps of 1/256
+#define FLAKE_CACHE_QUANTIZATION 256.0f
+// Queries with larger footprints or farther from the origin than this are not cached
+#define FLAKE_CACHE_MAX_RADIUS 1.0e18f
+#define FLAKE_CACHE_MAX_CELL 1.0e9f
+
 namespace {
 //  This function computes the fraction of the pixel footprint that is covered on average
 //  by glitter flakes, given a flake size.
@@ -103,6 +111,7 @@ Glitter::Glitter(const scene_rdl2::rdl2::Material* shader,
     mUniformParams.mSpace = params.mSpace;
     mUniformParams.mDenseGlitterLodQuality = params.mDenseGlitterLodQuality;
     mUniformParams.mSearchRadiusFactor = params.mSearchRadiusFactor;
+    mUniformParams.mFlakeCacheCellFactor = params.mFlakeCacheCellFactor;
     mUniformParams.mLayeringMode = params.mLayeringMode;
     mUniformParams.mDebugMode = params.mDebugMode;
 
@@ -158,6 +167,8 @@ Glitter::Glitter(const scene_rdl2::rdl2::Material* shader,
     // Assign refPKey to use in ispc
     mIspc.mRefPKey = moonray::shading::StandardAttributes::sRefP;
     mIspc.mRefNKey = moonray::shading::StandardAttributes::sRefN;
+
+    mIspc.mFlakeCacheId = FlakeCache::newGlitterId();
 }
 
 Glitter::Glitter(scene_rdl2::rdl2::Material* shader,
@@ -368,6 +379,133 @@ Glitter::finalizeFlakes(noise::Worley_PointArray::iterator flkItrBeg,
     return flakeCount;
 }
 
+namespace {
+
+int
+quantize(const float x)
+{
+    return static_cast<int>(std::round(x * FLAKE_CACHE_QUANTIZATION));
+}
+
+float
+dequantize(const int q)
+{
+    return static_cast<float>(q) * (1.0f / FLAKE_CACHE_QUANTIZATION);
+}
+
+// Quantize a unit vector into q, and return the unit vector q stands for
+scene_rdl2::math::Vec3f
+quantizeDirection(const ispc::Vec3f& v, int* q)
+{
+    q[0] = quantize(v.x);
+    q[1] = quantize(v.y);
+    q[2] = quantize(v.z);
+    return scene_rdl2::math::normalize(scene_rdl2::math::Vec3f(dequantize(q[0]),
+                                                               dequantize(q[1]),
+                                                               dequantize(q[2])));
+}
+
+void
+unpackCachedFlake(const ispc::GLITTER_CachedFlake& cached,
+                  ispc::NOISE_WorleyPoint& flake)
+{
+    flake.normal = cached.mNormal;
+    flake.uv = cached.mUv;
+    flake.weight = cached.mWeight;
+    flake.id = cached.mId;
+    flake.styleIndex = cached.mStyleIndex;
+}
+
+void
+packCachedFlake(const ispc::NOISE_WorleyPoint& flake,
+                ispc::GLITTER_CachedFlake& cached)
+{
+    cached.mNormal = flake.normal;
+    cached.mUv = flake.uv;
+    cached.mWeight = flake.weight;
+    cached.mId = flake.id;
+    cached.mStyleIndex = flake.styleIndex;
+}
+
+} // anonymous namespace
+
+bool
+Glitter::snapFlakeQuery(const ispc::NOISE_WorleySample& sample,
+                        const noise::Flake_StyleArray& styleCDF,
+                        const noise::Flake_StyleArray& styleSizes,
+                        const float flakeDensity,
+                        const float flakeJitter,
+                        ispc::GLITTER_FlakeCacheKey& key,
+                        ispc::NOISE_WorleySample& query) const
+{
+    const float cellFactor = mUniformParams.mFlakeCacheCellFactor;
+    if (!(cellFactor > 0.0f) || !(sample.radius > 0.0f) || !(sample.radius < FLAKE_CACHE_MAX_RADIUS)) {
+        return false;
+    }
+
+    // The footprint radius is rounded to the middle of its quarter octave,
+    // which keeps it within 10% of the original
+    const int radiusBucket = static_cast<int>(std::floor(4.0f * std::log2(sample.radius)));
+    const float radius = std::exp2((static_cast<float>(radiusBucket) + 0.5f) * 0.25f);
+
+    // The position is moved to the center of its cell. A cell is a fraction
+    // of the footprint radius across, so the query stays inside the footprint.
+    const float cellSize = radius * cellFactor;
+    const scene_rdl2::math::Vec3f cell = scene_rdl2::math::asCpp(sample.position) / cellSize;
+    if (!(scene_rdl2::math::abs(cell.x) < FLAKE_CACHE_MAX_CELL) ||
+        !(scene_rdl2::math::abs(cell.y) < FLAKE_CACHE_MAX_CELL) ||
+        !(scene_rdl2::math::abs(cell.z) < FLAKE_CACHE_MAX_CELL)) {
+        return false;
+    }
+
+    key.mGlitterId = mIspc.mFlakeCacheId;
+    key.mSeed = mUniformParams.mSeed;
+    key.mRadiusBucket = radiusBucket;
+    key.mCell[0] = static_cast<int>(std::floor(cell.x));
+    key.mCell[1] = static_cast<int>(std::floor(cell.y));
+    key.mCell[2] = static_cast<int>(std::floor(cell.z));
+    for (int i = 0; i < 2; ++i) {
+        key.mStyleCDF[i] = styleCDF[i];
+        key.mStyleSizes[i] = styleSizes[i];
+    }
+    key.mFlakeDensity = flakeDensity;
+    key.mFlakeJitter = flakeJitter;
+
+    query = sample;
+    scene_rdl2::math::asCpp(query.position) =
+        scene_rdl2::math::Vec3f(static_cast<float>(key.mCell[0]) + 0.5f,
+                                static_cast<float>(key.mCell[1]) + 0.5f,
+                                static_cast<float>(key.mCell[2]) + 0.5f) * cellSize;
+    scene_rdl2::math::asCpp(query.normal) = quantizeDirection(sample.normal, key.mNormal);
+
+    // Everything initializeNoiseSample() derives from the radius
+    query.radius = radius;
+    query.footprintArea = scene_rdl2::math::sPi * radius * radius;
+    query.searchRadius = radius * mUniformParams.mSearchRadiusFactor;
+    query.footprintLength = 2.0f * radius;
+    query.estimatedFeatures = (int)(ispc::NOISE_WORLEY_LAMBDA * query.footprintArea + 1);
+    query.microfacetBlend = scene_rdl2::math::saturate((static_cast<float>(query.estimatedFeatures) - mIspc.mMicrofacetBlendStart) /
+                                                       static_cast<float>(mIspc.mMicrofacetBlendEnd - mIspc.mMicrofacetBlendStart));
+
+    for (int i = 0; i < 13; ++i) {
+        key.mDeformation[i] = 0;
+    }
+    if (sample.compensateDeformation) {
+        key.mDeformation[0] = 1;
+        key.mDeformation[1] = quantize(sample.compensationS);
+        key.mDeformation[2] = quantize(sample.compensationT);
+        key.mDeformation[3] = quantize(sample.shearRefP_X);
+        query.compensationS = dequantize(key.mDeformation[1]);
+        query.compensationT = dequantize(key.mDeformation[2]);
+        query.shearRefP_X = dequantize(key.mDeformation[3]);
+        scene_rdl2::math::asCpp(query.refX) = quantizeDirection(sample.refX, key.mDeformation + 4);
+        scene_rdl2::math::asCpp(query.refY) = quantizeDirection(sample.refY, key.mDeformation + 7);
+        scene_rdl2::math::asCpp(query.refZ) = quantizeDirection(sample.refZ, key.mDeformation + 10);
+    }
+
+    return true;
+}
+
 unsigned int
 Glitter::findNearestFlakes(const ispc::NOISE_WorleySample& sample,
                            const noise::Flake_StyleArray& styleCDF,
@@ -387,15 +525,46 @@ Glitter::findNearestFlakes(const ispc::NOISE_WorleySample& sample,
     const noise::RandomTable* randomTablePtr = &mIspc.mRandomTable;
     const noise::Flake_StyleArray* styleCDFPtr = &styleCDF;
 
+    ispc::GLITTER_FlakeCacheKey key;
+    ispc::NOISE_WorleySample query;
+    if (!snapFlakeQuery(sample, styleCDF, styleSizes, flakeDensity, flakeJitter, key, query)) {
+        auto flkCurItr = mNoiseWorley->searchPoints(searchRadiusPtr,
+                                                    randomTablePtr,
+                                                    styleCDFPtr,
+                                                    sample,
+                                                    flakes,
+                                                    -1,
+                                                    flakeJitter);
+
+        return finalizeFlakes(flakes.begin(), flkCurItr);
+    }
+
+    // Neighboring samples mostly snap to the same few keys. Only the members
+    // of each flake that the lobes read are restored from the cache.
+    FlakeCache& cache = FlakeCache::get();
+    unsigned int flakeCount = 0;
+    if (const ispc::GLITTER_CachedFlake* cached = cache.find(key, flakeCount)) {
+        for (unsigned int i = 0; i < flakeCount; ++i) {
+            unpackCachedFlake(cached[i], flakes[i]);
+        }
+        return flakeCount;
+    }
+
     auto flkCurItr = mNoiseWorley->searchPoints(searchRadiusPtr,
                                                 randomTablePtr,
                                                 styleCDFPtr,
-                                                sample,
+                                                query,
                                                 flakes,
                                                 -1,
                                                 flakeJitter);
 
-    return finalizeFlakes(flakes.begin(), flkCurItr);
+    flakeCount = finalizeFlakes(flakes.begin(), flkCurItr);
+    if (ispc::GLITTER_CachedFlake* entry = cache.insert(key, flakeCount)) {
+        for (unsigned int i = 0; i < flakeCount; ++i) {
+            packCachedFlake(flakes[i], entry[i]);
+        }
+    }
+    return flakeCount;
 }
 
 scene_rdl2::math::Color
@@ -119,6 +119,16 @@ private:
     static unsigned int finalizeFlakes(moonray::noise::Worley_PointArray::iterator flkItrBeg,
                                        moonray::noise::Worley_PointArray::iterator flkItrCur);
 
+    // Snap a flake search to its flake cache key (see GLITTER_FlakeCacheKey).
+    // Returns false if the cache is off or can't hold the search.
+    bool snapFlakeQuery(const ispc::NOISE_WorleySample& sample,
+                        const moonray::noise::Flake_StyleArray& styleCDF,
+                        const moonray::noise::Flake_StyleArray& styleSizes,
+                        float flakeDensity,
+                        float flakeJitter,
+                        ispc::GLITTER_FlakeCacheKey& key,
+                        ispc::NOISE_WorleySample& query) const;
+
     unsigned int findNearestFlakes(const ispc::NOISE_WorleySample& sample,
                                    const moonray::noise::Flake_StyleArray& styleCDF,
                                    const moonray::noise::Flake_StyleArray& styleSizes,